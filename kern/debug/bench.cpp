@@ -0,0 +1,387 @@
+/*
+bench.cpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "bench.hpp"
+
+#include <algorithm.hpp>
+#include <memory.hpp>
+
+#include "mem/memmap.hpp"
+#include "mem/page_fault.hpp"
+#include "fs/pipe.hpp"
+#include "drivers/storage/disk.hpp"
+#include "drivers/storage/diskcache.hpp"
+#include "graphics/fonts/psf.hpp"
+#include "tasking/process.hpp"
+#include "tasking/process_data.hpp"
+#include "tasking/scheduler.hpp"
+#include "tasking/semaphore.hpp"
+#include "i686/syscalls/syscall.hpp"
+#include "utils/logging.hpp"
+
+namespace bench
+{
+
+namespace
+{
+
+std::vector<Case> cases;
+std::vector<Result> last_results;
+
+// The partner task gives the context switch and pipe cases someone to bounce off
+enum class PartnerMode
+{
+    Idle,
+    Yield,
+    Pipe
+};
+
+volatile PartnerMode partner_mode { PartnerMode::Idle };
+volatile uint32_t partner_rounds { 0 };
+bool partner_started { false };
+Semaphore partner_wakeup; // the partner blocks on it between runs
+std::shared_ptr<vfs::pipe> ping;
+std::shared_ptr<vfs::pipe> pong;
+
+void partner_entry()
+{
+    while (true)
+    {
+        switch (partner_mode)
+        {
+            case PartnerMode::Yield:
+                ++partner_rounds;
+                tasking::schedule();
+                break;
+
+            case PartnerMode::Pipe:
+            {
+                uint8_t byte;
+                if (ping->read(0, {&byte, 1}))
+                {
+                    (void)pong->write(0, {&byte, 1});
+                }
+                break;
+            }
+
+            default:
+                partner_wakeup.wait();
+                break;
+        }
+    }
+}
+
+void start_partner()
+{
+    if (partner_started) return;
+
+    auto task = Process::create_kernel_task(partner_entry);
+    task->data->name = "bench";
+    partner_started = true;
+}
+
+void set_partner_mode(PartnerMode mode)
+{
+    partner_mode = mode;
+    if (mode != PartnerMode::Idle)
+    {
+        partner_wakeup.post();
+    }
+}
+
+// waits for the partner to be scheduled after its wakeup
+bool wait_for_partner()
+{
+    const uint32_t rounds = partner_rounds;
+    const uint64_t deadline = Time::total_ticks() + Time::ns_to_ticks(1'000'000'000);
+    while (partner_rounds == rounds)
+    {
+        if (Time::total_ticks() > deadline)
+        {
+            return false;
+        }
+        tasking::schedule();
+    }
+
+    return true;
+}
+
+void pipe_round_trip()
+{
+    uint8_t byte = 0x42;
+    (void)ping->write(0, {&byte, 1});
+    (void)pong->read(0, {&byte, 1});
+}
+
+// state of the cases needing resources, released by their teardown
+uintptr_t fault_page;
+uintptr_t fault_phys;
+fault_handle fault_hdl;
+
+std::unique_ptr<DiskCache> disk_cache;
+uint8_t sector_buf[512];
+
+std::unique_ptr<graphics::psf::PSFFont> font;
+constexpr size_t glyph_buf_width = 32;
+constexpr size_t glyph_buf_height = 32;
+graphics::Color glyph_buf[glyph_buf_width*glyph_buf_height];
+
+alignas(16) uint8_t memcpy_src[0x1000];
+alignas(16) uint8_t memcpy_dst[0x1000];
+
+void register_builtin_cases()
+{
+    static bool registered { false };
+    if (registered) return;
+    registered = true;
+
+    register_case({"tsc_read", []{ return true; }, []
+    {
+        return measure([]{});
+    }, []{}});
+
+    register_case({"context_switch", []
+    {
+        start_partner();
+        set_partner_mode(PartnerMode::Yield);
+        return wait_for_partner();
+    }, []
+    {
+        // a schedule() coming back to us goes through the partner (and the idle task if it is ready)
+        return measure([]{ tasking::schedule(); });
+    }, []
+    {
+        set_partner_mode(PartnerMode::Idle);
+    }});
+
+    register_case({"syscall_getpid", []{ return true; }, []
+    {
+        // ring 0 can't take the int 0x80 gate, time the table dispatch and the handler
+        registers regs {};
+        regs.int_no = linux_syscall_int;
+        regs.eax = 0x14; // getpid
+        return measure([&regs]{ linux_syscall_table[regs.eax].ptr(&regs); });
+    }, []{}});
+
+    register_case({"page_alloc", []{ return true; }, []
+    {
+        return measure([]{ Memory::release_physical_page(Memory::allocate_physical_page()); });
+    }, []{}});
+
+    register_case({"page_fault_skip", []
+    {
+        // a sentinel page faults on every access, the handler claims the fault and the access is skipped :
+        // this times the whole non-mmap fault path, decoding the faulting instruction to step over it included
+        fault_page = Memory::allocate_virtual_page(1, false);
+        fault_phys = Memory::allocate_physical_page();
+        Memory::map_page(fault_phys, (void*)fault_page, Memory::Read|Memory::Write|Memory::Sentinel);
+        fault_hdl = attach_fault_handler((void*)fault_page, [](const PageFault&) { return true; });
+        return true;
+    }, []
+    {
+        return measure([]{ (void)*(volatile uint8_t*)fault_page; });
+    }, []
+    {
+        detach_fault_handler(fault_hdl);
+        Memory::unmap_page((void*)fault_page);
+        Memory::release_physical_page(fault_phys);
+        Memory::release_virtual_page(fault_page);
+    }});
+
+    register_case({"pipe_pingpong", []
+    {
+        start_partner();
+        ping = std::make_shared<vfs::pipe>();
+        pong = std::make_shared<vfs::pipe>();
+        set_partner_mode(PartnerMode::Pipe);
+        return true;
+    }, []
+    {
+        return measure(pipe_round_trip);
+    }, []
+    {
+        // one last round lets the partner see the mode change instead of blocking on the pipe
+        set_partner_mode(PartnerMode::Idle);
+        pipe_round_trip();
+        ping.reset();
+        pong.reset();
+    }});
+
+    register_case({"diskcache_hit", []
+    {
+        auto disks = Disk::disks();
+        if (disks.empty() || disks[0].get().sector_size() != sizeof(sector_buf)) return false;
+
+        disk_cache = std::make_unique<DiskCache>(disks[0].get());
+        return bool(disk_cache->read_sectors(0, sector_buf));
+    }, []
+    {
+        return measure([]{ (void)disk_cache->read_sectors(0, sector_buf); });
+    }, []
+    {
+        disk_cache.reset();
+    }});
+
+    register_case({"glyph_blit", []
+    {
+        font = std::make_unique<graphics::psf::PSFFont>();
+        return font->load("/initrd/system.8x16.psf");
+    }, []
+    {
+        return measure([]
+        {
+            graphics::draw_glyph(glyph_buf, glyph_buf_width, glyph_buf_height, *font, 'A', {8, 8},
+                                 graphics::color_white, graphics::color_black);
+        });
+    }, []
+    {
+        font.reset();
+    }});
+
+    register_case({"memcpy_4k", []{ return true; }, []
+    {
+        return measure([]{ memcpy(memcpy_dst, memcpy_src, sizeof(memcpy_dst)); });
+    }, []{}});
+}
+
+Result reduce(const kpp::string& name, std::vector<uint64_t>& samples, uint64_t overhead)
+{
+    for (auto& sample : samples)
+    {
+        sample = sample > overhead ? sample - overhead : 0;
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    const size_t n = samples.size();
+    Result result;
+    result.name = name;
+    result.iterations = n;
+    result.min = samples[0];
+    result.median = samples[n / 2];
+    result.p99 = samples[std::min(n - 1, (n * 99) / 100)];
+    result.max = samples[n - 1];
+
+    return result;
+}
+
+// the smallest cost of an empty measurement, subtracted from every sample
+uint64_t measure_overhead()
+{
+    uint64_t best = measure([]{});
+    for (size_t i { 1 }; i < 256; ++i)
+    {
+        best = std::min(best, measure([]{}));
+    }
+    return best;
+}
+
+}
+
+void register_case(const Case& c)
+{
+    cases.emplace_back(c);
+}
+
+std::vector<Result> run(const kpp::string& filter, size_t iterations)
+{
+    register_builtin_cases();
+
+    iterations = std::clamp<size_t>(iterations, 1, max_iterations);
+    const size_t warmup = std::max<size_t>(8, iterations / 10);
+    const uint64_t overhead = measure_overhead();
+
+    std::vector<Result> results;
+    std::vector<uint64_t> samples;
+    samples.reserve(iterations);
+
+    for (const auto& c : cases)
+    {
+        if (!filter.empty() && c.name.find(filter) == kpp::string::npos)
+        {
+            continue;
+        }
+
+        if (!c.setup())
+        {
+            log_serial("bench : skipping '%s', setup failed\n", c.name.c_str());
+            continue;
+        }
+
+        for (size_t i { 0 }; i < warmup; ++i)
+        {
+            (void)c.iteration();
+        }
+
+        samples.clear();
+        for (size_t i { 0 }; i < iterations; ++i)
+        {
+            samples.emplace_back(c.iteration());
+        }
+
+        c.teardown();
+
+        results.emplace_back(reduce(c.name, samples, c.name == "tsc_read" ? 0 : overhead));
+    }
+
+    last_results = results;
+
+    return results;
+}
+
+kpp::string format_header()
+{
+    char buf[128];
+    ksnprintf(buf, sizeof(buf), "%-16s %8s %10s %10s %10s %10s %10s %10s\n", "case", "iters",
+              "min", "median", "p99", "max", "med ns", "p99 ns");
+    return buf;
+}
+
+kpp::string format(const Result& result)
+{
+    char buf[160];
+    ksnprintf(buf, sizeof(buf), "%-16s %8d %10llu %10llu %10llu %10llu %10llu %10llu\n", result.name.c_str(),
+              result.iterations, result.min, result.median, result.p99, result.max,
+              Time::ticks_to_ns(result.median), Time::ticks_to_ns(result.p99));
+    return buf;
+}
+
+kpp::string report()
+{
+    if (last_results.empty())
+    {
+        return "# no benchmark run yet, use the 'bench' shell command\n";
+    }
+
+    kpp::string str = "# TSC cycles per iteration\n" + format_header();
+    for (const auto& result : last_results)
+    {
+        str += format(result);
+    }
+
+    return str;
+}
+
+}
@@ -0,0 +1,88 @@
+/*
+bench.hpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <functional.hpp>
+#include <vector.hpp>
+
+#include <kstring/kstring.hpp>
+
+#include "time/time.hpp"
+
+// Microbenchmark harness : each case is warmed up then repeated, and the per-iteration TSC cycle counts
+// are reduced to min/median/p99/max. Everything stays in integer math, cycles are converted with Time::ticks_to_ns.
+namespace bench
+{
+
+constexpr size_t default_iterations = 1000;
+constexpr size_t max_iterations = 100000;
+
+struct Case
+{
+    kpp::string name;
+    // returns false if the case can't run on this machine (no disk, no font...)
+    std::function<bool()> setup;
+    // runs one iteration and returns the TSC cycles it took, so that per-iteration preparation isn't measured
+    std::function<uint64_t()> iteration;
+    std::function<void()> teardown;
+};
+
+struct Result
+{
+    kpp::string name;
+    size_t iterations;
+    uint64_t min;
+    uint64_t median;
+    uint64_t p99;
+    uint64_t max;
+};
+
+void register_case(const Case& c);
+
+// times 'fn' alone, the cost of reading the TSC is removed by the runner
+template <typename Callback>
+inline uint64_t measure(Callback&& fn)
+{
+    const uint64_t start = Time::total_ticks();
+    fn();
+    return Time::total_ticks() - start;
+}
+
+// runs every case whose name contains 'filter', the results are kept for report()
+std::vector<Result> run(const kpp::string& filter = "", size_t iterations = default_iterations);
+
+kpp::string format(const Result& result);
+kpp::string format_header();
+
+// the results of the last run
+kpp::string report();
+
+}
+
+#endif // BENCH_HPP
@@ -0,0 +1,297 @@
+/*
+profiler.cpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "profiler.hpp"
+
+#include <unordered_map.hpp>
+#include <vector.hpp>
+#include <algorithm.hpp>
+
+#include <kstring/kstring.hpp>
+
+#include "debug/stack-trace.hpp"
+#include "elf/symbol_table.hpp"
+#include "time/time.hpp"
+#include "time/timer.hpp"
+#include "utils/logging.hpp"
+
+namespace profiler
+{
+
+namespace
+{
+
+struct Sample
+{
+    uintptr_t pcs[max_depth]; // innermost first
+    uint8_t   depth;
+    bool      user;
+};
+
+// LudOS runs on a single CPU, so there is only one ring
+struct CpuRing
+{
+    Sample samples[ring_size];
+    size_t head;  // next slot to write
+    size_t total; // samples taken since start(), the oldest ones are overwritten
+};
+
+CpuRing ring;
+
+volatile bool active { false };
+volatile bool reading { false }; // a report is being built, don't touch the ring
+uint64_t interval; // in TSC ticks
+uint64_t next_sample;
+uint32_t rate;
+Timer::CallbackHandle keepalive;
+bool has_keepalive { false };
+
+template <typename Callback>
+void for_each_sample(Callback&& callback)
+{
+    reading = true;
+
+    const size_t count = ring.total < ring_size ? ring.total : ring_size;
+    const size_t first = (ring.head + ring_size - count) % ring_size;
+    for (size_t i { 0 }; i < count; ++i)
+    {
+        callback(ring.samples[(first + i) % ring_size]);
+    }
+
+    reading = false;
+}
+
+// builds each address' string once, the same addresses come back all the time
+struct Symbolizer
+{
+    const kpp::string& name(uintptr_t addr)
+    {
+        if (auto it = cache.find(addr); it != cache.end())
+        {
+            return it->second;
+        }
+
+        kpp::string str;
+        if (auto sym = elf::kernel_symbol_table.find(addr))
+        {
+            str = elf::kernel_symbol_table.name(*sym);
+        }
+        else
+        {
+            char buf[16];
+            ksnprintf(buf, sizeof(buf), "0x%x", addr);
+            str = buf;
+        }
+
+        return cache[addr] = std::move(str);
+    }
+
+    // the symbol containing the sampled instruction, and the calls the return addresses come from
+    const kpp::string& frame(const Sample& sample, size_t idx)
+    {
+        static const kpp::string user_str = "[user]";
+        if (sample.user)
+        {
+            return user_str;
+        }
+
+        // find() looks up the symbol before the given address
+        return name(idx == 0 ? sample.pcs[0] + 1 : sample.pcs[idx]);
+    }
+
+    std::unordered_map<uintptr_t, kpp::string> cache;
+};
+
+kpp::string header()
+{
+    char buf[96];
+    ksnprintf(buf, sizeof(buf), "# %s at %d Hz, %d samples, %d kept\n", active ? "running" : "stopped", rate,
+              ring.total, ring.total < ring_size ? ring.total : ring_size);
+    return buf;
+}
+
+}
+
+uint32_t start(uint32_t hz)
+{
+    stop();
+
+    if (hz == 0) hz = 1;
+
+    ring.head = 0;
+    ring.total = 0;
+
+    // samples are only taken on timer interrupts : the periodic tick bounds the rate, and when tickless
+    // the timer event keeping the interrupts coming has a millisecond resolution
+    if (Timer::tickless())
+    {
+        const uint32_t period_ms = hz >= 1000 ? 1 : 1000 / hz;
+        rate = 1000 / period_ms;
+        keepalive = Timer::register_callback(period_ms, []{}, false);
+        has_keepalive = true;
+    }
+    else
+    {
+        const uint32_t ticks_per_sample = (Timer::freq() + hz - 1) / hz;
+        rate = Timer::freq() / ticks_per_sample;
+    }
+
+    // a bit shorter than the period, an interrupt arriving slightly early must not be skipped
+    const uint64_t period = Time::ns_to_ticks(1'000'000'000 / rate);
+    interval = period - period / 8;
+    next_sample = Time::total_ticks() + interval;
+
+    active = true;
+
+    return rate;
+}
+
+void stop()
+{
+    active = false;
+
+    if (has_keepalive)
+    {
+        Timer::remove_callback(keepalive);
+        has_keepalive = false;
+    }
+}
+
+bool running()
+{
+    return active;
+}
+
+void sample(uintptr_t ip, uintptr_t frame, bool user)
+{
+    if (!active || reading)
+    {
+        return;
+    }
+
+    // the timer interrupt also fires for other events when tickless, keep a steady rate
+    const uint64_t now = Time::total_ticks();
+    if (now < next_sample)
+    {
+        return;
+    }
+    next_sample = now + interval;
+
+    Sample& entry = ring.samples[ring.head];
+    entry.user = user;
+    entry.pcs[0] = ip;
+    entry.depth = 1;
+    if (!user)
+    {
+        entry.depth += capture_stack((void*)frame, entry.pcs + 1, max_depth - 1);
+    }
+
+    ring.head = (ring.head + 1) % ring_size;
+    ++ring.total;
+}
+
+kpp::string flat_report()
+{
+    struct Counts
+    {
+        size_t self { 0 };
+        size_t total { 0 };
+    };
+
+    Symbolizer symbols;
+    std::unordered_map<kpp::string, Counts> functions;
+    size_t sample_count = 0;
+
+    for_each_sample([&](const Sample& sample)
+    {
+        ++sample_count;
+        ++functions[symbols.frame(sample, 0)].self;
+
+        // count recursive functions only once per sample
+        std::vector<const kpp::string*> seen;
+        for (size_t i { 0 }; i < sample.depth; ++i)
+        {
+            const kpp::string& name = symbols.frame(sample, i);
+            if (std::find_if(seen.begin(), seen.end(), [&name](const kpp::string* str) { return *str == name; }) == seen.end())
+            {
+                seen.emplace_back(&name);
+                ++functions[name].total;
+            }
+        }
+    });
+
+    std::vector<std::pair<kpp::string, Counts>> sorted(functions.begin(), functions.end());
+    std::sort(sorted.begin(), sorted.end(), [](const auto& lhs, const auto& rhs)
+    {
+        return lhs.second.self > rhs.second.self ||
+               (lhs.second.self == rhs.second.self && lhs.second.total > rhs.second.total);
+    });
+
+    kpp::string report = header();
+    report += "#  self%  total%    self   total  function\n";
+    for (const auto& entry : sorted)
+    {
+        char buf[64];
+        ksnprintf(buf, sizeof(buf), "%4d.%d%% %4d.%d%% %7d %7d  ",
+                  entry.second.self*100/sample_count, entry.second.self*1000/sample_count%10,
+                  entry.second.total*100/sample_count, entry.second.total*1000/sample_count%10,
+                  entry.second.self, entry.second.total);
+        report += buf;
+        report += entry.first;
+        report += '\n';
+    }
+
+    return report;
+}
+
+kpp::string folded_report()
+{
+    Symbolizer symbols;
+    std::unordered_map<kpp::string, size_t> chains;
+
+    for_each_sample([&](const Sample& sample)
+    {
+        kpp::string chain;
+        for (size_t i { sample.depth }; i-- > 0;)
+        {
+            chain += symbols.frame(sample, i);
+            if (i != 0) chain += ';';
+        }
+        ++chains[chain];
+    });
+
+    kpp::string report;
+    for (const auto& entry : chains)
+    {
+        report += entry.first;
+        report += ' ';
+        report += kpp::to_string((unsigned long)entry.second);
+        report += '\n';
+    }
+
+    return report;
+}
+
+}
@@ -0,0 +1,58 @@
+/*
+profiler.hpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <kstring/kstrfwd.hpp>
+
+// Statistical sampling profiler : the timer interrupt records the interrupted instruction pointer
+// and a few callers in a fixed ring, the reports are aggregated and symbolized when read.
+namespace profiler
+{
+
+constexpr size_t max_depth = 8;
+constexpr size_t ring_size = 4096;
+
+// starts sampling at 'hz' samples per second, the previous samples are discarded ;
+// returns the rate actually used, which the timer may not be able to reach
+uint32_t start(uint32_t hz = 1000);
+void stop();
+bool running();
+
+// called from the timer interrupt with the interrupted context
+void sample(uintptr_t ip, uintptr_t frame, bool user);
+
+// per function self and total sample counts, hottest first
+kpp::string flat_report();
+
+// one 'outer;...;inner count' line per distinct call chain, for flamegraph.pl
+kpp::string folded_report();
+
+}
+
+#endif // PROFILER_HPP
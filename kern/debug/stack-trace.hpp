@@ -39,4 +39,8 @@ struct TraceEntry
 // if frames == 0, print until no more frames are available
 std::vector<TraceEntry> trace_stack(void* addr, size_t frames);
 
+// stores up to 'max' kernel return addresses starting from the frame 'addr', without allocating nor symbolizing ;
+// usable from interrupt handlers, returns the number of addresses stored
+size_t capture_stack(void* addr, uintptr_t* addresses, size_t max);
+
 #endif // STACKTRACE_HPP
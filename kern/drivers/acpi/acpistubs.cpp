@@ -132,12 +132,12 @@ void AcpiOsSleep(UINT64 Milliseconds)
 
 void AcpiOsStall(UINT32 Microseconds)
 {
-    Timer::sleep(Microseconds*1000);
+    Timer::udelay(Microseconds);
 }
 
 UINT64 AcpiOsGetTimer()
 {
-    return UINT64(Time::uptime()*1000ULL*1000ULL*10UL);
+    return Time::uptime_ns() / 100; // in 100 ns units
 }
 
 ACPI_STATUS AcpiOsSignal(UINT32 fun, void* info)
@@ -167,14 +167,14 @@ AcpiOsReadPciConfiguration (
         UINT64                  *Value,
         UINT32                  Width)
 {
-    if (Width != 16)
+    if (Width != 8 && Width != 16 && Width != 32)
     {
         warn("AcpiOsReadPciConfiguration : not implemented yet for Width %d\n", Width);
         return AE_NOT_IMPLEMENTED;
     }
     else
     {
-        *Value = pci::read_reg(PciId->Bus, PciId->Device, PciId->Function, Reg);
+        *Value = pci::read_config(PciId->Bus, PciId->Device, PciId->Function, Reg, Width);
         return AE_OK;
     }
 }
@@ -186,18 +186,16 @@ AcpiOsWritePciConfiguration (
         UINT64                  Value,
         UINT32                  Width)
 {
-    if (Width != 16)
+    if (Width != 8 && Width != 16 && Width != 32)
     {
         warn("AcpiOsWritePciConfiguration : not implemented yet for Width %d\n", Width);
         return AE_NOT_IMPLEMENTED;
     }
     else
     {
-        pci::write_reg(PciId->Bus, PciId->Device, PciId->Function, Reg, Value);
+        pci::write_config(PciId->Bus, PciId->Device, PciId->Function, Reg, Value, Width);
         return AE_OK;
     }
-
-    return AE_NOT_IMPLEMENTED;
 }
 
 void ACPI_INTERNAL_VAR_XFACE AcpiOsPrintf(const char* fmt, ...)
@@ -31,21 +31,21 @@ SOFTWARE.
 
 void Mouse::init()
 {
-    kmsgbus.register_handler<MousePacket>([](const MousePacket& e)
+    kmsgbus.subscribe<MousePacket>([](const MousePacket& e)
     {
         if (e.x != 0 || e.y != 0)
         {
-            kmsgbus.send<MouseMoveEvent>({e.x, e.y});
+            kmsgbus.post<MouseMoveEvent>({e.x, e.y});
         }
 
         if (e.wheel != 0)
         {
-            kmsgbus.send<MouseScrollEvent>({e.wheel});
+            kmsgbus.post<MouseScrollEvent>({e.wheel});
         }
 
         if (e.left_button || e.mid_button || e.right_button || e.button_4 || e.button_5)
         {
-            kmsgbus.send<MouseClickEvent>({e.left_button, e.mid_button, e.right_button, e.button_4, e.button_5});
+            kmsgbus.post<MouseClickEvent>({e.left_button, e.mid_button, e.right_button, e.button_4, e.button_5});
         }
 
         left_pressed = e.left_button;
@@ -25,6 +25,8 @@ SOFTWARE.
 
 #include "driver.hpp"
 
+#include "utils/kmsgbus.hpp"
+
 kpp::expected<std::reference_wrapper<NetworkDriver>, NetworkError> NetworkDriver::get()
 {
     if (m_nics.empty())
@@ -40,4 +42,11 @@ void NetworkDriver::add_nic(NetworkDriver &nic)
     m_nics.emplace_back(nic);
 }
 
+void NetworkDriver::deliver(net::PacketRef packet)
+{
+    ++m_stats.rx_packets;
+    m_stats.rx_bytes += packet->size();
 
+    // called from the receive softirq : only queue the frame, the subscribers handle it from the kmsgbus task
+    kmsgbus.post(PacketReceived{this, std::move(packet)});
+}
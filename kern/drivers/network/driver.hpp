@@ -33,14 +33,15 @@ SOFTWARE.
 #include <expected.hpp>
 
 #include "utils/vecutils.hpp"
-
-// TODO : Use the messagebus for sending/receiving packets
+#include "drivers/network/packet.hpp"
 
 struct NetworkError
 {
     enum Type
     {
         NoNicFound,
+        InvalidPacket,
+        TxQueueFull,
         Unknown
     } type;
 
@@ -50,12 +51,25 @@ struct NetworkError
         {
             case NoNicFound:
                 return "No network controller found";
+            case InvalidPacket:
+                return "Invalid packet size";
+            case TxQueueFull:
+                return "Transmit queue full";
             default:
                 return "Unknown error";
         }
     }
 };
 
+class NetworkDriver;
+
+// Sent on the kernel message bus for every received Ethernet frame (without its CRC), from softirq context
+struct PacketReceived
+{
+    NetworkDriver* nic;
+    net::PacketRef packet;
+};
+
 class NetworkDriver : virtual public Driver
 {
 public:
@@ -63,12 +77,38 @@ public:
 
     virtual kpp::array<uint8_t, 6> mac_address() const = 0;
 
+    // Queues an Ethernet frame (without its CRC) for transmission ; the driver holds a reference to the
+    // buffer until the hardware is done with it. Frames shorter than the Ethernet minimum are padded
+    virtual kpp::expected<kpp::dummy_t, NetworkError> send(net::PacketRef packet) = 0;
+
+    struct Stats
+    {
+        size_t rx_packets { 0 };
+        size_t rx_bytes { 0 };
+        size_t rx_dropped { 0 };
+        size_t rx_errors { 0 };
+        size_t tx_packets { 0 };
+        size_t tx_bytes { 0 };
+        size_t tx_errors { 0 };
+    };
+
+    const Stats& stats() const { return m_stats; }
+
     virtual DriverType type() const override
     { return DriverType::NIC; }
 
+    static constexpr size_t min_frame_size { 60 };
+    static constexpr size_t max_frame_size { 1514 };
+
 protected:
     static void add_nic(NetworkDriver& nic);
 
+    // hands a received frame to the asynchronous PacketReceived subscribers
+    void deliver(net::PacketRef packet);
+
+protected:
+    Stats m_stats;
+
 private:
     static inline ref_vector<NetworkDriver> m_nics;
 };
@@ -0,0 +1,116 @@
+/*
+packet.cpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "packet.hpp"
+
+#include "mem/memmap.hpp"
+#include "tasking/atomic.hpp"
+
+#include "i686/interrupts/interrupts.hpp"
+
+namespace net
+{
+
+namespace
+{
+constexpr size_t kernel_pool_size { 128 };
+}
+
+PacketRef::PacketRef(const PacketRef &other)
+    : m_buffer(other.m_buffer)
+{
+    if (m_buffer) atomic_inc(&m_buffer->m_refcount);
+}
+
+void PacketRef::reset()
+{
+    if (m_buffer && atomic_sub_fetch(&m_buffer->m_refcount, 1) == 0)
+    {
+        m_buffer->m_pool->release(m_buffer);
+    }
+    m_buffer = nullptr;
+}
+
+PacketPool::PacketPool(size_t count)
+    : m_buffers(count)
+{
+    static_assert(Memory::page_size() % PacketBuffer::buffer_size == 0);
+    constexpr size_t per_page = Memory::page_size() / PacketBuffer::buffer_size;
+
+    m_pages = (count + per_page - 1) / per_page;
+    m_storage = Memory::vmalloc(m_pages, Memory::Read|Memory::Write);
+    assert(m_storage);
+
+    for (size_t i { 0 }; i < count; ++i)
+    {
+        auto& buffer = m_buffers[i];
+        buffer.m_data = static_cast<uint8_t*>(m_storage) + i * PacketBuffer::buffer_size;
+        buffer.m_phys = Memory::physical_address(buffer.m_data);
+        buffer.m_pool = this;
+        buffer.m_next_free = m_free_list;
+        m_free_list = &buffer;
+    }
+    m_available = count;
+}
+
+PacketPool::~PacketPool()
+{
+    assert(m_available == m_buffers.size()); // references would dangle
+    Memory::vfree(m_storage, m_pages);
+}
+
+PacketPool &PacketPool::kernel()
+{
+    static PacketPool pool(kernel_pool_size);
+    return pool;
+}
+
+PacketRef PacketPool::allocate()
+{
+    IrqGuard guard; // the free list is shared with the ISRs
+
+    PacketBuffer* buffer = m_free_list;
+    if (!buffer) return {};
+
+    m_free_list = buffer->m_next_free;
+    --m_available;
+
+    buffer->m_next_free = nullptr;
+    buffer->m_size = 0;
+    buffer->m_refcount = 1;
+
+    return PacketRef{buffer};
+}
+
+void PacketPool::release(PacketBuffer *buffer)
+{
+    IrqGuard guard; // the free list is shared with the ISRs
+
+    buffer->m_next_free = m_free_list;
+    m_free_list = buffer;
+    ++m_available;
+}
+
+}
@@ -0,0 +1,131 @@
+/*
+packet.hpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+#ifndef PACKET_HPP
+#define PACKET_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <utility.hpp>
+#include <vector.hpp>
+
+#include "panic.hpp"
+
+// Preallocated, reference-counted packet buffers, so that frames move between the NIC drivers and
+// the protocol code without touching the heap ; allocation and release are usable from an ISR
+namespace net
+{
+
+class PacketPool;
+
+class PacketBuffer
+{
+public:
+    // a buffer never crosses a page boundary, so it is physically contiguous and can be handed to DMA
+    static constexpr size_t buffer_size { 2048 };
+
+    uint8_t* data() { return m_data; }
+    const uint8_t* data() const { return m_data; }
+
+    size_t size() const { return m_size; }
+    void resize(size_t size) { assert(size <= capacity()); m_size = size; }
+
+    static constexpr size_t capacity() { return buffer_size; }
+
+    uintptr_t physical_address() const { return m_phys; }
+
+private:
+    friend class PacketPool;
+    friend class PacketRef;
+
+    uint8_t* m_data { nullptr };
+    uintptr_t m_phys { 0 };
+    size_t m_size { 0 };
+    uint32_t m_refcount { 0 };
+    PacketPool* m_pool { nullptr };
+    PacketBuffer* m_next_free { nullptr };
+};
+
+// Intrusive shared reference to a PacketBuffer, the buffer goes back to its pool with the last reference
+class PacketRef
+{
+public:
+    PacketRef() = default;
+
+    // adopts a reference previously given up by release()
+    explicit PacketRef(PacketBuffer* buffer) : m_buffer(buffer) {}
+
+    PacketRef(const PacketRef& other);
+    PacketRef(PacketRef&& other) : m_buffer(std::exchange(other.m_buffer, nullptr)) {}
+    PacketRef& operator=(PacketRef other) { std::swap(m_buffer, other.m_buffer); return *this; }
+    ~PacketRef() { reset(); }
+
+    void reset();
+
+    // gives up ownership of the reference without dropping it, to pass the buffer through a raw queue
+    PacketBuffer* release() { return std::exchange(m_buffer, nullptr); }
+
+    PacketBuffer* get() const { return m_buffer; }
+    PacketBuffer* operator->() const { return m_buffer; }
+    PacketBuffer& operator*() const { return *m_buffer; }
+    explicit operator bool() const { return m_buffer != nullptr; }
+
+private:
+    PacketBuffer* m_buffer { nullptr };
+};
+
+class PacketPool
+{
+public:
+    explicit PacketPool(size_t count);
+    ~PacketPool();
+
+    PacketPool(const PacketPool&) = delete;
+    PacketPool& operator=(const PacketPool&) = delete;
+
+    // pool shared by the network drivers
+    static PacketPool& kernel();
+
+    // empty reference when the pool is exhausted
+    PacketRef allocate();
+
+    size_t size() const { return m_buffers.size(); }
+    size_t available() const { return __atomic_load_n(&m_available, __ATOMIC_RELAXED); }
+
+private:
+    friend class PacketRef;
+    void release(PacketBuffer* buffer);
+
+private:
+    std::vector<PacketBuffer> m_buffers;
+    void* m_storage { nullptr };
+    size_t m_pages { 0 };
+    PacketBuffer* m_free_list { nullptr };
+    size_t m_available { 0 };
+};
+
+}
+
+#endif // PACKET_HPP
@@ -25,7 +25,10 @@ SOFTWARE.
 
 #include "rtl8139.hpp"
 
+#include <string.h>
+
 #include "drivers/pci/pci.hpp"
+#include "drivers/pci/msi.hpp"
 
 #include "io.hpp"
 
@@ -33,31 +36,104 @@ SOFTWARE.
 
 #include "mem/memmap.hpp"
 
+#include "utils/logging.hpp"
+
+#include "i686/interrupts/interrupts.hpp"
+
 #include <limits.hpp>
 
 enum Regs
 {
     MAC = 0x0,
     MAR = 0x8,
+    TSD0 = 0x10,
+    TSAD0 = 0x20,
     RBSTART = 0x30,
     CMD = 0x37,
+    CAPR = 0x38,
     IMR = 0x3C,
     ISR = 0x3E,
+    TCR = 0x40,
     RCR = 0x44,
     CONFIG_1 = 0x52
 };
 
+enum Command : uint8_t
+{
+    BufferEmpty = 1<<0,
+    TxEnable    = 1<<2,
+    RxEnable    = 1<<3,
+    Reset       = 1<<4
+};
+
+enum Interrupt : uint16_t
+{
+    RxOk        = 1<<0,
+    RxError     = 1<<1,
+    TxOk        = 1<<2,
+    TxError     = 1<<3,
+    RxOverflow  = 1<<4,
+    FifoOverflow= 1<<6,
+};
+
+enum TxStatus : uint32_t
+{
+    TxOwn       = 1<<13,
+    TxUnderrun  = 1<<14,
+    TxStatusOk  = 1<<15,
+    TxAborted   = 1<<30
+};
+
+constexpr uint16_t rx_status_ok { 1<<0 };
+
+// accept broadcast, multicast, physical match and all packets ; with WRAP set the chip writes a frame
+// past the end of the ring instead of wrapping it, hence the extra room
+constexpr uint32_t rcr_value = 0xF | (1<<7) | (0b111<<8) | (0b111<<13);
+// standard interframe gap, unlimited DMA burst
+constexpr uint32_t tcr_value = (0b11<<24) | (0b111<<8);
+
+constexpr uint16_t interrupt_mask = RxOk|RxError|TxOk|TxError|RxOverflow|FifoOverflow;
+
+namespace
+{
+constexpr size_t max_nics { 4 };
+constexpr size_t rx_ring_size { RTL8139::rx_buf_size + 16 + 1500 };
+
+// the receive ring must be physically contiguous, which the kernel image is
+alignas(16) uint8_t rx_rings[max_nics][rx_ring_size];
+size_t used_rx_rings { 0 };
+}
+
+RTL8139::RTL8139()
+    : m_events("rtl8139", [this](const uint16_t& status) { handle_events(status); })
+{
+}
+
 void RTL8139::init()
 {
     m_iobase = pci::get_bar_val(m_dev, 0);
 
+    if (used_rx_rings >= max_nics)
+    {
+        warn("RTL8139 : no receive ring left for %x:%x:%x\n", m_dev.bus, m_dev.slot, m_dev.func);
+        return;
+    }
+    m_rcv_buf = rx_rings[used_rx_rings++];
+
+    enable_io_space();
     enable_bus_mastering();
     power_on();
     soft_reset();
-    set_rcv_buf(m_rcv_buf.data());
+    set_rcv_buf(m_rcv_buf);
 
-    outb(m_iobase + CMD, 0x5); // enable Tx/Rx
-    outl(m_iobase + RCR, 0xF); // Tell the nic to accept all valid packages
+    outw(m_iobase + IMR, interrupt_mask);
+
+    outb(m_iobase + CMD, TxEnable|RxEnable); // enable Tx/Rx
+    outl(m_iobase + RCR, rcr_value);
+    outl(m_iobase + TCR, tcr_value);
+
+    const uint8_t vector = pci::install_irq_handler(m_dev, [this](const registers*) { return irq_handler(); });
+    log(Debug, "RTL8139 interrupt vector : %d\n", vector);
 
     NetworkDriver::add_nic(*this);
 }
@@ -74,6 +150,40 @@ kpp::array<uint8_t, 6> RTL8139::mac_address() const
     return mac;
 }
 
+kpp::expected<kpp::dummy_t, NetworkError> RTL8139::send(net::PacketRef packet)
+{
+    if (!packet || packet->size() == 0 || packet->size() > max_frame_size)
+    {
+        return kpp::make_unexpected(NetworkError{NetworkError::InvalidPacket});
+    }
+
+    // the chip doesn't pad short frames itself
+    if (packet->size() < min_frame_size)
+    {
+        memset(packet->data() + packet->size(), 0, min_frame_size - packet->size());
+        packet->resize(min_frame_size);
+    }
+
+    IrqGuard guard;
+
+    if (m_tx_head - m_tx_tail >= tx_descriptors)
+    {
+        return kpp::make_unexpected(NetworkError{NetworkError::TxQueueFull});
+    }
+
+    const size_t desc = m_tx_head % tx_descriptors;
+    const uintptr_t phys = packet->physical_address();
+    const size_t size = packet->size();
+    m_tx_packets[desc] = std::move(packet);
+    ++m_tx_head;
+
+    // writing the size clears the OWN bit and starts the transmission
+    outl(m_iobase + TSAD0 + desc*4, phys);
+    outl(m_iobase + TSD0 + desc*4, size);
+
+    return {};
+}
+
 bool RTL8139::accept(const pci::PciDevice &dev)
 {
     return dev.vendorID == 0x10ec && dev.deviceID == 0x8139;
@@ -86,8 +196,8 @@ void RTL8139::power_on()
 
 void RTL8139::soft_reset()
 {
-    outb(m_iobase + CMD, 0x10);
-    Timer::sleep_until([this]{ return (inb(m_iobase + CMD) & 0x10) == 0; }, 500);
+    outb(m_iobase + CMD, Reset);
+    Timer::sleep_until([this]{ return (inb(m_iobase + CMD) & Reset) == 0; }, 500);
 }
 
 void RTL8139::set_rcv_buf(uint8_t *ptr)
@@ -95,4 +205,105 @@ void RTL8139::set_rcv_buf(uint8_t *ptr)
     outl(m_iobase + RBSTART, Memory::physical_address(ptr));
 }
 
+void RTL8139::restart_rx()
+{
+    // a bad header means the ring is out of sync, the receiver has to start over from the beginning
+    outb(m_iobase + CMD, TxEnable);
+    set_rcv_buf(m_rcv_buf);
+    outb(m_iobase + CMD, TxEnable|RxEnable);
+    outl(m_iobase + RCR, rcr_value);
+
+    m_rx_offset = 0;
+}
+
+bool RTL8139::irq_handler()
+{
+    const uint16_t status = inw(m_iobase + ISR);
+    if (status == 0)
+    {
+        return false;
+    }
+
+    outw(m_iobase + ISR, status); // write 1 to clear
+    m_events.push(status);
+
+    return true;
+}
+
+void RTL8139::handle_events(uint16_t status)
+{
+    if (status & (TxOk|TxError))
+    {
+        reclaim_tx();
+    }
+    if (status & (RxOverflow|FifoOverflow))
+    {
+        ++m_stats.rx_dropped;
+    }
+    // even a dropped event leaves the frames in the ring, they're all handled on the next one
+    if (status & (RxOk|RxError|RxOverflow|FifoOverflow))
+    {
+        receive();
+    }
+}
+
+void RTL8139::receive()
+{
+    while (!(inb(m_iobase + CMD) & BufferEmpty))
+    {
+        const uint8_t* entry = m_rcv_buf + m_rx_offset;
+        const uint16_t rx_status = entry[0] | (entry[1] << 8);
+        const uint16_t length    = entry[2] | (entry[3] << 8); // includes the CRC
+
+        if (!(rx_status & rx_status_ok) || length < 4 + 14 || length > max_frame_size + 4)
+        {
+            ++m_stats.rx_errors;
+            restart_rx();
+            return;
+        }
+
+        if (auto packet = net::PacketPool::kernel().allocate())
+        {
+            memcpy(packet->data(), entry + 4, length - 4);
+            packet->resize(length - 4);
+            deliver(std::move(packet));
+        }
+        else
+        {
+            ++m_stats.rx_dropped;
+        }
+
+        m_rx_offset = ((m_rx_offset + length + 4 + 3) & ~3) % rx_buf_size;
+        outw(m_iobase + CAPR, m_rx_offset - 16); // the register is biased by 16
+    }
+}
+
+void RTL8139::reclaim_tx()
+{
+    IrqGuard guard;
+
+    while (m_tx_tail != m_tx_head)
+    {
+        const size_t desc = m_tx_tail % tx_descriptors;
+        const uint32_t tsd = inl(m_iobase + TSD0 + desc*4);
+        if (!(tsd & (TxStatusOk|TxUnderrun|TxAborted)))
+        {
+            break; // still being sent
+        }
+
+        if (tsd & TxStatusOk)
+        {
+            ++m_stats.tx_packets;
+            m_stats.tx_bytes += m_tx_packets[desc]->size();
+        }
+        else
+        {
+            ++m_stats.tx_errors;
+        }
+
+        m_tx_packets[desc].reset();
+        ++m_tx_tail;
+    }
+}
+
 ADD_PCI_DRIVER(RTL8139)
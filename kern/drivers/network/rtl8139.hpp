@@ -29,14 +29,19 @@ SOFTWARE.
 
 #include "drivers/pci/pcidriver.hpp"
 #include "drivers/network/driver.hpp"
+#include "tasking/softirq.hpp"
 
 class RTL8139 : public NetworkDriver, public PciDriver
 {
 public:
+    RTL8139();
+
     virtual void init() override;
 
     virtual kpp::array<uint8_t, 6> mac_address() const override;
 
+    virtual kpp::expected<kpp::dummy_t, NetworkError> send(net::PacketRef packet) override;
+
     static bool accept(const pci::PciDevice& dev);
 
     virtual kpp::string_view driver_name() const override { return "Realtek RTL8139"; }
@@ -45,10 +50,30 @@ private:
     void power_on();
     void soft_reset();
     void set_rcv_buf(uint8_t* ptr);
+    void restart_rx();
+
+    // acknowledges the interrupt and defers the work to handle_events()
+    bool irq_handler();
+    void handle_events(uint16_t status);
+
+    void receive();
+    void reclaim_tx();
+
+public:
+    static constexpr size_t rx_buf_size { 8192 };
+    static constexpr size_t tx_descriptors { 4 };
 
 private:
     uint16_t m_iobase {};
-    kpp::array<uint8_t, 8192 + 16 + 1500> m_rcv_buf;
+    uint8_t* m_rcv_buf { nullptr };
+    uint16_t m_rx_offset { 0 };
+
+    // the chip owns descriptors [m_tx_tail; m_tx_head), modulo tx_descriptors
+    net::PacketRef m_tx_packets[tx_descriptors];
+    size_t m_tx_head { 0 };
+    size_t m_tx_tail { 0 };
+
+    softirq::Queue<uint16_t, 16> m_events;
 };
 
 #endif // RTL8139_HPP
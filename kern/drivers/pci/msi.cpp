@@ -0,0 +1,133 @@
+/*
+msi.cpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "msi.hpp"
+
+#include "i686/pc/devices/lapic.hpp"
+#include "utils/logging.hpp"
+
+namespace pci
+{
+namespace
+{
+constexpr uint16_t msi_control     = 0x2;
+constexpr uint16_t msi_address     = 0x4;
+constexpr uint16_t msi_upper_addr  = 0x8;
+constexpr uint16_t msi_data_32     = 0x8;
+constexpr uint16_t msi_data_64     = 0xC;
+
+constexpr uint16_t control_enable  = 1<<0;
+constexpr uint16_t control_mme     = 0b111<<4; // multiple message enable
+constexpr uint16_t control_64bit   = 1<<7;
+
+constexpr uint16_t command_reg           = 0x4;
+constexpr uint16_t command_int_disable   = 1<<10;
+
+constexpr uint32_t lapic_msi_base = 0xFEE00000;
+
+void set_intx_disabled(const PciDevice& dev, bool disabled)
+{
+    uint16_t command = read_config(dev.bus, dev.slot, dev.func, command_reg, 16);
+    if (disabled) command |= command_int_disable;
+    else          command &= ~command_int_disable;
+    write_config(dev.bus, dev.slot, dev.func, command_reg, command, 16);
+}
+}
+
+bool has_msi(const PciDevice& dev)
+{
+    return find_capability(dev, CapMSI) != 0;
+}
+
+uint8_t enable_msi(const PciDevice& dev, isr::isr_t handler)
+{
+    const uint8_t cap = find_capability(dev, CapMSI);
+    if (!cap || !lapic::init())
+    {
+        return 0;
+    }
+
+    const uint8_t vector = isr::allocate_vector(std::move(handler));
+    if (!vector)
+    {
+        warn("No interrupt vector left for the MSI of PCI device %x:%x:%x\n", dev.bus, dev.slot, dev.func);
+        return 0;
+    }
+
+    uint16_t control = read_config(dev.bus, dev.slot, dev.func, cap + msi_control, 16);
+
+    // fixed delivery, edge triggered, physical destination : the boot CPU
+    write_config(dev.bus, dev.slot, dev.func, cap + msi_address, lapic_msi_base | (lapic::id() << 12), 32);
+    if (control & control_64bit)
+    {
+        write_config(dev.bus, dev.slot, dev.func, cap + msi_upper_addr, 0, 32);
+        write_config(dev.bus, dev.slot, dev.func, cap + msi_data_64, vector, 16);
+    }
+    else
+    {
+        write_config(dev.bus, dev.slot, dev.func, cap + msi_data_32, vector, 16);
+    }
+
+    control &= ~control_mme; // a single message
+    control |= control_enable;
+    write_config(dev.bus, dev.slot, dev.func, cap + msi_control, control, 16);
+
+    set_intx_disabled(dev, true);
+
+    log(Debug, "PCI device %x:%x:%x uses MSI vector %d\n", dev.bus, dev.slot, dev.func, vector);
+
+    return vector;
+}
+
+void disable_msi(const PciDevice& dev, uint8_t vector)
+{
+    const uint8_t cap = find_capability(dev, CapMSI);
+    if (!cap) return;
+
+    uint16_t control = read_config(dev.bus, dev.slot, dev.func, cap + msi_control, 16);
+    control &= ~control_enable;
+    write_config(dev.bus, dev.slot, dev.func, cap + msi_control, control, 16);
+
+    set_intx_disabled(dev, false);
+    isr::free_vector(vector);
+}
+
+uint8_t install_irq_handler(const PciDevice& dev, isr::isr_t handler)
+{
+    if (uint8_t vector = enable_msi(dev, handler); vector)
+    {
+        return vector;
+    }
+
+    const uint8_t line = get_irq(dev);
+    if (line == 0 || line >= 16) // 0xFF : not connected
+    {
+        return 0;
+    }
+
+    isr::register_handler(IRQ0 + line, std::move(handler));
+    return IRQ0 + line;
+}
+}
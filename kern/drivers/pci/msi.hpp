@@ -0,0 +1,46 @@
+/*
+msi.hpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+#ifndef MSI_HPP
+#define MSI_HPP
+
+#include <stdint.h>
+
+#include "pci.hpp"
+#include "i686/interrupts/isr.hpp"
+
+namespace pci
+{
+bool has_msi(const PciDevice& dev);
+
+// Routes the device's MSI to a vector of its own on the boot CPU's local APIC and masks its INTx pin ;
+// returns the vector, 0 if the device or the CPU can't do it
+uint8_t enable_msi(const PciDevice& dev, isr::isr_t handler);
+void disable_msi(const PciDevice& dev, uint8_t vector);
+
+// enable_msi() when possible, the legacy interrupt line otherwise ; returns the vector used, 0 if none
+uint8_t install_irq_handler(const PciDevice& dev, isr::isr_t handler);
+}
+
+#endif // MSI_HPP
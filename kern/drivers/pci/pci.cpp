@@ -25,27 +25,176 @@ SOFTWARE.
 
 #include "pci.hpp"
 
+#include <algorithm.hpp>
+#include <unordered_map.hpp>
+
 #include "pci_vendors.hpp"
 
 #include "io.hpp"
+#include "mem/memmap.hpp"
+#include "i686/pc/bios/acpi_tables.hpp"
 
 #include "utils/logging.hpp"
 
 std::vector<pci::PciDevice> pci::devices;
 
+namespace
+{
+struct EcamRegion
+{
+    uint64_t phys_base;
+    uint8_t start_bus;
+    uint8_t end_bus;
+};
+
+constexpr size_t ecam_bus_size { 1<<20 }; // 32 devices * 8 functions * 4 KiB
+
+std::vector<EcamRegion> ecam_regions;
+volatile uint8_t* ecam_buses[256] { nullptr };
+
+bool scanned_buses[256] { false };
+
+// indexes into pci::devices, by address and by (class, subclass)
+std::unordered_map<uint32_t, size_t> devices_by_address;
+std::unordered_map<uint16_t, std::vector<size_t>> devices_by_class;
+
 inline uint32_t devaddr(uint16_t bus, uint16_t slot, uint16_t func, uint16_t offset)
 {
     return (uint32_t)(bus  << 16) | (uint32_t)(slot   << 11 ) |
            (uint32_t)(func << 8 ) | (uint32_t)(offset & ~0x3) | 0x80000000u;
 }
 
-uint32_t pci::read32(uint16_t bus, uint16_t slot, uint16_t func, uint16_t offset)
+inline uint32_t address_key(uint16_t bus, uint16_t slot, uint16_t func)
 {
-    assert((offset & 0x3) == 0); // only aligned accesses
+    return (uint32_t(bus) << 8) | (slot << 3) | func;
+}
+
+volatile uint8_t* ecam_bus(uint16_t bus)
+{
+    if (bus > 0xFF) return nullptr;
+    if (ecam_buses[bus]) return ecam_buses[bus];
+
+    for (const auto& region : ecam_regions)
+    {
+        if (bus < region.start_bus || bus > region.end_bus) continue;
+
+        const uint64_t phys = region.phys_base + uint64_t(bus - region.start_bus) * ecam_bus_size;
+        if (phys + ecam_bus_size > 0x100000000ULL) return nullptr; // no PAE
+
+        ecam_buses[bus] = (volatile uint8_t*)Memory::mmap(phys, ecam_bus_size, Memory::Read|Memory::Write|Memory::Uncached);
+        return ecam_buses[bus];
+    }
+
+    return nullptr;
+}
+
+void detect_ecam()
+{
+    struct [[gnu::packed]] McfgAllocation
+    {
+        uint64_t address;
+        uint16_t segment;
+        uint8_t start_bus;
+        uint8_t end_bus;
+        uint32_t reserved;
+    };
+
+    const auto mcfg = acpi_tables::read("MCFG");
+    const size_t entries_offset = sizeof(acpi_tables::SDTHeader) + 8;
+
+    for (size_t off { entries_offset }; off + sizeof(McfgAllocation) <= mcfg.size(); off += sizeof(McfgAllocation))
+    {
+        auto entry = reinterpret_cast<const McfgAllocation*>(mcfg.data() + off);
+        if (entry->segment != 0) continue; // only segment 0 is reachable from the legacy ports
+
+        pci::add_ecam_region(entry->address, entry->start_bus, entry->end_bus);
+    }
+}
+
+void build_index()
+{
+    devices_by_address.clear();
+    devices_by_class.clear();
+
+    for (size_t i { 0 }; i < pci::devices.size(); ++i)
+    {
+        const auto& dev = pci::devices[i];
+        devices_by_address[address_key(dev.bus, dev.slot, dev.func)] = i;
+        devices_by_class[(dev.classCode << 8) | dev.subclass].emplace_back(i);
+    }
+}
+}
+
+uint32_t pci::read_config(uint16_t bus, uint16_t slot, uint16_t func, uint16_t offset, uint8_t width)
+{
+    assert(width == 8 || width == 16 || width == 32);
+    assert((offset & (width/8 - 1)) == 0); // only aligned accesses
+
+    if (auto base = ecam_bus(bus))
+    {
+        volatile uint8_t* addr = base + (slot << 15) + (func << 12) + offset;
+        switch (width)
+        {
+            case 8:  return *addr;
+            case 16: return *reinterpret_cast<volatile uint16_t*>(addr);
+            default: return *reinterpret_cast<volatile uint32_t*>(addr);
+        }
+    }
+
+    assert(offset < 0x100);
+    outl(0xCF8, devaddr(bus, slot, func, offset));
+    switch (width)
+    {
+        case 8:  return inb(0xCFC + (offset & 0x3));
+        case 16: return inw(0xCFC + (offset & 0x2));
+        default: return inl(0xCFC);
+    }
+}
+
+void pci::write_config(uint16_t bus, uint16_t slot, uint16_t func, uint16_t offset, uint32_t val, uint8_t width)
+{
+    assert(width == 8 || width == 16 || width == 32);
+    assert((offset & (width/8 - 1)) == 0);
+
+    if (auto base = ecam_bus(bus))
+    {
+        volatile uint8_t* addr = base + (slot << 15) + (func << 12) + offset;
+        switch (width)
+        {
+            case 8:  *addr = val; break;
+            case 16: *reinterpret_cast<volatile uint16_t*>(addr) = val; break;
+            default: *reinterpret_cast<volatile uint32_t*>(addr) = val; break;
+        }
+        return;
+    }
 
+    assert(offset < 0x100);
     outl(0xCF8, devaddr(bus, slot, func, offset));
+    switch (width)
+    {
+        case 8:  outb(0xCFC + (offset & 0x3), val); break;
+        case 16: outw(0xCFC + (offset & 0x2), val); break;
+        default: outl(0xCFC, val); break;
+    }
+}
+
+void pci::add_ecam_region(uint64_t phys_base, uint8_t start_bus, uint8_t end_bus)
+{
+    ecam_regions.push_back({phys_base, start_bus, end_bus});
+
+    log(Info, "PCI ECAM for buses %d-%d at 0x%llx\n", start_bus, end_bus, phys_base);
+}
 
-    return inl(0xCFC);
+bool pci::uses_ecam(uint16_t bus)
+{
+    return ecam_bus(bus) != nullptr;
+}
+
+uint32_t pci::read32(uint16_t bus, uint16_t slot, uint16_t func, uint16_t offset)
+{
+    assert((offset & 0x3) == 0); // only aligned accesses
+
+    return read_config(bus, slot, func, offset, 32);
 }
 
 uint16_t pci::read16(uint16_t bus, uint16_t slot, uint16_t func, uint16_t offset)
@@ -67,9 +216,7 @@ void pci::write32(uint16_t bus, uint16_t slot, uint16_t func, uint16_t offset, u
 {
     assert((offset & 0x3) == 0);
 
-    outl(0xCF8, devaddr(bus, slot, func, offset));
-
-    outl(0xCFC, val);
+    write_config(bus, slot, func, offset, val, 32);
 }
 
 void pci::write16(uint16_t bus, uint16_t slot, uint16_t func, uint16_t offset, uint16_t val)
@@ -86,14 +233,8 @@ void pci::write16(uint16_t bus, uint16_t slot, uint16_t func, uint16_t offset, u
 
 void pci::write8(uint16_t bus, uint16_t slot, uint16_t func, uint16_t offset, uint8_t val)
 {
-    assert((offset & 0x1) == 0);
-
-    uint32_t src_val = read32(bus, slot, func, offset & ~0x3);
-    uint32_t mask    = (0x000000FF << 8*(offset&0x3));
-    src_val &= mask;
-    src_val |= (val << (32 - 8*(offset&0x3)));
-
-    write32(bus, slot, func, offset & ~0x3, src_val);
+    // same byte addressing as read8()
+    write_config(bus, slot, func, offset, val, 8);
 }
 
 
@@ -112,6 +253,17 @@ uint8_t pci::header_type(uint16_t bus, uint16_t slot, uint16_t func)
     return read8(bus, slot, func, 0xD);
 }
 
+void pci::check_bus(uint8_t bus)
+{
+    if (scanned_buses[bus]) return; // misconfigured bridges could loop
+    scanned_buses[bus] = true;
+
+    for (uint8_t device = 0; device < 32; device++)
+    {
+        check_device(bus, device);
+    }
+}
+
 void pci::check_device(uint8_t bus, uint8_t device)
 {
     uint8_t function = 0;
@@ -120,7 +272,7 @@ void pci::check_device(uint8_t bus, uint8_t device)
     if(vendorID == 0xFFFF) return;        // Device doesn't exist
     check_function(bus, device, function);
     uint8_t headerType = header_type(bus, device, function);
-    if( (headerType & 0x80) != 0 || true)
+    if( (headerType & 0x80) != 0)
     {
         /* It is a multi-function device, so check remaining functions */
         for(function = 1; function < 8; function++)
@@ -138,17 +290,48 @@ void pci::check_function(uint8_t bus, uint8_t device, uint8_t function)
     auto dev = get_dev(bus, device, function);
 
     pci::devices.emplace_back(dev);
+
+    // PCI-to-PCI bridge : enumerate the bus behind it
+    if (dev.classCode == 0x06 && dev.subclass == 0x04)
+    {
+        const uint8_t secondary_bus = read_config(bus, device, function, 0x19, 8);
+        if (secondary_bus != 0)
+        {
+            check_bus(secondary_bus);
+        }
+    }
 }
 
 void pci::scan()
 {
-    for(uint16_t bus = 0; bus < 256; bus++)
+    pci::devices.clear();
+    std::fill(std::begin(scanned_buses), std::end(scanned_buses), false);
+
+    if (ecam_regions.empty())
+    {
+        detect_ecam();
+    }
+
+    if ((header_type(0, 0, 0) & 0x80) == 0)
     {
-        for (uint8_t device = 0; device < 32; device++)
+        // single host controller
+        check_bus(0);
+    }
+    else
+    {
+        // one host controller per function of the host bridge, handling the bus of the same number
+        for (uint8_t function = 0; function < 8; function++)
         {
-            check_device(bus, device);
+            if (vendor_id(0, 0, function) != 0xFFFF)
+            {
+                check_bus(function);
+            }
         }
     }
+
+    build_index();
+
+    log(Info, "PCI : %d devices found%s\n", pci::devices.size(), uses_ecam(0) ? " (ECAM)" : "");
 }
 
 uint8_t pci::base_class(uint16_t bus, uint16_t slot, uint16_t func)
@@ -183,34 +366,57 @@ pci::PciDevice pci::get_dev(uint16_t bus, uint16_t slot, uint16_t func)
     return dev;
 }
 
-std::vector<pci::PciDevice> pci::find_devices(uint8_t class_code, uint8_t sub_class)
+uint8_t pci::find_capability(const PciDevice &dev, uint8_t id)
 {
-    std::vector<pci::PciDevice> devices;
+    if (!(dev.status & (1<<4))) return 0; // no capabilities list
 
-    for (const auto& device : pci::devices)
+    // the list could be corrupted, don't follow more links than can fit in the config space
+    uint8_t offset = read_config(dev.bus, dev.slot, dev.func, 0x34, 8) & ~0x3;
+    for (size_t i { 0 }; offset != 0 && i < 48; ++i)
     {
-        if (device.classCode == class_code && device.subclass == sub_class)
+        if (read_config(dev.bus, dev.slot, dev.func, offset, 8) == id)
         {
-            devices.emplace_back(device);
+            return offset;
         }
+        offset = read_config(dev.bus, dev.slot, dev.func, offset + 1, 8) & ~0x3;
     }
 
-    return devices;
+    return 0;
 }
 
-std::vector<pci::PciDevice> pci::find_devices(uint8_t class_code, uint8_t sub_class, uint8_t interface)
+const pci::PciDevice* pci::find_device(uint16_t bus, uint16_t slot, uint16_t func)
 {
-    std::vector<pci::PciDevice> devices;
+    auto it = devices_by_address.find(address_key(bus, slot, func));
+    if (it == devices_by_address.end()) return nullptr;
 
-    for (const auto& device : pci::devices)
+    return &pci::devices[it->second];
+}
+
+std::vector<const pci::PciDevice*> pci::find_devices(uint8_t class_code, uint8_t sub_class)
+{
+    std::vector<const pci::PciDevice*> result;
+
+    auto it = devices_by_class.find((class_code << 8) | sub_class);
+    if (it != devices_by_class.end())
     {
-        if (device.classCode == class_code && device.subclass == sub_class && device.progIF == interface)
+        for (size_t idx : it->second)
         {
-            devices.emplace_back(device);
+            result.emplace_back(&pci::devices[idx]);
         }
     }
 
-    return devices;
+    return result;
+}
+
+std::vector<const pci::PciDevice*> pci::find_devices(uint8_t class_code, uint8_t sub_class, uint8_t interface)
+{
+    auto result = find_devices(class_code, sub_class);
+    result.erase(std::remove_if(result.begin(), result.end(), [interface](const PciDevice* dev)
+    {
+        return dev->progIF != interface;
+    }), result.end());
+
+    return result;
 }
 
 uint64_t pci::get_bar_val(const pci::PciDevice& dev, size_t bar_idx)
@@ -236,7 +442,7 @@ uint64_t pci::get_bar_val(const pci::PciDevice& dev, size_t bar_idx)
     return 0;
 }
 
-uint8_t get_irq(const pci::PciDevice &dev)
+uint8_t pci::get_irq(const pci::PciDevice &dev)
 {
     // TODO : IO APIC
     return dev.int_line;
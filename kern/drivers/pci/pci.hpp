@@ -112,8 +112,16 @@ inline BARType bar_type(uint32_t bar)
     return BARType::Invalid;
 }
 
+enum Capability : uint8_t
+{
+    CapMSI  = 0x05,
+    CapMSIX = 0x11
+};
+
 uint64_t get_bar_val(const pci::PciDevice& dev, size_t bar_idx);
 
+// Configuration space accessors ; they go through the memory-mapped ECAM window of the bus
+// when the MCFG table describes one, through the 0xCF8/0xCFC ports otherwise
 uint32_t read32 (uint16_t bus, uint16_t slot, uint16_t func, uint16_t offset);
 uint16_t read16 (uint16_t bus, uint16_t slot, uint16_t func, uint16_t offset);
 uint8_t  read8  (uint16_t bus, uint16_t slot, uint16_t func, uint16_t offset);
@@ -121,6 +129,14 @@ void     write32(uint16_t bus, uint16_t slot, uint16_t func, uint16_t offset, ui
 void     write16(uint16_t bus, uint16_t slot, uint16_t func, uint16_t offset, uint16_t val);
 void     write8(uint16_t bus, uint16_t slot, uint16_t func, uint16_t offset, uint8_t val);
 
+// 'offset' is the register offset from the specification, 'width' is 8, 16 or 32
+uint32_t read_config (uint16_t bus, uint16_t slot, uint16_t func, uint16_t offset, uint8_t width);
+void     write_config(uint16_t bus, uint16_t slot, uint16_t func, uint16_t offset, uint32_t val, uint8_t width);
+
+// buses [start_bus; end_bus] of segment 0 are accessible at 'phys_base' ; mapped lazily, one bus at a time
+void add_ecam_region(uint64_t phys_base, uint8_t start_bus, uint8_t end_bus);
+bool uses_ecam(uint16_t bus);
+
 uint16_t device_id(uint16_t bus, uint16_t slot, uint16_t func);
 uint16_t vendor_id(uint16_t bus, uint16_t slot, uint16_t func);
 uint8_t header_type(uint16_t bus, uint16_t slot, uint16_t func);
@@ -128,17 +144,24 @@ uint8_t base_class(uint16_t bus, uint16_t slot, uint16_t func);
 uint8_t sub_class(uint16_t bus, uint16_t slot, uint16_t func);
 uint8_t prog_if(uint16_t bus, uint16_t slot, uint16_t func);
 
+void check_bus(uint8_t bus);
 void check_device(uint8_t bus, uint8_t device);
 void check_function(uint8_t bus, uint8_t device, uint8_t function);
 
 PciDevice get_dev(uint16_t bus, uint16_t slot, uint16_t func);
 
+// config space offset of the capability 'id', 0 if the device doesn't have it
+uint8_t find_capability(const PciDevice& dev, uint8_t id);
+
 uint8_t get_irq(const pci::PciDevice& dev);
 
+// enumerates the buses reachable from the host bridges ; the device table is built once,
+// pointers into it stay valid afterwards
 void scan();
 
-std::vector<PciDevice> find_devices(uint8_t class_code, uint8_t sub_class);
-std::vector<PciDevice> find_devices(uint8_t class_code, uint8_t sub_class, uint8_t interface);
+const PciDevice* find_device(uint16_t bus, uint16_t slot, uint16_t func);
+std::vector<const PciDevice*> find_devices(uint8_t class_code, uint8_t sub_class);
+std::vector<const PciDevice*> find_devices(uint8_t class_code, uint8_t sub_class, uint8_t interface);
 
 extern std::vector<PciDevice> devices;
 }
@@ -26,6 +26,7 @@ SOFTWARE.
 #include "ahci.hpp"
 
 #include "drivers/pci/pci.hpp"
+#include "drivers/pci/msi.hpp"
 
 #include "utils/logging.hpp"
 #include "utils/bitops.hpp"
@@ -93,9 +94,8 @@ bool init()
         return false;
     }
 
-    log(Debug, "AHCI interrupt line : %d\n", detail::get_interrupt_line());
-
-    isr::register_handler(detail::get_interrupt_line(), &detail::ahci_isr);
+    const uint8_t vector = pci::install_irq_handler(detail::controller(), &detail::ahci_isr);
+    log(Debug, "AHCI interrupt vector : %d%s\n", vector, pci::has_msi(detail::controller()) ? " (MSI)" : "");
 
     //mem->ghc |= detail::ghd_int_enable;
 
@@ -177,20 +177,16 @@ kpp::expected<kpp::dummy_t, DiskError> ahci::Disk::write_sectors(size_t sector,
     return {};
 }
 
-uint8_t detail::get_interrupt_line()
+const pci::PciDevice& detail::controller()
 {
-    auto ahci_con = pci::find_devices(0x1, 0x6, 0x1)[0];
-
-    return ahci_con.int_line;
+    return *pci::find_devices(0x1, 0x6, 0x1)[0];
 }
 
 detail::HBAMem *detail::get_hbamem_ptr()
 {
     if (!available()) return nullptr;
 
-    auto ahci_con = pci::find_devices(0x1, 0x6, 0x1)[0];
-
-    auto bar = pci::get_bar_val(ahci_con, 5);
+    auto bar = pci::get_bar_val(controller(), 5);
 
     return reinterpret_cast<HBAMem*>(Memory::mmap(bar, 0x1100, Memory::Read|Memory::Write|Memory::Uncached));
 }
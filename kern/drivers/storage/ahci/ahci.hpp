@@ -32,6 +32,7 @@ SOFTWARE.
 #include "i686/cpu/registers.hpp"
 #include "drivers/storage/ide/ide_common.hpp"
 #include "drivers/storage/disk.hpp"
+#include "drivers/pci/pci.hpp"
 
 namespace ahci
 {
@@ -324,7 +325,7 @@ bool ahci_isr(const registers* reg);
 
 HBAMem* get_hbamem_ptr();
 
-uint8_t get_interrupt_line();
+const pci::PciDevice& controller();
 
 void get_ahci_ownership();
 
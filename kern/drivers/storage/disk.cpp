@@ -37,22 +37,28 @@ SOFTWARE.
 
 void Disk::system_init()
 {
-    kmsgbus.register_handler<SyncDisksCache>([](const SyncDisksCache&)
+    kmsgbus.subscribe<SyncDisksCache>([](const SyncDisksCache&)
     {
-        for (Disk& disk : disks())
-        {
-            auto result = disk.flush_cache();
-            if (!result)
-                err("Could not flush disk %s : %s\n", disk.drive_name().c_str(), result.error().to_string());
-        }
+        flush_all_caches();
     });
 
+    // the caches must be written before powering off, don't wait for the asynchronous handler
     kmsgbus.register_handler<ShutdownMessage>([](const ShutdownMessage&)
     {
-        kmsgbus.send(SyncDisksCache{});
+        flush_all_caches();
     });
 }
 
+void Disk::flush_all_caches()
+{
+    for (Disk& disk : disks())
+    {
+        auto result = disk.flush_cache();
+        if (!result)
+            err("Could not flush disk %s : %s\n", disk.drive_name().c_str(), result.error().to_string());
+    }
+}
+
 Disk::Disk()
     : m_cache(*this)
 {
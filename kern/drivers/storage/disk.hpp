@@ -92,6 +92,9 @@ class Disk : NonCopyable
 public:
     static void system_init();
 
+    // flushes the cache of every disk
+    static void flush_all_caches();
+
     enum Type
     {
         Floppy,
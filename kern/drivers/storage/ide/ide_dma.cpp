@@ -30,6 +30,7 @@ SOFTWARE.
 #include "utils/bitops.hpp"
 #include "utils/memutils.hpp"
 #include "time/timer.hpp"
+#include "drivers/pci/msi.hpp"
 #include "i686/interrupts/interrupts.hpp"
 
 #include "tasking/process.hpp"
@@ -102,9 +103,9 @@ void Controller::init()
 
     log(Debug, "PCI Interrupt : %d\n", m_dev.int_line);
 
-    if ((!m_primary_compatibility || !m_secondary_compatibility) && m_dev.int_line != 0)
+    if (!m_primary_compatibility || !m_secondary_compatibility)
     {
-        isr::register_handler(IRQ0 + m_dev.int_line, [](const registers*)
+        pci::install_irq_handler(m_dev, [](const registers*)
         {
             log(Debug, "Booh it was called !\n");
             return true;
@@ -27,6 +27,8 @@ SOFTWARE.
 
 #include "mem/memmap.hpp"
 
+#include <algorithm.hpp>
+
 #include "utils/logging.hpp"
 
 namespace elf
@@ -34,46 +36,94 @@ namespace elf
 
 SymbolTable kernel_symbol_table;
 
+const Symbol* SymbolTable::find(uintptr_t addr) const
+{
+    // first symbol at or after addr, the one before it contains addr-1
+    auto it = std::lower_bound(symbols.begin(), symbols.end(), addr, [](const Symbol& sym, uintptr_t value)
+    {
+        return sym.address < value;
+    });
+
+    if (it == symbols.begin())
+    {
+        return nullptr;
+    }
+
+    // a sized symbol ending before addr-1 doesn't contain it, addr is in a gap or in code without symbols
+    const Symbol& sym = *std::prev(it);
+    if (sym.size != 0 && addr - 1 - sym.address >= sym.size)
+    {
+        return nullptr;
+    }
+
+    return &sym;
+}
+
 SymbolTable get_symbol_table(const Elf32_Shdr *base, size_t sh_num)
 {
     if (base == nullptr || sh_num == 0) return {};
 
     SymbolTable symbol_table;
 
+    auto strtab = elf::section(base, sh_num, elf::SHT_STRTAB);
     const char* strtable;
-    if (elf::section(base, sh_num, elf::SHT_STRTAB)->sh_addr)
+    if (strtab->sh_addr)
     {
-        strtable = (const char*)Memory::mmap(elf::section(base, sh_num, elf::SHT_STRTAB)->sh_addr,
-                                             elf::section(base, sh_num, elf::SHT_STRTAB)->sh_size);
+        strtable = (const char*)Memory::mmap(strtab->sh_addr, strtab->sh_size, Memory::Read);
     }
     else
     {
-        strtable = reinterpret_cast<const char*>(current_elf_file + elf::section(base, sh_num, elf::SHT_STRTAB)->sh_offset);
+        strtable = reinterpret_cast<const char*>(current_elf_file + strtab->sh_offset);
     }
 
     auto symtab = (Elf32_Shdr*)elf::section(base, sh_num, elf::SHT_SYMTAB);
     if (!symtab) return {};
     symtab->sh_addr = (Elf32_Addr)Memory::mmap(symtab->sh_addr, symtab->sh_size, Memory::Read);
 
-    kpp::string current_symbol_file;
+    // the names are offsets in a copy of the string table, no per-symbol allocation is needed
+    symbol_table.strings.assign(strtable, strtable + strtab->sh_size);
+    if (symbol_table.strings.empty() || symbol_table.strings.back() != '\0')
+    {
+        symbol_table.strings.emplace_back('\0');
+    }
+
+    uint32_t current_symbol_file = 0; // the string table starts with an empty string
 
-    for (size_t j { 0 }; j < symtab->sh_size / symtab->sh_entsize; ++j)
+    const size_t count = symtab->sh_size / symtab->sh_entsize;
+    symbol_table.symbols.reserve(count);
+    for (size_t j { 0 }; j < count; ++j)
     {
         auto symbol = (const Elf32_Sym*)elf::symbol(symtab, j);
-        if (symbol->st_name)
+        if (symbol->st_name && symbol->st_name < strtab->sh_size)
         {
             if (ELF32_ST_TYPE(symbol->st_info) == elf::STT_FILE)
             {
-                current_symbol_file = elf::lookup_str(strtable, symbol->st_name);
+                current_symbol_file = symbol->st_name;
             }
             else if (symbol->st_value)
             {
-                symbol_table.table[symbol->st_value] = {elf::lookup_str(strtable, symbol->st_name), current_symbol_file, symbol->st_value};
+                symbol_table.symbols.emplace_back(Symbol{symbol->st_value, symbol->st_size, symbol->st_name, current_symbol_file});
             }
         }
     }
 
     Memory::unmap((void*)symtab->sh_addr, symtab->sh_size);
+    if (strtab->sh_addr)
+    {
+        Memory::unmap((void*)strtable, strtab->sh_size);
+    }
+
+    // when several symbols share an address, the last one in the ELF file wins
+    std::stable_sort(symbol_table.symbols.begin(), symbol_table.symbols.end(), [](const Symbol& lhs, const Symbol& rhs)
+    {
+        return lhs.address < rhs.address;
+    });
+    auto last = std::unique(symbol_table.symbols.rbegin(), symbol_table.symbols.rend(), [](const Symbol& lhs, const Symbol& rhs)
+    {
+        return lhs.address == rhs.address;
+    });
+    symbol_table.symbols.erase(symbol_table.symbols.begin(), last.base());
+    symbol_table.symbols.shrink_to_fit();
 
     return symbol_table;
 }
@@ -27,7 +27,7 @@ SOFTWARE.
 
 #include <stdint.h>
 
-#include <unordered_map.hpp>
+#include <vector.hpp>
 #include <optional.hpp>
 
 #include <kstring/kstring.hpp>
@@ -46,22 +46,38 @@ struct SymbolInfo
     uintptr_t offset;
 };
 
+struct Symbol
+{
+    uintptr_t address;
+    uint32_t  size;
+    uint32_t  name; // offsets in the string blob
+    uint32_t  file;
+};
+
+// Immutable table of symbols sorted by address, the names are kept in a single string blob
 struct SymbolTable
 {
-    kpp::optional<SymbolInfo> get_function(uintptr_t addr)
+    // nearest symbol before addr, which is usually a return address ; null if that symbol has a size
+    // and ends before addr
+    const Symbol* find(uintptr_t addr) const;
+
+    const char* name(const Symbol& sym) const
+    {
+        return strings.data() + sym.name;
+    }
+
+    kpp::optional<SymbolInfo> get_function(uintptr_t addr) const
     {
-        while (addr-- > KERNEL_VIRTUAL_BASE)
+        if (auto sym = find(addr))
         {
-            if (auto it = table.find(addr); it != table.end())
-            {
-                return it->second;
-            }
+            return SymbolInfo{name(*sym), strings.data() + sym->file, sym->address};
         }
 
         return {};
     }
 
-    std::unordered_map<uintptr_t, SymbolInfo> table;
+    std::vector<Symbol> symbols;
+    std::vector<char> strings;
 };
 
 bool has_symbol_table(const Elf32_Shdr* base, size_t sh_num);
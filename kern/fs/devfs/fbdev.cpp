@@ -25,6 +25,8 @@ SOFTWARE.
 
 #include "fbdev.hpp"
 
+#include <errno.h>
+
 #include "graphics/video.hpp"
 #include "tasking/process.hpp"
 
@@ -51,7 +53,7 @@ FBDevMode to_fbdevmode(const graphics::VideoMode& mode)
     return fbmode;
 }
 
-int fbdev_node::get_video_modes(FBDevMode *buffer, size_t buffer_count) const
+int fbdev_node::get_video_modes(user_ptr<FBDevMode> buffer, size_t buffer_count) const
 {
     auto modes = graphics::list_video_modes();
     const size_t amount = std::min(modes.size(), buffer_count);
@@ -67,17 +69,20 @@ int fbdev_node::get_video_modes(FBDevMode *buffer, size_t buffer_count) const
         if (mode.type == graphics::VideoMode::Text)
             continue;
 
-        buffer[buffer_counter] = to_fbdevmode(mode);
+        const FBDevMode fbmode = to_fbdevmode(mode);
+        if (copy_to_user((FBDevMode*)buffer.as_raw() + buffer_counter, &fbmode, sizeof(fbmode)) < 0)
+        {
+            return -EFAULT;
+        }
 
         ++buffer_counter;
     }
     return buffer_counter;
 }
 
-int fbdev_node::get_current_mode(FBDevMode *mode) const
+int fbdev_node::get_current_mode(user_ptr<FBDevMode> mode) const
 {
-    *mode = to_fbdevmode(graphics::current_video_mode());
-    return 0;
+    return mode.write(to_fbdevmode(graphics::current_video_mode())) ? 0 : -EFAULT;
 }
 
 int fbdev_node::switch_mode(int width, int height, int depth) const
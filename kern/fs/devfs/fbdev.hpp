@@ -26,6 +26,7 @@ SOFTWARE.
 #define FBDEV_HPP
 
 #include "fs/interface.hpp"
+#include "utils/user_ptr.hpp"
 
 #include <sys/interface_list.h>
 
@@ -37,8 +38,8 @@ struct fbdev_node : public vfs::interface_node<fbdev_node, vfs::ientry<ifbdev, I
     void fill_interface(Interface*) const
     {}
 
-    int get_video_modes(FBDevMode* buffer, size_t buffer_count) const;
-    int get_current_mode(FBDevMode* mode) const;
+    int get_video_modes(user_ptr<FBDevMode> buffer, size_t buffer_count) const;
+    int get_current_mode(user_ptr<FBDevMode> mode) const;
     int switch_mode(int width, int height, int depth) const;
     uint8_t* get_framebuffer() const;
 };
@@ -45,9 +45,12 @@ kbdev_node::kbdev_node(vfs::node *parent)
     });
 }
 
-int kbdev_node::get_kbd_state(kbd_state * state) const
+int kbdev_node::get_kbd_state(user_ptr<kbd_state> state) const
 {
-    memcpy(state->state, this->key_state, sizeof(key_state));
+    if (copy_to_user((void*)state.as_raw(), this->key_state, sizeof(key_state)) < 0)
+    {
+        return -EFAULT;
+    }
 
     return EOK;
 }
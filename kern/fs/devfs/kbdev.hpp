@@ -41,8 +41,7 @@ struct kbdev_node : public vfs::interface_node<kbdev_node, vfs::ientry<ikbdev, I
     void fill_interface(Interface*) const
     {}
 
-    // TODO : map pointers to user_ptr
-    int get_kbd_state(kbd_state*) const;
+    int get_kbd_state(user_ptr<kbd_state> state) const;
 
     size_t keyboard_id;
     MessageBus::RAIIHandle msg_hdl;
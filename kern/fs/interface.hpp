@@ -67,23 +67,13 @@ struct interface_node : public vfs::node
     }
 
 protected:
-    template <typename Return, typename... Args>
-    void register_callback(Return(Derived::*func)(Args...) const, Return(*&callback)(Args...)) const
+    // the kernel side takes user_ptr<> where the user side has raw pointers
+    template <typename Return, typename... Args, typename... UserArgs>
+    void register_callback(Return(Derived::*func)(Args...) const, Return(*&callback)(UserArgs...)) const
     {
-        const auto address =
-                Process::current().create_user_callback(std::function<int(Args...)>(
-        [func, this](Args&&... args)
-        {
-            if constexpr (std::is_same_v<Return, void>)
-            {
-                ((Derived*)this->*(func))(args...);
-                return 0;
-            }
-            else
-            {
-                return (int)((Derived*)this->*(func))(args...);
-            }
-        }));
+        static_assert(((sizeof(Args) == sizeof(UserArgs)) && ...), "callback arguments don't match the interface");
+
+        const auto address = Process::current().create_user_callback(static_cast<const Derived*>(this), func);
 
         callback = (decltype(callback))address;
     }
@@ -100,6 +90,8 @@ private:
     template <typename First>
     int get_interface_impl(int interface_id, void* interface) const
     {
+        static_assert(sizeof(typename First::interface_type) <= max_interface_size, "interface too large");
+
         if (First::interface_id != interface_id)
             return -1;
 
@@ -0,0 +1,180 @@
+/*
+mapped_file.cpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "mapped_file.hpp"
+
+#include <algorithm.hpp>
+
+#include "fs.hpp"
+#include "mem/memmap.hpp"
+#include "utils/hash.hpp"
+#include "utils/logging.hpp"
+
+namespace vfs
+{
+
+static std::unordered_map<std::pair<dev_t, ino_t>, std::weak_ptr<mapped_file>, pair_hash> mapped_files;
+// synthetic files (procfs...) all have inode 0, they are told apart by their node
+static std::unordered_map<const node*, std::weak_ptr<mapped_file>> mapped_nodes;
+
+// drops the caches whose last mapping went away
+template <typename Map>
+static void prune(Map& map)
+{
+    for (auto it = map.begin(); it != map.end();)
+    {
+        if (it->second.expired())
+        {
+            it = map.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+template <typename Map, typename Key>
+static std::shared_ptr<mapped_file> get_cache(Map& map, const Key& key, const std::shared_ptr<node>& file)
+{
+    if (auto it = map.find(key); it != map.end())
+    {
+        if (auto existing = it->second.lock())
+        {
+            return existing;
+        }
+    }
+
+    prune(map);
+
+    auto cache = std::make_shared<mapped_file>(file);
+    map[key] = cache;
+
+    return cache;
+}
+
+mapped_file::mapped_file(const std::shared_ptr<node>& file)
+    : m_file(file)
+{
+    assert(m_file);
+}
+
+mapped_file::~mapped_file()
+{
+    if (auto result = sync(0, m_file->size() / Memory::page_size() + 1); !result)
+    {
+        warn("Could not write back the mapping of '%s' : %s\n", m_file->path().c_str(), result.error().to_string());
+    }
+
+    for (const auto& pair : m_pages)
+    {
+        Memory::release_physical_page(pair.second);
+    }
+}
+
+uintptr_t mapped_file::page(size_t index)
+{
+    if (auto it = m_pages.find(index); it != m_pages.end())
+    {
+        return it->second;
+    }
+
+    const uintptr_t phys = Memory::allocate_physical_page();
+    if (!phys) return 0;
+
+    const size_t offset = index * Memory::page_size();
+    const size_t file_size = m_file->size();
+    const size_t len = offset < file_size ? std::min<size_t>(file_size - offset, Memory::page_size()) : 0;
+
+    auto ptr = (uint8_t*)Memory::mmap(phys, Memory::page_size());
+    memset(ptr + len, 0, Memory::page_size() - len);
+    const bool read = len == 0 || m_file->read(offset, {ptr, len});
+    Memory::unmap(ptr, Memory::page_size());
+
+    // the read may have slept, and another fault on the same page brought it in meanwhile
+    if (!read || m_pages.count(index))
+    {
+        Memory::release_physical_page(phys);
+        return read ? m_pages.at(index) : 0;
+    }
+
+    m_pages[index] = phys;
+
+    return phys;
+}
+
+void mapped_file::mark_dirty(size_t index)
+{
+    assert(m_pages.count(index));
+
+    m_dirty.emplace(index);
+}
+
+node::result<kpp::dummy_t> mapped_file::sync(size_t first, size_t count)
+{
+    const size_t file_size = m_file->size();
+
+    for (size_t index : m_dirty)
+    {
+        if (index < first || index - first >= count)
+        {
+            continue;
+        }
+
+        // don't grow the file, what's written past its end is lost like on other systems
+        const size_t offset = index * Memory::page_size();
+        if (offset >= file_size)
+        {
+            continue;
+        }
+        const size_t len = std::min<size_t>(file_size - offset, Memory::page_size());
+
+        auto ptr = (const uint8_t*)Memory::mmap(m_pages.at(index), Memory::page_size(), Memory::Read);
+        auto result = m_file->write(offset, {ptr, len});
+        Memory::unmap((void*)ptr, Memory::page_size());
+
+        if (!result)
+        {
+            return kpp::make_unexpected(result.error());
+        }
+    }
+
+    return {};
+}
+
+std::shared_ptr<mapped_file> mapped_file::get(const std::shared_ptr<node>& file)
+{
+    const dev_t device = file->get_fs() ? file->get_fs()->fs_id : 0;
+    const ino_t inode  = file->stat().inode;
+
+    if (inode == 0)
+    {
+        return get_cache(mapped_nodes, file.get(), file);
+    }
+
+    return get_cache(mapped_files, std::make_pair(device, inode), file);
+}
+
+}
@@ -0,0 +1,76 @@
+/*
+mapped_file.hpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <stdint.h>
+#include <memory.hpp>
+#include <unordered_map.hpp>
+#include <unordered_set.hpp>
+
+#include "vfs.hpp"
+
+namespace vfs
+{
+
+// Page cache of a regular file, shared by every mmap of it.
+// Pages are read from the node on first use ; the ones written through a shared mapping are written back
+// by sync() and when the last mapping goes away.
+class mapped_file
+{
+public:
+    explicit mapped_file(const std::shared_ptr<node>& file);
+    ~mapped_file();
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+public:
+    // physical page holding the bytes [index*page_size; (index+1)*page_size[ of the file,
+    // zero-filled past its end. Returns 0 if it couldn't be read
+    uintptr_t page(size_t index);
+
+    // a page stays dirty once written : its mappings are writable from then on, so later writes go unnoticed
+    void mark_dirty(size_t index);
+    bool is_dirty(size_t index) const { return m_dirty.count(index); }
+
+    // writes the dirty pages among [first; first+count[ back to the file
+    [[nodiscard]] node::result<kpp::dummy_t> sync(size_t first, size_t count);
+
+    const std::shared_ptr<node>& file() const { return m_file; }
+
+public:
+    // the cache of 'file', shared with the current mappings of the same file
+    static std::shared_ptr<mapped_file> get(const std::shared_ptr<node>& file);
+
+private:
+    std::shared_ptr<node> m_file;
+    std::unordered_map<size_t, uintptr_t> m_pages;
+    std::unordered_set<size_t> m_dirty;
+};
+
+}
+
+#endif // MAPPED_FILE_HPP
@@ -50,7 +50,7 @@ vfs::node::result<size_t> vfs::pipe::read_impl(size_t, gsl::span<uint8_t> data)
 
     can_write_sem.post();
 
-    return {};
+    return data.size();
 }
 
 vfs::node::result<kpp::dummy_t> vfs::pipe::write_impl(size_t, gsl::span<const uint8_t> data)
@@ -65,7 +65,7 @@ vfs::node::result<kpp::dummy_t> vfs::pipe::write_impl(size_t, gsl::span<const ui
     }
 
     // at this point we should be allowed to push data into the buffer
-    assert(buffer.size() + data.size() < pipe_buf_size);
+    assert(buffer.size() + data.size() <= pipe_buf_size);
 
     for (size_t i { 0 }; i < data.size(); ++i)
         buffer.push_front(0);
@@ -46,11 +46,16 @@ public:
 public:
     pipe()
         : node(nullptr)
-    {}
+    {
+        m_type = FIFO;
+    }
 
     [[nodiscard]] virtual result<size_t> read_impl(size_t, gsl::span<uint8_t> data) const;
     [[nodiscard]] virtual result<kpp::dummy_t> write_impl(size_t, gsl::span<const uint8_t> data);
 
+    // bytes that can be read without blocking
+    size_t available() const { return buffer.size(); }
+
 public:
     static std::shared_ptr<pipe> open_fifo(const std::shared_ptr<node>& node);
 
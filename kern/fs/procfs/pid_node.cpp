@@ -28,6 +28,7 @@ SOFTWARE.
 #include "tasking/process.hpp"
 #include "tasking/process_data.hpp"
 #include "fs/utils/string_node.hpp"
+#include "time/time.hpp"
 
 namespace procfs
 {
@@ -50,6 +51,9 @@ std::vector<std::shared_ptr<vfs::node> > pid_node::readdir_impl()
         }
         return str;
     }));
+    children.emplace_back(std::make_shared<string_node> (this, "cputime", [this]{
+        return kpp::to_string((unsigned long)(Process::by_pid(m_pid)->cpu_ticks() / (Time::clock_speed()*1000))); // in ms
+    }));
 
     return children;
 }
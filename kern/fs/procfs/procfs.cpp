@@ -32,10 +32,15 @@ SOFTWARE.
 #include <sys/interface_list.h>
 
 #include "tasking/process.hpp"
+#include "tasking/scheduler.hpp"
 
 #include "pid_node.hpp"
 #include "fs/utils/string_node.hpp"
 #include "time/time.hpp"
+#include "utils/klog.hpp"
+#include "utils/user_ptr.hpp"
+#include "debug/profiler.hpp"
+#include "debug/bench.hpp"
 
 #include "info/cmdline.hpp"
 #include "info/version.hpp"
@@ -60,9 +65,15 @@ struct interface_test : public vfs::interface_node<interface_test, vfs::ientry<i
     void fill_interface(Interface*) const
     {}
 
-    int test_function(const char* str) const
+    int test_function(user_ptr<const char> str) const
     {
-        log_serial("Called! : %s\n", str);
+        auto string = str.str();
+        if (!string)
+        {
+            return -string.error();
+        }
+
+        log_serial("Called! : %s\n", string->c_str());
         return 42;
     }
 
@@ -89,8 +100,19 @@ public:
         }
 
         children.emplace_back(std::make_shared<string_node> (this, "cmdline", kernel_cmdline));
-        children.emplace_back(std::make_shared<string_node> (this, "uptime",  []{ return kpp::to_string(Time::uptime()); }));
+        children.emplace_back(std::make_shared<string_node> (this, "kmsg",    klog::dump));
+        children.emplace_back(std::make_shared<string_node> (this, "uptime",  []
+        {
+            const uint64_t us = Time::uptime_us();
+            char buf[32];
+            ksnprintf(buf, sizeof(buf), "%lu.%06lu", (unsigned long)(us / 1'000'000), (unsigned long)(us % 1'000'000));
+            return kpp::string(buf);
+        }));
+        children.emplace_back(std::make_shared<string_node> (this, "idletime",[]{ return kpp::to_string((unsigned long)(tasking::halted_ticks / (Time::clock_speed()*1000))); })); // in ms
         children.emplace_back(std::make_shared<string_node> (this, "version", get_version_str()));
+        children.emplace_back(std::make_shared<string_node> (this, "profile", profiler::flat_report));
+        children.emplace_back(std::make_shared<string_node> (this, "profile_folded", profiler::folded_report));
+        children.emplace_back(std::make_shared<string_node> (this, "bench", bench::report));
         children.emplace_back(std::make_shared<vfs::symlink>(this, kpp::to_string(Process::current().pid), "self"));
 
         children.emplace_back(std::make_shared<interface_test>(this, "interface_test"));
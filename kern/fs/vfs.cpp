@@ -62,7 +62,7 @@ void init()
             if (!ptr.expired()) ptr.lock()->~node(); // force unmounting of mounted nodes
         }
 
-        kmsgbus.send(SyncDisksCache{});
+        Disk::flush_all_caches();
     });
 
     log(Info, "VFS initialized.\n");
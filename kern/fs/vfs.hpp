@@ -163,6 +163,7 @@ struct node
     { (void)interface_id; return false; }
 
     // returns the sizeof of the interface type, or -1 otherwise
+    static constexpr size_t max_interface_size = 256;
     virtual int get_interface(int interface_id, void* interface) const
     { (void)interface_id, (void)interface; return -1; }
 
@@ -91,17 +91,14 @@ SOFTWARE.
 // TODO : BASIC interpreter
 // TODO : cache bu sec/count pair ?
 // TODO : process : free pages and alloc only at execute time
-// TODO : faire un 'profiler' qui toutes les t ms regarde la callstack et détermine les fonctions les plus appellées
 // TODO : passer tout ce qui est VBE en un driver qui expose le noeud 'fbdev'
 // TODO : restore ucontext_t* modified by signal handlers
-// TODO : optimized page copy function
 // TODO : mettre une page sentinelle après chaque stack de chaque processus
 // TODO : put a lock on the ext2fs for each access
 // TODO : only switch to the idle task if nothing is left to do
 // TODO : nanosleep must let signals pass through
 // TODO : check that the initial process stack conforms to the sys v abi spec
 // TODO : priority is currently ignored in scheduler, implement this
-// TODO : restore shm support
 
 // ROADMAP
 // : supprimer les floats dans le kernel
@@ -110,7 +107,6 @@ SOFTWARE.
 // : passer le shell et un max de trucs en userspace
 // : DWARF ?
 // : SVGA-II
-// : faire une boucle de traitement de callbacks d'interruption
 // : implémenter /dev/input
 // : implémenter expanding stack
 // : fix caching
@@ -196,7 +192,7 @@ void global_init()
 
     Mouse::init();
 
-    kmsgbus.register_handler<MouseScrollEvent>([](const MouseScrollEvent& e)
+    kmsgbus.subscribe<MouseScrollEvent>([](const MouseScrollEvent& e)
     {
         if (e.wheel>0)
         {
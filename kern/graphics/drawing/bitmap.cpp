@@ -24,6 +24,7 @@ SOFTWARE.
 */
 
 #include "bitmap.hpp"
+#include "pixel_ops.hpp"
 
 #include <assert.h>
 
@@ -81,29 +82,12 @@ Bitmap Bitmap::copy_rect(const PointU &pos, const PointU &size) const
 
 void Bitmap::color_multiply(const Color &color)
 {
-    for (size_t i { 0 }; i < width()*height(); ++i)
-    {
-        auto& pix = m_data[i];
-        pix.r = pix.r * color.r / 255;
-        pix.g = pix.g * color.g / 255;
-        pix.b = pix.b * color.b / 255;
-    }
+    pixel_kernels().multiply(data(), width()*height(), color);
 }
 
 void Bitmap::color_blend(const Color &white, const Color &transparent)
 {
-    for (size_t i { 0 }; i < width()*height(); ++i)
-    {
-        auto& pix = m_data[i];
-        if (pix == color_white)
-        {
-            pix = white;
-        }
-        else if (pix.a == 0)
-        {
-            pix = transparent;
-        }
-    }
+    pixel_kernels().color_key(data(), data(), width()*height(), white, &transparent);
 }
 
 void blit(Color* buf, size_t buf_width, size_t buf_height, const Bitmap &bitmap, const PointU &pos)
@@ -131,42 +115,38 @@ void blit(Color* buf, size_t buf_width, size_t buf_height, const Bitmap &bitmap,
 #endif
 }
 
-#pragma GCC push_options
-#pragma GCC optimize ("O3,tree-vectorize,omit-frame-pointer")
-#pragma GCC target ("sse2")
 void blit(Color* buf, size_t buf_width, size_t buf_height, const Bitmap &bitmap, const PointU &pos, const Color &white)
 {
-    (void)buf_height;
-    for (size_t j { 0 }; j < bitmap.height(); ++j)
-    {
-        const size_t y_off = (j + pos.y)*buf_width;
+    const size_t blit_width = std::min(bitmap.width(), buf_width - pos.x);
+    const size_t blit_height = std::min(bitmap.height(), buf_height - pos.y);
 
-        for (size_t i { 0 }; i < bitmap.width(); ++i)
-        {
-            const auto& bmp = bitmap[{i, j}];
-            if (bmp.a != 0) buf[y_off + i+pos.x] = (bmp == color_white ? white : bmp);
-        }
+    for (size_t j { 0 }; j < blit_height; ++j)
+    {
+        pixel_kernels().color_key(buf + (j+pos.y)*buf_width + pos.x, bitmap.data() + j*bitmap.width(), blit_width,
+                                  white, nullptr);
     }
 }
-#pragma GCC pop_options
 
-#pragma GCC push_options
-#pragma GCC optimize ("O3,tree-vectorize,omit-frame-pointer")
-#pragma GCC target ("sse2")
 void blit(Color* buf, size_t buf_width, size_t buf_height, const Bitmap &bitmap, const PointU &pos, const Color &white, const Color &transparent)
 {
-    (void)buf_height;
-    for (size_t j { 0 }; j < bitmap.height(); ++j)
+    const size_t blit_width = std::min(bitmap.width(), buf_width - pos.x);
+    const size_t blit_height = std::min(bitmap.height(), buf_height - pos.y);
+
+    for (size_t j { 0 }; j < blit_height; ++j)
     {
-        const size_t y_off = (j + pos.y)*buf_width;
+        pixel_kernels().color_key(buf + (j+pos.y)*buf_width + pos.x, bitmap.data() + j*bitmap.width(), blit_width,
+                                  white, &transparent);
+    }
+}
 
-        for (size_t i { 0 }; i < bitmap.width(); ++i)
-        {
-            const auto& bmp = bitmap[{i, j}];
-            buf[y_off + i+pos.x] = (bmp.a == 0 ? transparent :
-                                                    bmp == color_white ? white : bmp);
-        }
+void blend(Color* buf, size_t buf_width, size_t buf_height, const Bitmap &bitmap, const PointU &pos)
+{
+    const size_t blit_width = std::min(bitmap.width(), buf_width - pos.x);
+    const size_t blit_height = std::min(bitmap.height(), buf_height - pos.y);
+
+    for (size_t j { 0 }; j < blit_height; ++j)
+    {
+        pixel_kernels().blend(buf + (j+pos.y)*buf_width + pos.x, bitmap.data() + j*bitmap.width(), blit_width);
     }
 }
-#pragma GCC pop_options
 }
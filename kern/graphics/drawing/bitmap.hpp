@@ -80,6 +80,8 @@ private:
 void blit(Color* buffer, size_t buf_width, size_t buf_height, const Bitmap& bmp, const PointU& pos);
 void blit(Color* buffer, size_t buf_width, size_t buf_height, const Bitmap &bitmap, const PointU &pos, const Color& white);
 void blit(Color* buffer, size_t buf_width, size_t buf_height, const Bitmap &bitmap, const PointU &pos, const Color& white, const Color& transparent);
+// alpha blends a bitmap with premultiplied alpha
+void blend(Color* buffer, size_t buf_width, size_t buf_height, const Bitmap &bitmap, const PointU &pos);
 
 
 }
@@ -0,0 +1,81 @@
+/*
+damage.cpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "damage.hpp"
+
+namespace graphics
+{
+
+void DamageList::add(RectU rect)
+{
+    if (rect.empty())
+    {
+        return;
+    }
+
+    // merging can make the rect touch other ones, keep going until it is stable
+    bool merged;
+    do
+    {
+        merged = false;
+        for (size_t i { 0 }; i < m_count; ++i)
+        {
+            if (rect_touches(m_rects[i], rect))
+            {
+                rect = rect_union(m_rects[i], rect);
+                remove(i);
+                merged = true;
+                break;
+            }
+        }
+    } while (merged);
+
+    if (m_count == max_rects)
+    {
+        // no room left, merge with the rect which grows the least
+        size_t best = 0;
+        size_t best_growth = rect_union(m_rects[0], rect).area() - m_rects[0].area();
+        for (size_t i { 1 }; i < m_count; ++i)
+        {
+            const size_t growth = rect_union(m_rects[i], rect).area() - m_rects[i].area();
+            if (growth < best_growth)
+            {
+                best_growth = growth;
+                best = i;
+            }
+        }
+        rect = rect_union(m_rects[best], rect);
+        remove(best);
+    }
+
+    m_rects[m_count++] = rect;
+}
+
+void DamageList::remove(size_t index)
+{
+    m_rects[index] = m_rects[--m_count];
+}
+
+}
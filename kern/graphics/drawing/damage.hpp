@@ -0,0 +1,61 @@
+/*
+damage.hpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+#ifndef DAMAGE_HPP
+#define DAMAGE_HPP
+
+#include <stdint.h>
+
+#include "graphics/rect.hpp"
+
+namespace graphics
+{
+
+// Keeps track of the regions of a back buffer that changed since the last flush.
+// Touching rects are merged, so a line of glyphs or a block of lines ends up as a single rect
+class DamageList
+{
+public:
+    static constexpr size_t max_rects = 16;
+
+public:
+    void add(RectU rect);
+    void clear() { m_count = 0; }
+
+    bool empty() const { return m_count == 0; }
+
+    const RectU* begin() const { return m_rects; }
+    const RectU* end() const { return m_rects + m_count; }
+
+private:
+    void remove(size_t index);
+
+private:
+    RectU m_rects[max_rects];
+    size_t m_count { 0 };
+};
+
+}
+
+#endif // DAMAGE_HPP
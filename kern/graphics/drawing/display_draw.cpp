@@ -32,6 +32,10 @@ namespace graphics
 {
 
 extern void (*draw_to_display_callback)(const Screen& screen);
+extern void (*draw_rect_to_display_callback)(const Screen& screen, const RectU& rect);
+extern void (*fill_display_rect_callback)(const RectU& rect, Color color);
+
+size_t bytes_written { 0 };
 
 inline void set_pixel_field(uint32_t* src, uint32_t dst, int pos, int len)
 {
@@ -68,6 +72,60 @@ void draw_to_display_32rgb_nopad(const Screen &screen)
                    mode.width*mode.height*mode.depth/CHAR_BIT);
 }
 
+inline void set_display_pixel(size_t x, size_t y, Color color)
+{
+    const size_t offset = x * current_video_mode().depth/CHAR_BIT + y * current_video_mode().bytes_per_line;
+    uint32_t* pixel = reinterpret_cast<uint32_t*>(current_video_mode().virt_fb_addr + offset);
+    set_pixel_field(pixel, color.r, current_video_mode().red_field_pos, current_video_mode().red_mask_size);
+    set_pixel_field(pixel, color.g, current_video_mode().green_field_pos, current_video_mode().green_mask_size);
+    set_pixel_field(pixel, color.b, current_video_mode().blue_field_pos, current_video_mode().blue_mask_size);
+}
+
+void draw_rect_to_display_naive(const Screen &screen, const RectU& rect)
+{
+    for (size_t j { rect.y }; j < rect.bottom(); ++j)
+    {
+        for (size_t i { rect.x }; i < rect.right(); ++i)
+        {
+            set_display_pixel(i, j, screen[{i, j}]);
+        }
+    }
+}
+
+void fill_display_rect_naive(const RectU& rect, Color color)
+{
+    for (size_t j { rect.y }; j < rect.bottom(); ++j)
+    {
+        for (size_t i { rect.x }; i < rect.right(); ++i)
+        {
+            set_display_pixel(i, j, color);
+        }
+    }
+}
+
+// rows are written with non-temporal stores, the framebuffer is write-combined and never read back
+void draw_rect_to_display_32rgb(const Screen &screen, const RectU& rect)
+{
+    const auto mode = current_video_mode();
+
+    for (size_t j { rect.y }; j < rect.bottom(); ++j)
+    {
+        stream_memcpyl((void*)(mode.virt_fb_addr + j*mode.bytes_per_line + rect.x*sizeof(Color)),
+                       screen.data() + j*screen.width() + rect.x, rect.width*sizeof(Color));
+    }
+}
+
+void fill_display_rect_32rgb(const RectU& rect, Color color)
+{
+    const auto mode = current_video_mode();
+
+    for (size_t j { rect.y }; j < rect.bottom(); ++j)
+    {
+        memsetl((void*)(mode.virt_fb_addr + j*mode.bytes_per_line + rect.x*sizeof(Color)),
+                color.rgb(), rect.width*sizeof(Color));
+    }
+}
+
 void clear_display(Color color)
 {
 #if 0
@@ -87,10 +145,16 @@ void clear_display(Color color)
 
 void set_display_mode(const VideoMode &mode)
 {
+    draw_rect_to_display_callback = draw_rect_to_display_naive;
+    fill_display_rect_callback = fill_display_rect_naive;
+
     if (mode.depth == 32
             && mode.red_mask_size == 8 && mode.green_mask_size == 8 && mode.blue_mask_size == 8
             && mode.red_field_pos == 16 && mode.green_field_pos == 8 && mode.blue_field_pos == 0)
     {
+        draw_rect_to_display_callback = draw_rect_to_display_32rgb;
+        fill_display_rect_callback = fill_display_rect_32rgb;
+
         if (mode.bytes_per_line != mode.width*mode.depth/CHAR_BIT)
         {
             warn("There is padding for this video mode, not enabling fast 32rgb draw\n");
@@ -103,10 +167,57 @@ void set_display_mode(const VideoMode &mode)
 }
 
 void (*draw_to_display_callback)(const Screen& screen) = draw_to_display_naive;
+void (*draw_rect_to_display_callback)(const Screen& screen, const RectU& rect) = draw_rect_to_display_naive;
+void (*fill_display_rect_callback)(const RectU& rect, Color color) = fill_display_rect_naive;
 
 void draw_to_display(const Screen &scr)
 {
     draw_to_display_callback(scr);
+    bytes_written += current_video_mode().height*current_video_mode().bytes_per_line;
+}
+
+void draw_to_display(const Screen &scr, const RectU &rect)
+{
+    const auto clipped = rect_intersection(rect, RectU{0, 0, std::min<size_t>(scr.width(), current_video_mode().width),
+                                                             std::min<size_t>(scr.height(), current_video_mode().height)});
+    if (clipped.empty())
+    {
+        return;
+    }
+
+    draw_rect_to_display_callback(scr, clipped);
+    bytes_written += clipped.area()*current_video_mode().depth/CHAR_BIT;
+}
+
+void fill_display_rect(const RectU &rect, Color color)
+{
+    const auto clipped = rect_intersection(rect, RectU{0, 0, current_video_mode().width, current_video_mode().height});
+    if (clipped.empty())
+    {
+        return;
+    }
+
+    fill_display_rect_callback(clipped, color);
+    bytes_written += clipped.area()*current_video_mode().depth/CHAR_BIT;
+}
+
+// the rows are moved as raw bytes whatever the pixel format, this reads the framebuffer back
+void scroll_display_rows(size_t first_row, size_t last_row, size_t offset)
+{
+    const auto mode = current_video_mode();
+    last_row = std::min<size_t>(last_row, mode.height);
+
+    for (size_t y { first_row }; y + offset < last_row; ++y)
+    {
+        memcpy((void*)(mode.virt_fb_addr + y*mode.bytes_per_line),
+               (const void*)(mode.virt_fb_addr + (y + offset)*mode.bytes_per_line), mode.bytes_per_line);
+        bytes_written += mode.bytes_per_line;
+    }
+}
+
+size_t display_bytes_written()
+{
+    return bytes_written;
 }
 
 }
@@ -30,6 +30,7 @@ SOFTWARE.
 #include <vector.hpp>
 #include <optional.hpp>
 #include "graphics/video.hpp"
+#include "graphics/rect.hpp"
 #include "screen.hpp"
 
 namespace graphics
@@ -37,8 +38,16 @@ namespace graphics
 
 void set_display_mode(const VideoMode& mode);
 void draw_to_display(const Screen& scr);
+void draw_to_display(const Screen& scr, const RectU& rect);
+void fill_display_rect(const RectU& rect, Color color);
 void clear_display(Color color = 0);
 
+// moves the framebuffer rows [first_row + offset, last_row) up by 'offset' rows
+void scroll_display_rows(size_t first_row, size_t last_row, size_t offset);
+
+// bytes written to the framebuffer since boot
+size_t display_bytes_written();
+
 }
 
 #endif // FRAMEBUFFER_DRAW_HPP
@@ -24,6 +24,7 @@ SOFTWARE.
 */
 
 #include "image_loader.hpp"
+#include "pixel_ops.hpp"
 
 #define STB_IMAGE_IMPLEMENTATION
 #define STBI_MALLOC kmalloc
@@ -73,15 +74,7 @@ kpp::optional<Bitmap> load_image(const kpp::string &path)
     }
 
     Bitmap bmp(x, y);
-    memcpyl(bmp.data(), img, x*y*depth);
-
-    for (size_t i { 0 }; i < static_cast<size_t>(x); ++i)
-    {
-        for (size_t j { 0 }; j < static_cast<size_t>(y); ++j)
-        {
-            bmp[{i, j}] = Color(bmp[{i, j}].b, bmp[{i, j}].g, bmp[{i, j}].r, bmp[{i, j}].a);
-        }
-    }
+    pixel_kernels().rgba_to_color(bmp.data(), img, x*y);
 
     stbi_image_free(img);
 
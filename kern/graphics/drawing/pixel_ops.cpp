@@ -0,0 +1,264 @@
+/*
+pixel_ops.cpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "pixel_ops.hpp"
+
+#include <algorithm.hpp>
+
+#ifdef ARCH_i686
+#include "i686/simd/simd.hpp"
+#endif
+
+namespace graphics
+{
+
+namespace
+{
+
+inline uint32_t div255(uint32_t x)
+{
+    // exact x/255 for x <= 255*255
+    return (x + 1 + (x >> 8)) >> 8;
+}
+
+void fill_scalar(Color* dst, size_t count, Color color)
+{
+    for (size_t i { 0 }; i < count; ++i)
+    {
+        dst[i] = color;
+    }
+}
+
+void multiply_scalar(Color* dst, size_t count, Color color)
+{
+    for (size_t i { 0 }; i < count; ++i)
+    {
+        auto& pix = dst[i];
+        pix.r = div255(pix.r * color.r);
+        pix.g = div255(pix.g * color.g);
+        pix.b = div255(pix.b * color.b);
+    }
+}
+
+void blend_scalar(Color* dst, const Color* src, size_t count)
+{
+    for (size_t i { 0 }; i < count; ++i)
+    {
+        const auto s = src[i];
+        auto& d = dst[i];
+        const uint32_t inv = 255 - s.a;
+        d.r = std::min<uint32_t>(255, s.r + div255(d.r * inv));
+        d.g = std::min<uint32_t>(255, s.g + div255(d.g * inv));
+        d.b = std::min<uint32_t>(255, s.b + div255(d.b * inv));
+        d.a = std::min<uint32_t>(255, s.a + div255(d.a * inv));
+    }
+}
+
+void color_key_scalar(Color* dst, const Color* src, size_t count, Color white, const Color* transparent)
+{
+    for (size_t i { 0 }; i < count; ++i)
+    {
+        const auto s = src[i];
+        if (s.a == 0)
+        {
+            if (transparent) dst[i] = *transparent;
+        }
+        else
+        {
+            dst[i] = (s == color_white ? white : s);
+        }
+    }
+}
+
+void rgba_to_color_scalar(Color* dst, const uint8_t* src, size_t count)
+{
+    for (size_t i { 0 }; i < count; ++i)
+    {
+        dst[i] = Color(src[i*4], src[i*4+1], src[i*4+2], src[i*4+3]);
+    }
+}
+
+constexpr PixelKernels scalar_kernels
+{
+    "scalar", fill_scalar, multiply_scalar, blend_scalar, color_key_scalar, rgba_to_color_scalar
+};
+
+#ifdef ARCH_i686
+
+// GCC vector types are used instead of the intrinsics headers, which need a hosted malloc
+typedef uint32_t u32x4 __attribute__((vector_size(16)));
+typedef uint16_t u16x8 __attribute__((vector_size(16)));
+typedef uint8_t u8x16 __attribute__((vector_size(16)));
+typedef char v16qi __attribute__((vector_size(16)));
+typedef short v8hi __attribute__((vector_size(16)));
+typedef uint32_t u32x4_u __attribute__((vector_size(16), __may_alias__, aligned(1)));
+
+#pragma GCC push_options
+#pragma GCC target ("sse2")
+
+inline u32x4 load(const void* ptr) { return *reinterpret_cast<const u32x4_u*>(ptr); }
+inline void store(void* ptr, u32x4 val) { *reinterpret_cast<u32x4_u*>(ptr) = val; }
+
+inline u32x4 select(u32x4 mask, u32x4 a, u32x4 b) { return (mask & a) | (~mask & b); }
+
+inline u16x8 unpack_lo(u32x4 v) { return (u16x8)__builtin_ia32_punpcklbw128((v16qi)v, v16qi{}); }
+inline u16x8 unpack_hi(u32x4 v) { return (u16x8)__builtin_ia32_punpckhbw128((v16qi)v, v16qi{}); }
+inline u32x4 pack(u16x8 lo, u16x8 hi) { return (u32x4)__builtin_ia32_packuswb128((v8hi)lo, (v8hi)hi); }
+
+inline u16x8 div255(u16x8 x) { return (x + 1 + (x >> 8)) >> 8; }
+
+void fill_sse2(Color* dst, size_t count, Color color)
+{
+    const u32x4 pixels = u32x4{} + color.rgba();
+
+    size_t i { 0 };
+    for (; i + 4 <= count; i += 4)
+    {
+        store(dst + i, pixels);
+    }
+    fill_scalar(dst + i, count - i, color);
+}
+
+void multiply_sse2(Color* dst, size_t count, Color color)
+{
+    const u16x8 factor = {color.b, color.g, color.r, 255, color.b, color.g, color.r, 255};
+
+    size_t i { 0 };
+    for (; i + 4 <= count; i += 4)
+    {
+        const u32x4 pixels = load(dst + i);
+        store(dst + i, pack(div255(unpack_lo(pixels) * factor), div255(unpack_hi(pixels) * factor)));
+    }
+    multiply_scalar(dst + i, count - i, color);
+}
+
+inline u16x8 blend_half(u16x8 s, u16x8 d)
+{
+    const u16x8 alpha = __builtin_shuffle(s, u16x8{3, 3, 3, 3, 7, 7, 7, 7});
+    return s + div255(d * (255 - alpha));
+}
+
+void blend_sse2(Color* dst, const Color* src, size_t count)
+{
+    size_t i { 0 };
+    for (; i + 4 <= count; i += 4)
+    {
+        const u32x4 s = load(src + i);
+        const u32x4 d = load(dst + i);
+        store(dst + i, pack(blend_half(unpack_lo(s), unpack_lo(d)), blend_half(unpack_hi(s), unpack_hi(d))));
+    }
+    blend_scalar(dst + i, src + i, count - i);
+}
+
+void color_key_sse2(Color* dst, const Color* src, size_t count, Color white, const Color* transparent)
+{
+    const u32x4 white_key = u32x4{} + color_white.rgba();
+    const u32x4 white_pixels = u32x4{} + white.rgba();
+    const u32x4 transparent_pixels = u32x4{} + (transparent ? transparent->rgba() : 0);
+
+    size_t i { 0 };
+    for (; i + 4 <= count; i += 4)
+    {
+        const u32x4 s = load(src + i);
+        const u32x4 is_white = (u32x4)(s == white_key);
+        const u32x4 is_clear = (u32x4)((s >> 24) == 0);
+
+        const u32x4 back = transparent ? transparent_pixels : load(dst + i);
+        store(dst + i, select(is_clear, back, select(is_white, white_pixels, s)));
+    }
+    color_key_scalar(dst + i, src + i, count - i, white, transparent);
+}
+
+void rgba_to_color_sse2(Color* dst, const uint8_t* src, size_t count)
+{
+    size_t i { 0 };
+    for (; i + 4 <= count; i += 4)
+    {
+        const u32x4 x = load(src + i*4);
+        store(dst + i, (x & 0xFF00FF00) | ((x >> 16) & 0xFF) | ((x & 0xFF) << 16));
+    }
+    rgba_to_color_scalar(dst + i, src + i*4, count - i);
+}
+
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target ("ssse3")
+void rgba_to_color_ssse3(Color* dst, const uint8_t* src, size_t count)
+{
+    const u8x16 swap_rb = {2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15};
+
+    size_t i { 0 };
+    for (; i + 4 <= count; i += 4)
+    {
+        store(dst + i, (u32x4)__builtin_shuffle((u8x16)load(src + i*4), swap_rb));
+    }
+    rgba_to_color_scalar(dst + i, src + i*4, count - i);
+}
+#pragma GCC pop_options
+
+constexpr PixelKernels sse2_kernels
+{
+    "sse2", fill_sse2, multiply_sse2, blend_sse2, color_key_sse2, rgba_to_color_sse2
+};
+
+constexpr PixelKernels ssse3_kernels
+{
+    "ssse3", fill_sse2, multiply_sse2, blend_sse2, color_key_sse2, rgba_to_color_ssse3
+};
+
+#endif
+
+}
+
+const PixelKernels& pixel_kernels(uint16_t features)
+{
+#ifdef ARCH_i686
+    if ((features & SSE2) && (features & SSSE3))
+    {
+        return ssse3_kernels;
+    }
+    if (features & SSE2)
+    {
+        return sse2_kernels;
+    }
+#else
+    (void)features;
+#endif
+
+    return scalar_kernels;
+}
+
+const PixelKernels& pixel_kernels()
+{
+#ifdef ARCH_i686
+    static const PixelKernels& kernels = pixel_kernels(simd_features());
+#else
+    static const PixelKernels& kernels = pixel_kernels(0);
+#endif
+    return kernels;
+}
+
+}
@@ -0,0 +1,60 @@
+/*
+pixel_ops.hpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+#ifndef PIXEL_OPS_HPP
+#define PIXEL_OPS_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "graphics/color.hpp"
+
+namespace graphics
+{
+
+// Row kernels working on 'count' contiguous pixels
+struct PixelKernels
+{
+    const char* name;
+
+    void (*fill)(Color* dst, size_t count, Color color);
+    // multiplies the color channels by 'color'/255, alpha is kept
+    void (*multiply)(Color* dst, size_t count, Color color);
+    // dst = src + dst*(255 - src.a)/255, 'src' has premultiplied alpha
+    void (*blend)(Color* dst, const Color* src, size_t count);
+    // copies 'src' with white pixels replaced by 'white' ; fully transparent pixels are
+    // replaced by '*transparent', or leave 'dst' untouched if it is null. 'dst' may be 'src'
+    void (*color_key)(Color* dst, const Color* src, size_t count, Color white, const Color* transparent);
+    // converts RGBA bytes (stb_image's layout) to Color
+    void (*rgba_to_color)(Color* dst, const uint8_t* src, size_t count);
+};
+
+// best kernels for the current CPU
+const PixelKernels& pixel_kernels();
+// best kernels restricted to the given SIMDType features, used to compare the implementations
+const PixelKernels& pixel_kernels(uint16_t features);
+
+}
+
+#endif // PIXEL_OPS_HPP
@@ -25,35 +25,110 @@ SOFTWARE.
 
 #include "font.hpp"
 
+#include <limits.h>
+
+#include <algorithm.hpp>
+
+#ifdef ARCH_i686
+#include "i686/simd/simd.hpp"
+#endif
+
 namespace graphics
 {
 
-const Glyph &Font::get(char32_t c) const
+namespace
+{
+
+void draw_glyph_row(Color* dst, const uint8_t* bits, size_t first, size_t width, Color fg, const Color* bg)
+{
+    for (size_t i { first }; i < width; ++i)
+    {
+        if (bits[i / CHAR_BIT] & (0x80 >> (i % CHAR_BIT)))
+        {
+            dst[i] = fg;
+        }
+        else if (bg)
+        {
+            dst[i] = *bg;
+        }
+    }
+}
+
+typedef uint32_t pixel_vec __attribute__((vector_size(16)));
+typedef uint32_t pixel_vec_u __attribute__((vector_size(16), __may_alias__, aligned(1)));
+
+#pragma GCC push_options
+#pragma GCC target ("sse2")
+// Expands four pixels at a time : each lane tests its own bit of the row byte,
+// and the resulting mask selects between the foreground and the background (or the destination pixel)
+void draw_glyph_row_sse2(Color* dst, const uint8_t* bits, size_t width, Color fg, const Color* bg)
+{
+    const pixel_vec high_bits = {0x80, 0x40, 0x20, 0x10};
+    const pixel_vec low_bits  = {0x08, 0x04, 0x02, 0x01};
+    const pixel_vec fg_pixels = pixel_vec{} + fg.rgba();
+    const pixel_vec bg_pixels = pixel_vec{} + (bg ? bg->rgba() : 0);
+
+    size_t i { 0 };
+    for (; i + 4 <= width; i += 4)
+    {
+        const pixel_vec select = (i % CHAR_BIT) ? low_bits : high_bits;
+        const pixel_vec byte = pixel_vec{} + bits[i / CHAR_BIT];
+        const pixel_vec mask = (pixel_vec)((byte & select) == select);
+
+        const pixel_vec back = bg ? bg_pixels : *reinterpret_cast<const pixel_vec_u*>(dst + i);
+        *reinterpret_cast<pixel_vec_u*>(dst + i) = (mask & fg_pixels) | (~mask & back);
+    }
+
+    draw_glyph_row(dst, bits, i, width, fg, bg);
+}
+#pragma GCC pop_options
+
+void draw_glyph_impl(Color* buffer, size_t buf_width, size_t buf_height, const Font& font, char32_t c, const PointU& pos,
+                     Color fg, const Color* bg)
 {
-#if 1
-    if (c < m_font_cache.size() && m_font_cache[c])
+    if (pos.x >= buf_width || pos.y >= buf_height)
     {
-        return *m_font_cache[c];
+        return;
     }
-    else
+
+    const auto glyph = font.get(c);
+    const size_t width = std::min(font.glyph_width(), buf_width - pos.x);
+    const size_t height = std::min(font.glyph_height(), buf_height - pos.y);
+
+#ifdef ARCH_i686
+    static const bool has_sse2 = simd_features() & SSE2;
+#else
+    constexpr bool has_sse2 = false;
+#endif
+
+    for (size_t j { 0 }; j < height; ++j)
     {
-        if (c < m_font_cache.size())
+        Color* dst = buffer + (pos.y + j)*buf_width + pos.x;
+        const uint8_t* bits = glyph.rows + j*glyph.pitch;
+
+        if (has_sse2)
         {
-            m_font_cache[c] = std::make_unique<Glyph>(read_glyph(c));
-            return *m_font_cache[c];
+            draw_glyph_row_sse2(dst, bits, width, fg, bg);
         }
         else
         {
-            log_serial("Character 0x%x (%c) isn't in cache\n", c, c);
-            assert(false && "fix this");
-            static Glyph g = read_glyph(c);
-            return g;
+            draw_glyph_row(dst, bits, 0, width, fg, bg);
         }
     }
-#else
-    static Glyph g = read_glyph(c);
-    return g;
-#endif
+}
+
+}
+
+void draw_glyph(Color* buffer, size_t buf_width, size_t buf_height, const Font& font, char32_t c, const PointU& pos,
+                Color fg)
+{
+    draw_glyph_impl(buffer, buf_width, buf_height, font, c, pos, fg, nullptr);
+}
+
+void draw_glyph(Color* buffer, size_t buf_width, size_t buf_height, const Font& font, char32_t c, const PointU& pos,
+                Color fg, Color bg)
+{
+    draw_glyph_impl(buffer, buf_width, buf_height, font, c, pos, fg, &bg);
 }
 
 }
@@ -25,10 +25,10 @@ SOFTWARE.
 #ifndef FONT_HPP
 #define FONT_HPP
 
-#include "graphics/drawing/bitmap.hpp"
+#include <stdint.h>
 
-#include <vector.hpp>
-#include <memory.hpp>
+#include "graphics/color.hpp"
+#include "graphics/point.hpp"
 
 #include <kstring/kstrfwd.hpp>
 
@@ -37,41 +37,33 @@ SOFTWARE.
 namespace graphics
 {
 
-struct Glyph
+// 1 bit per pixel glyph, the leftmost pixel of a row is the most significant bit of its first byte
+struct GlyphBits
 {
-    Glyph(Bitmap&& bmp)
-        : bitmap(std::move(bmp))
-    {
-    }
-
-    Glyph(const Glyph& g) = delete;
-    Glyph(Glyph&& g) = default;
-
-    Bitmap bitmap;
+    const uint8_t* rows;
+    size_t pitch; // bytes per row
 };
 
 class Font
 {
 public:
-    Font()
-    {
-        m_font_cache.resize(0x10000);
-    }
+    virtual ~Font() = default;
 
     [[nodiscard]] virtual bool load(const kpp::string& path) = 0;
 
-    const Glyph& get(char32_t c) const;
+    virtual GlyphBits get(char32_t c) const = 0;
 
     virtual size_t glyph_width() const = 0;
     virtual size_t glyph_height() const = 0;
-
-private:
-    virtual Glyph read_glyph(char32_t c) const = 0;
-
-private:
-    mutable std::vector<std::unique_ptr<Glyph>> m_font_cache;
 };
 
+// draws the glyph set pixels with 'fg', leaving the others untouched
+void draw_glyph(Color* buffer, size_t buf_width, size_t buf_height, const Font& font, char32_t c, const PointU& pos,
+                Color fg);
+// draws the glyph set pixels with 'fg' and the other ones with 'bg'
+void draw_glyph(Color* buffer, size_t buf_width, size_t buf_height, const Font& font, char32_t c, const PointU& pos,
+                Color fg, Color bg);
+
 }
 
 #endif // FONT_HPP
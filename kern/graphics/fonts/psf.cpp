@@ -28,8 +28,6 @@ SOFTWARE.
 #include "fs/fsutils.hpp"
 #include "fs/vfs.hpp"
 
-#include "graphics/drawing/bitmap.hpp"
-#include "utils/bitops.hpp"
 #include "utils/memutils.hpp"
 
 #define PSF2_MAGIC0     0x72
@@ -82,6 +80,7 @@ bool PSFFont::load_psf()
     m_hdr = reinterpret_cast<const header*>(m_data.data());
     if (!PSF2_MAGIC_OK(m_hdr->magic) || m_hdr->version > PSF2_MAXVERSION) return false;
 
+    m_glyph_index.clear();
     if (m_hdr->flags & PSF2_HAS_UNICODE_TABLE)
     {
         build_unicode_table();
@@ -95,6 +94,8 @@ void PSFFont::build_unicode_table()
     const uint8_t* ptr = reinterpret_cast<const uint8_t*>(m_hdr)
             + m_hdr->headersize + m_hdr->length * m_hdr->charsize;
 
+    m_glyph_index.resize(0x10000, 0); // code points missing from the table use the first glyph
+
     char32_t glyph = 0;
     while(ptr < m_data.data() + m_data.size())
     {
@@ -135,54 +136,28 @@ void PSFFont::build_unicode_table()
             }
         }
         /* save translation */
-        m_unicode_jump_table[ch] = glyph;
+        if (ch < m_glyph_index.size() && glyph < m_hdr->length)
+        {
+            m_glyph_index[ch] = glyph;
+        }
         ptr++;
     }
 }
 
-Glyph PSFFont::read_glyph(char32_t c) const
+// The glyph bitmaps of a PSF2 file already form a contiguous 1 bpp atlas, they are used in place
+GlyphBits PSFFont::get(char32_t c) const
 {
     size_t glyph = c;
     if (m_hdr->flags & PSF2_HAS_UNICODE_TABLE)
     {
-        auto it = m_unicode_jump_table.find(c);
-        if (it != m_unicode_jump_table.end())
-        {
-            glyph = it->second;
-        }
-        else
-        {
-            return read_glyph_data(reinterpret_cast<const uint8_t*>(m_hdr) + m_hdr->headersize);
-        }
+        glyph = c < m_glyph_index.size() ? m_glyph_index[c] : 0;
     }
     if (glyph >= m_hdr->length)
     {
-        return read_glyph_data(reinterpret_cast<const uint8_t*>(m_hdr) + m_hdr->headersize);
-    }
-
-    return read_glyph_data(reinterpret_cast<const uint8_t*>(m_hdr) + m_hdr->headersize + m_hdr->charsize*glyph);
-}
-
-Glyph PSFFont::read_glyph_data(const uint8_t *ptr) const
-{
-    Bitmap bitmap(glyph_width(), glyph_height(), color_transparent);
-
-    size_t bytes_per_line = m_hdr->charsize/m_hdr->height;
-
-    for (size_t j { 0 }; j < glyph_height(); ++j)
-    {
-        for (size_t i = 0; i < glyph_width(); ++i)
-        {
-            size_t byte_index = i / CHAR_BIT;
-            size_t bit_offset = i % CHAR_BIT;
-
-            if (bit_check(ptr[j*bytes_per_line + byte_index], CHAR_BIT-1-bit_offset))
-            {
-                bitmap[{i, j}] = color_white;
-            }
-        }
+        glyph = 0;
     }
 
-    return Glyph{std::move(bitmap)};
+    return {reinterpret_cast<const uint8_t*>(m_hdr) + m_hdr->headersize + m_hdr->charsize*glyph,
+            m_hdr->charsize/m_hdr->height};
 }
 }
@@ -27,7 +27,7 @@ SOFTWARE.
 
 #include "font.hpp"
 
-#include <unordered_map.hpp>
+#include <vector.hpp>
 
 #include "utils/membuffer.hpp"
 
@@ -41,16 +41,14 @@ public:
 
     [[nodiscard]] virtual bool load(const kpp::string& path) override;
 
+    virtual GlyphBits get(char32_t c) const override;
+
     virtual size_t glyph_width() const override { return m_hdr->width; }
     virtual size_t glyph_height() const override{ return m_hdr->height; }
 
-private:
-    virtual Glyph read_glyph(char32_t c) const override;
-
 private:
     bool load_psf();
     void build_unicode_table();
-    Glyph read_glyph_data(const uint8_t* ptr) const;
 
 private:
     struct header
@@ -66,7 +64,8 @@ private:
     };
 
 private:
-    std::unordered_map<uint32_t, size_t> m_unicode_jump_table;
+    // glyph index of each BMP code point, empty if the font has no unicode table
+    std::vector<uint16_t> m_glyph_index;
     MemBuffer m_data;
     const header* m_hdr { nullptr };
 };
@@ -0,0 +1,83 @@
+/*
+rect.hpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+#ifndef RECT_HPP
+#define RECT_HPP
+
+#include <stdint.h>
+
+#include <algorithm.hpp>
+
+namespace graphics
+{
+
+template <typename T = size_t>
+struct Rect
+{
+    T x;
+    T y;
+    T width;
+    T height;
+
+    T right() const  { return x + width;  }
+    T bottom() const { return y + height; }
+    T area() const   { return width * height; }
+    bool empty() const { return width == 0 || height == 0; }
+};
+
+using RectU = Rect<size_t>;
+
+template <typename T>
+inline Rect<T> rect_union(const Rect<T>& lhs, const Rect<T>& rhs)
+{
+    const T x = std::min(lhs.x, rhs.x);
+    const T y = std::min(lhs.y, rhs.y);
+    return {x, y, std::max(lhs.right(), rhs.right()) - x, std::max(lhs.bottom(), rhs.bottom()) - y};
+}
+
+template <typename T>
+inline Rect<T> rect_intersection(const Rect<T>& lhs, const Rect<T>& rhs)
+{
+    const T x = std::max(lhs.x, rhs.x);
+    const T y = std::max(lhs.y, rhs.y);
+    const T right = std::min(lhs.right(), rhs.right());
+    const T bottom = std::min(lhs.bottom(), rhs.bottom());
+    if (right <= x || bottom <= y)
+    {
+        return {x, y, 0, 0};
+    }
+    return {x, y, right - x, bottom - y};
+}
+
+// true if the rects overlap or share an edge
+template <typename T>
+inline bool rect_touches(const Rect<T>& lhs, const Rect<T>& rhs)
+{
+    return lhs.x <= rhs.right() && rhs.x <= lhs.right() &&
+           lhs.y <= rhs.bottom() && rhs.y <= lhs.bottom();
+}
+
+}
+
+#endif // RECT_HPP
@@ -35,33 +35,23 @@ SOFTWARE.
 #include "graphics/fonts/psf.hpp"
 #include "utils/env.hpp"
 
-#define DIRECT_RENDER
-
-#ifdef DIRECT_RENDER
-#define FB_PTR() (Color*)current_video_mode().virt_fb_addr
-#else
-#define FB_PTR() m_scr.data()
-#endif
-
+// The terminal draws into the system memory Screen and records the damaged rects,
+// draw_impl() then copies only those to the framebuffer.
+// The cursor is an overlay drawn directly on the framebuffer, so blinking never touches the back buffer.
 
 namespace graphics
 {
 
-Color* buf_ptr;
-
 GraphicTerm::GraphicTerm(Screen &scr, TerminalData &data, const Font &font)
     : Terminal(scr.width() / font.glyph_width(), scr.height() / font.glyph_height(), data), m_scr(scr), m_font(font),
       m_glyph_height(font.glyph_height()), m_glyph_width(font.glyph_width())
 {
-    m_cursor_bitmap.resize(1, m_glyph_height, false, graphics::color_white);
-
     m_callback = Timer::register_callback(600, [this]
     {
         if (enabled())
         {
             m_show_cursor = !m_show_cursor;
             redraw_cursor();
-            draw_impl();
         }
     }, false);
 
@@ -70,12 +60,13 @@ GraphicTerm::GraphicTerm(Screen &scr, TerminalData &data, const Font &font)
 
     update_background();
 
+    // the back buffer may still hold the content of a previous terminal
+    clear_screen(term_data().color().bg);
+
     m_msg_handle = kmsgbus.register_handler<EnvVarChange>([this](const EnvVarChange& msg)
     {
         if (msg.key == "TERM_BCKG") update_background();
     });
-
-    buf_ptr = (Color*)current_video_mode().virt_fb_addr;
 }
 
 GraphicTerm::~GraphicTerm()
@@ -104,30 +95,33 @@ void GraphicTerm::set_wallpaper(const Bitmap &bitmap)
 
 void GraphicTerm::move_cursor(size_t x, size_t y)
 {
-    m_cursor_pos = {x*m_glyph_width, y*m_glyph_height};
+    const PointU pos { x*m_glyph_width, y*m_glyph_height };
+    if (pos.x != m_cursor_pos.x || pos.y != m_cursor_pos.y)
+    {
+        add_damage(cursor_rect()); // erase the cursor from its previous position on next flush
+        m_cursor_pos = pos;
+    }
 }
 
 void GraphicTerm::putchar(size_t x, size_t y, TermEntry entry)
 {
-    buf_ptr = FB_PTR();
-
-    const auto& bitmap = m_font.get(entry.c).bitmap;
-
     if (entry.pair.bg.rgb() != color_black.rgb())
     {
-       blit(buf_ptr, m_scr.width(), m_scr.height(), bitmap, {x*m_glyph_width, y*m_glyph_height},
-                   entry.pair.fg, entry.pair.bg);
+       draw_glyph(m_scr.data(), m_scr.width(), m_scr.height(), m_font, entry.c, {x*m_glyph_width, y*m_glyph_height},
+                  entry.pair.fg, entry.pair.bg);
     }
     else
     {
-       blit(buf_ptr, m_scr.width(), m_scr.height(), bitmap, {x*m_glyph_width, y*m_glyph_height},
-                   entry.pair.fg);
+       draw_glyph(m_scr.data(), m_scr.width(), m_scr.height(), m_font, entry.c, {x*m_glyph_width, y*m_glyph_height},
+                  entry.pair.fg);
     }
+
+    add_damage({x*m_glyph_width, y*m_glyph_height, m_glyph_width, m_glyph_height});
 }
 
 void GraphicTerm::clear_line(size_t y, Color color, size_t size)
 {
-    buf_ptr = FB_PTR();
+    Color* buf_ptr = m_scr.data();
 
     if (!m_background_path.empty() && color == term_data().color().bg)
     {
@@ -147,11 +141,13 @@ void GraphicTerm::clear_line(size_t y, Color color, size_t size)
                            (size*m_glyph_width)*sizeof(Color));
         }
     }
+
+    add_damage({0, y*m_glyph_height, size*m_glyph_width, m_glyph_height});
 }
 
 void GraphicTerm::clear_screen(Color color)
 {
-    buf_ptr = FB_PTR();
+    Color* buf_ptr = m_scr.data();
 
     if (!m_background_path.empty() && color == term_data().color().bg)
     {
@@ -164,15 +160,56 @@ void GraphicTerm::clear_screen(Color color)
         memsetl(buf_ptr,
                         color.rgba(), (m_scr.height()*m_scr.width())*sizeof(Color));
     }
+
+    add_damage({0, 0, m_scr.width(), m_scr.height()});
+}
+
+bool GraphicTerm::scroll_impl(size_t top, size_t lines)
+{
+    if (!m_background_path.empty() || top + lines >= true_height())
+    {
+        return false; // the wallpaper must stay in place, redraw the glyphs instead
+    }
+
+    const size_t first_pixel_row = top*m_glyph_height;
+    const size_t last_pixel_row = true_height()*m_glyph_height;
+    const size_t offset = lines*m_glyph_height;
+
+    // the framebuffer is scrolled along with the back buffer : it must match it beforehand, so the pending
+    // damage is flushed and the cursor overlay erased, otherwise they would be moved with the rows
+    for (const auto& rect : m_damage)
+    {
+        draw_to_display(m_scr, rect);
+    }
+    m_damage.clear();
+    draw_to_display(m_scr, cursor_rect());
+
+    // source and destination rows never overlap, rows can be copied one by one
+    for (size_t y { first_pixel_row }; y + offset < last_pixel_row; ++y)
+    {
+        memcpyl(m_scr.data() + y*m_scr.width(), m_scr.data() + (y + offset)*m_scr.width(),
+                m_scr.width()*sizeof(Color));
+    }
+    scroll_display_rows(first_pixel_row, last_pixel_row, offset);
+
+    // only the rows exposed at the bottom differ from the display now
+    add_damage({0, last_pixel_row - offset, m_scr.width(), offset});
+
+    return true;
 }
 
 void GraphicTerm::draw_impl()
 {
-    redraw_cursor();
+    for (const auto& rect : m_damage)
+    {
+        draw_to_display(m_scr, rect);
+    }
+    m_damage.clear();
 
-#ifndef DIRECT_RENDER
-    graphics::draw_to_display(m_scr);
-#endif
+    if (m_show_cursor)
+    {
+        redraw_cursor();
+    }
 }
 
 void GraphicTerm::disable_impl()
@@ -180,21 +217,30 @@ void GraphicTerm::disable_impl()
 
 }
 
+// called from the cursor timer callback too, must not touch the damage list
 void GraphicTerm::redraw_cursor()
 {
-    buf_ptr = FB_PTR();
-
     if (m_show_cursor)
     {
-        blit(buf_ptr, m_scr.width(), m_scr.height(), m_cursor_bitmap, m_cursor_pos, term_data().color().fg);
+        fill_display_rect(cursor_rect(), term_data().color().fg);
     }
     else
     {
-        auto bckg_bitmap = m_background.copy_rect(m_cursor_pos, {m_cursor_bitmap.width(), m_cursor_bitmap.height()});
-        blit(buf_ptr, m_scr.width(), m_scr.height(), bckg_bitmap, m_cursor_pos);
+        draw_to_display(m_scr, cursor_rect());
     }
 }
 
+void GraphicTerm::add_damage(const RectU &rect)
+{
+    m_damage.add(rect);
+    m_dirty = true;
+}
+
+RectU GraphicTerm::cursor_rect() const
+{
+    return {m_cursor_pos.x, m_cursor_pos.y, 1, m_glyph_height};
+}
+
 void GraphicTerm::update_background()
 {
     auto bckg = kgetenv("TERM_BCKG");
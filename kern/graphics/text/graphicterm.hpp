@@ -34,6 +34,7 @@ SOFTWARE.
 #include "graphics/fonts/font.hpp"
 #include "graphics/drawing/screen.hpp"
 #include "graphics/drawing/bitmap.hpp"
+#include "graphics/drawing/damage.hpp"
 
 #include "time/timer.hpp"
 
@@ -57,6 +58,7 @@ private:
     virtual void putchar(size_t x, size_t y, TermEntry entry) override;
     virtual void clear_line(size_t y, Color color, size_t size) override;
     virtual void clear_screen(graphics::Color color) override;
+    virtual bool scroll_impl(size_t top, size_t lines) override;
     virtual void draw_impl() override;
     virtual void disable_impl() override;
 
@@ -64,6 +66,8 @@ private:
     void redraw_cursor();
     void update_background();
     void set_wallpaper(const Bitmap& bitmap);
+    void add_damage(const RectU& rect);
+    RectU cursor_rect() const;
 
 private:
     Screen& m_scr;
@@ -73,12 +77,11 @@ private:
 
     volatile bool m_show_cursor { false };
     PointU m_cursor_pos { 0, 0 };
-    Bitmap m_cursor_bitmap;
+    DamageList m_damage;
     Bitmap m_background;
     kpp::string m_background_path;
     Timer::CallbackHandle m_callback;
     MessageBus::RAIIHandle m_msg_handle;
-    std::vector<size_t> m_dirty_offset_per_line;
 };
 
 }
@@ -29,26 +29,35 @@ SOFTWARE.
 #include "time/timer.hpp"
 #include "time/time.hpp"
 
-// in Mhz
-inline uint64_t clock_speed(bool recompute = false)
+// in kHz, measured against the timer
+inline uint64_t tsc_khz(bool recompute = false)
 {
-    static uint64_t speed;
+    static uint64_t khz;
     static bool computed = false;
     if (computed && !recompute)
     {
-        return speed;
+        return khz;
     }
 
     const uint32_t step { 10 };
 
-    uint64_t current = Time::total_ticks();
     uint32_t ticks = Timer::ticks();
-    while (ticks + step > Timer::ticks()) { nop(); } // wait 'til a tick is elapsed
+    while (ticks == Timer::ticks()) { nop(); } // start on a tick edge
+    ticks = Timer::ticks();
+
+    uint64_t current = Time::total_ticks();
+    while (ticks + step > Timer::ticks()) { nop(); } // wait 'til the ticks are elapsed
 
     uint64_t elapsed = Time::total_ticks() - current;
-    speed = elapsed*Timer::freq()/1'000'000/step;
+    khz = elapsed*Timer::freq()/1'000/step;
     computed = true;
-    return speed; // MHz
+    return khz;
+}
+
+// in Mhz
+inline uint64_t clock_speed(bool recompute = false)
+{
+    return tsc_khz(recompute) / 1000;
 }
 
 #endif // CPUINFO_HPP
@@ -0,0 +1,64 @@
+/*
+idle.cpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "idle.hpp"
+
+#include <stdint.h>
+
+#include "cpuid.hpp"
+
+namespace
+{
+// cache line watched by MONITOR ; only interrupts wake the cpu up, nothing writes it
+alignas(64) volatile uint32_t monitor_line;
+
+bool detect_mwait()
+{
+    uint32_t eax, ebx, ecx, edx;
+    cpuid(1, eax, ebx, ecx, edx);
+
+    return ecx & (1<<3); // MONITOR/MWAIT
+}
+}
+
+bool cpu_idle_uses_mwait()
+{
+    static const bool has_mwait = detect_mwait();
+    return has_mwait;
+}
+
+void cpu_idle()
+{
+    if (cpu_idle_uses_mwait())
+    {
+        asm volatile ("monitor" :: "a"(&monitor_line), "c"(0), "d"(0));
+        // the sti shadow covers mwait, an interrupt can't slip in between
+        asm volatile ("sti; mwait" :: "a"(0), "c"(0));
+    }
+    else
+    {
+        asm volatile ("sti; hlt");
+    }
+}
@@ -0,0 +1,472 @@
+/*
+memops.cpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+#include "memops.hpp"
+
+#include <string.h>
+
+#include <vector.hpp>
+#include <memory.hpp>
+#include <kstring/kstring.hpp>
+
+#include "cpuid.hpp"
+#include "i686/simd/simd.hpp"
+#include "debug/bench.hpp"
+#include "utils/align.hpp"
+#include "utils/logging.hpp"
+
+namespace memops
+{
+
+namespace
+{
+
+using copy_fn      = void*(*)(void*, const void*, size_t);
+using set_fn       = void*(*)(void*, uint8_t, size_t);
+using setl_fn      = void*(*)(void*, uint32_t, size_t);
+using copy_page_fn = void (*)(void*, const void*);
+using zero_page_fn = void (*)(void*);
+
+template <typename Fn>
+struct Variant
+{
+    const char* name;
+    Fn fn;
+    uint8_t required; // features needed to run it at all
+    size_t align;     // of the source and the destination
+    size_t granule;   // sizes must be multiples of it
+};
+
+const Variant<copy_fn> copy_variants[] =
+{
+    {"naive",        _naive_memcpy,        0,    1,  1},
+    {"movsb",        _repmovsb_memcpy,     0,    1,  1},
+    {"movsl",        _movsl_memcpy,        0,    1,  1},
+    {"erms",         _erms_memcpy,         0,    1,  1},
+    {"dwords",       _repmovsl_memcpy,     0,    1,  4},
+    {"mmx",          _memcpy_mmx,          MMX,  1,  1},
+    {"sse2",         _memcpy_sse2,         SSE2, 1,  1},
+    {"sse2_aligned", _aligned_memcpy_sse2, SSE2, 16, 1},
+    {"sse2_stream",  _stream_memcpyl_sse2, SSE2, 4,  4},
+    {"memmove",      memmove,              0,    1,  1},
+};
+
+const Variant<set_fn> set_variants[] =
+{
+    {"naive", _naive_memset,    0,    1, 1},
+    {"stosb", _repmovsb_memset, 0,    1, 1},
+    {"stosl", _stosl_memset,    0,    1, 1},
+    {"sse2",  _memset_sse2,     SSE2, 1, 1},
+};
+
+const Variant<setl_fn> setl_variants[] =
+{
+    {"stosl",        memsetl,               0,    1,  4},
+    {"sse2_aligned", _aligned_memsetl_sse2, SSE2, 16, 4},
+};
+
+const Variant<copy_page_fn> copy_page_variants[] =
+{
+    {"movsl", _copy_page_movsl, 0,    16, 1},
+    {"erms",  _copy_page_erms,  0,    16, 1},
+    {"sse2",  _copy_page_sse2,  SSE2, 16, 1},
+};
+
+const Variant<zero_page_fn> zero_page_variants[] =
+{
+    {"stosl", _zero_page_stosl, 0,    16, 1},
+    {"erms",  _zero_page_erms,  0,    16, 1},
+    {"sse2",  _zero_page_sse2,  SSE2, 16, 1},
+};
+
+constexpr size_t page_bytes = 0x1000;
+
+// the sizes around the loop boundaries of the variants, up to their non-temporal paths
+constexpr size_t test_sizes[] =
+{
+    0, 1, 2, 3, 4, 5, 7, 8, 15, 16, 17, 31, 32, 33, 63, 64, 65, 127, 128, 129, 255, 256, 257,
+    1000, 4095, 4096, 4097, 8205, NON_TEMPORAL_THRESHOLD + 64, NON_TEMPORAL_THRESHOLD + 37
+};
+constexpr size_t test_offsets[] = {0, 1, 3, 4, 8, 15};
+constexpr size_t offset_count = sizeof(test_offsets)/sizeof(*test_offsets);
+// the large sizes are only checked with the first offsets, to keep the test short
+constexpr size_t large_size = 0x1000;
+constexpr size_t large_offsets = 2;
+
+constexpr size_t guard = 64;
+constexpr uint8_t guard_byte = 0xCC;
+constexpr size_t test_span = NON_TEMPORAL_THRESHOLD + 0x1000;
+
+// page-aligned heap memory
+struct Scratch
+{
+    explicit Scratch(size_t size)
+        : storage(size + page_bytes)
+    {}
+
+    uint8_t* data() { return aligned(storage.data(), page_bytes); }
+
+    std::vector<uint8_t> storage;
+};
+
+template <typename Fn>
+bool available(const Variant<Fn>& v)
+{
+    return (features() & v.required) == v.required;
+}
+
+template <typename Fn>
+bool fail(const char* function, const Variant<Fn>& v, size_t size, size_t src_off, size_t dst_off)
+{
+    warn("memops : %s_%s is wrong for %d bytes at source+%d, destination+%d\n",
+         function, v.name, size, src_off, dst_off);
+    return false;
+}
+
+bool check_copy(const Variant<copy_fn>& v, uint8_t* src, uint8_t* dst, uint8_t* ref)
+{
+    for (size_t size : test_sizes)
+    {
+        if (size % v.granule) continue;
+
+        const size_t offsets = size >= large_size ? large_offsets : offset_count;
+        for (size_t i { 0 }; i < offsets; ++i)
+        {
+            for (size_t j { 0 }; j < offsets; ++j)
+            {
+                const size_t src_off = test_offsets[i];
+                const size_t dst_off = test_offsets[j];
+                if (src_off % v.align || dst_off % v.align) continue;
+
+                const size_t span = guard + dst_off + size + guard;
+                _naive_memset(dst, guard_byte, span);
+                _naive_memset(ref, guard_byte, span);
+                _naive_memcpy(ref + guard + dst_off, src + src_off, size);
+
+                void* result = v.fn(dst + guard + dst_off, src + src_off, size);
+                if (result != dst + guard + dst_off || memcmp(dst, ref, span) != 0)
+                {
+                    return fail("memcpy", v, size, src_off, dst_off);
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+// memmove also has to handle overlapping buffers in both directions
+bool check_overlap(uint8_t* buf, uint8_t* ref)
+{
+    constexpr size_t base = 0x100;
+    constexpr int max_delta = 40;
+
+    for (size_t size { 0 }; size < 300; size += 7)
+    {
+        for (int delta { -max_delta }; delta <= max_delta; ++delta)
+        {
+            const size_t span = base + size + max_delta;
+            for (size_t i { 0 }; i < span; ++i)
+            {
+                buf[i] = ref[i] = i*7 + 13;
+            }
+
+            _naive_memcpy(ref + page_bytes, ref + base, size);
+            _naive_memcpy(ref + base + delta, ref + page_bytes, size);
+
+            memmove(buf + base + delta, buf + base, size);
+            if (memcmp(buf, ref, span) != 0)
+            {
+                warn("memops : memmove is wrong for %d overlapping bytes moved by %d\n", size, delta);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+template <typename Fn, typename Value, typename Reference>
+bool check_set(const char* function, const Variant<Fn>& v, Value value, uint8_t* dst, uint8_t* ref, Reference&& reference)
+{
+    for (size_t size : test_sizes)
+    {
+        if (size % v.granule) continue;
+
+        const size_t offsets = size >= large_size ? large_offsets : offset_count;
+        for (size_t i { 0 }; i < offsets; ++i)
+        {
+            const size_t dst_off = test_offsets[i];
+            if (dst_off % v.align) continue;
+
+            const size_t span = guard + dst_off + size + guard;
+            _naive_memset(dst, guard_byte, span);
+            _naive_memset(ref, guard_byte, span);
+            reference(ref + guard + dst_off, size);
+
+            void* result = v.fn(dst + guard + dst_off, value, size);
+            if (result != dst + guard + dst_off || memcmp(dst, ref, span) != 0)
+            {
+                return fail(function, v, size, 0, dst_off);
+            }
+        }
+    }
+
+    return true;
+}
+
+// the page is between two guard pages, which must be left untouched. 'expected' is null for a zeroed page
+bool check_page(const uint8_t* buf, const uint8_t* expected)
+{
+    for (size_t i { 0 }; i < page_bytes; ++i)
+    {
+        if (buf[i] != guard_byte || buf[2*page_bytes + i] != guard_byte ||
+                buf[page_bytes + i] != (expected ? expected[i] : 0))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+}
+
+uint8_t features()
+{
+    uint32_t max_leaf, eax, ebx, ecx, edx, unused;
+    cpuid(0, max_leaf, unused, unused, unused);
+    cpuid(1, unused, unused, ecx, edx);
+
+    uint8_t result = 0;
+    if (edx & (1<<23)) result |= MMX;
+    if (simd_features() & SSE2) result |= SSE2;
+
+    if (max_leaf >= 7)
+    {
+        __cpuid_count(7, 0, eax, ebx, ecx, edx);
+        if (ebx & (1<<9)) result |= ERMS;
+        if (edx & (1<<4)) result |= FSRM;
+    }
+
+    return result;
+}
+
+void select()
+{
+    const uint8_t feats = features();
+
+    // memcpy, memset and the page functions also run in IRQ, softirq and page fault context where the FPU state
+    // isn't saved : they stay on the integer string instructions, the SSE variants are only behind the explicit
+    // aligned_* and stream_* calls
+    const char* memcpy_name = "movsl";
+    if (feats & FSRM)
+    {
+        memcpy = _repmovsb_memcpy;
+        memcpy_name = "movsb";
+    }
+    else if (feats & ERMS)
+    {
+        memcpy = _erms_memcpy;
+        memcpy_name = "erms";
+    }
+    else
+    {
+        memcpy = _movsl_memcpy;
+    }
+
+    const char* memset_name = "stosl";
+    if (feats & ERMS)
+    {
+        memset = _repmovsb_memset;
+        memset_name = "stosb";
+    }
+
+    const char* page_name = "movsl";
+    if (feats & ERMS)
+    {
+        copy_page = _copy_page_erms;
+        zero_page = _zero_page_erms;
+        page_name = "erms";
+    }
+
+    if (feats & MMX)
+    {
+        aligned_memcpy = _memcpy_mmx;
+    }
+    if (feats & SSE2)
+    {
+        aligned_memcpy = _aligned_memcpy_sse2;
+        stream_memcpyl = _stream_memcpyl_sse2;
+        aligned_memsetl = _aligned_memsetl_sse2;
+        aligned_double_memsetl = _aligned_double_memsetl_sse2;
+    }
+
+    log(Debug, "memops : memcpy '%s', memset '%s', copy_page/zero_page '%s'\n", memcpy_name, memset_name, page_name);
+}
+
+size_t self_test()
+{
+    Scratch src_buf(test_span), dst_buf(test_span), ref_buf(test_span);
+    uint8_t* src = src_buf.data();
+    uint8_t* dst = dst_buf.data();
+    uint8_t* ref = ref_buf.data();
+
+    for (size_t i { 0 }; i < test_span; ++i)
+    {
+        src[i] = i*7 + 13;
+    }
+
+    size_t failures = 0;
+
+    for (const auto& v : copy_variants)
+    {
+        if (available(v) && !check_copy(v, src, dst, ref)) ++failures;
+    }
+    if (!check_overlap(dst, ref)) ++failures;
+
+    for (const auto& v : set_variants)
+    {
+        if (available(v) && !check_set("memset", v, (uint8_t)0x5A, dst, ref, [](uint8_t* ptr, size_t size)
+        {
+            _naive_memset(ptr, 0x5A, size);
+        })) ++failures;
+    }
+
+    for (const auto& v : setl_variants)
+    {
+        if (available(v) && !check_set("memsetl", v, (uint32_t)0x11223344, dst, ref, [](uint8_t* ptr, size_t size)
+        {
+            for (size_t i { 0 }; i < size/sizeof(uint32_t); ++i)
+            {
+                reinterpret_cast<uint32_t*>(ptr)[i] = 0x11223344;
+            }
+        })) ++failures;
+    }
+
+    for (const auto& v : copy_page_variants)
+    {
+        if (!available(v)) continue;
+
+        _naive_memset(dst, guard_byte, 3*page_bytes);
+        v.fn(dst + page_bytes, src);
+        if (!check_page(dst, src))
+        {
+            fail("copy_page", v, page_bytes, 0, 0);
+            ++failures;
+        }
+    }
+
+    for (const auto& v : zero_page_variants)
+    {
+        if (!available(v)) continue;
+
+        _naive_memset(dst, guard_byte, 3*page_bytes);
+        v.fn(dst + page_bytes);
+        if (!check_page(dst, nullptr))
+        {
+            fail("zero_page", v, page_bytes, 0, 0);
+            ++failures;
+        }
+    }
+
+    return failures;
+}
+
+namespace
+{
+
+constexpr size_t bench_sizes[] = {64, 0x1000, 0x10000};
+constexpr const char* bench_size_names[] = {"64", "4k", "64k"};
+
+std::unique_ptr<Scratch> bench_src;
+std::unique_ptr<Scratch> bench_dst;
+
+bool bench_setup()
+{
+    bench_src = std::make_unique<Scratch>(bench_sizes[2]);
+    bench_dst = std::make_unique<Scratch>(bench_sizes[2]);
+    _naive_memset(bench_src->data(), 0x5A, bench_sizes[2]);
+    return true;
+}
+
+void bench_teardown()
+{
+    bench_src.reset();
+    bench_dst.reset();
+}
+
+template <typename Fn, typename Call>
+void register_variant(const char* function, const Variant<Fn>& v, size_t size, const char* size_name, Call call)
+{
+    if (!available(v) || size % v.granule) return;
+
+    kpp::string name = kpp::string(function) + "_" + v.name;
+    if (size_name) name += kpp::string("_") + size_name;
+
+    bench::register_case({name, bench_setup, [fn = v.fn, size, call]
+    {
+        return bench::measure([fn, size, call]{ call(fn, bench_dst->data(), bench_src->data(), size); });
+    }, bench_teardown});
+}
+
+}
+
+void register_bench_cases()
+{
+    for (size_t i { 0 }; i < sizeof(bench_sizes)/sizeof(*bench_sizes); ++i)
+    {
+        for (const auto& v : copy_variants)
+        {
+            register_variant("memcpy", v, bench_sizes[i], bench_size_names[i], [](copy_fn fn, uint8_t* dst, const uint8_t* src, size_t size)
+            {
+                fn(dst, src, size);
+            });
+        }
+        for (const auto& v : set_variants)
+        {
+            register_variant("memset", v, bench_sizes[i], bench_size_names[i], [](set_fn fn, uint8_t* dst, const uint8_t*, size_t size)
+            {
+                fn(dst, 0, size);
+            });
+        }
+    }
+
+    for (const auto& v : copy_page_variants)
+    {
+        register_variant("copy_page", v, page_bytes, nullptr, [](copy_page_fn fn, uint8_t* dst, const uint8_t* src, size_t)
+        {
+            fn(dst, src);
+        });
+    }
+    for (const auto& v : zero_page_variants)
+    {
+        register_variant("zero_page", v, page_bytes, nullptr, [](zero_page_fn fn, uint8_t* dst, const uint8_t*, size_t)
+        {
+            fn(dst);
+        });
+    }
+}
+
+}
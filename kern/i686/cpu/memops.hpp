@@ -0,0 +1,58 @@
+/*
+memops.hpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+#ifndef MEMOPS_HPP
+#define MEMOPS_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Selection of the memcpy/memset/copy_page family variants for the running CPU
+namespace memops
+{
+
+enum Feature : uint8_t
+{
+    MMX  = 1<<0,
+    SSE2 = 1<<1,
+    ERMS = 1<<2, // enhanced 'rep movsb/stosb'
+    FSRM = 1<<3  // fast short 'rep movsb'
+};
+
+uint8_t features();
+
+// points memcpy, memset, copy_page & co to the fastest variants for this CPU, SSE must be enabled.
+// The SSE variants are only used for aligned_* and stream_*, the others may run where the FPU state isn't saved
+void select();
+
+// checks every variant this CPU can run against the naive implementations, across sizes and alignments.
+// Returns the number of variants that failed, the failures are logged
+size_t self_test();
+
+// benchmarks of each variant at a few sizes, named after the function and the variant (e.g. 'memcpy_sse2_4k')
+void register_bench_cases();
+
+}
+
+#endif // MEMOPS_HPP
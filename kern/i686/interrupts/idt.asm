@@ -95,6 +95,40 @@ IRQ  12,    44
 IRQ  13,    45
 IRQ  14,    46
 IRQ  15,    47
+IRQ  16,    48 ; local APIC timer
+; vectors handed out at runtime, to MSI interrupts
+IRQ  17,    49
+IRQ  18,    50
+IRQ  19,    51
+IRQ  20,    52
+IRQ  21,    53
+IRQ  22,    54
+IRQ  23,    55
+IRQ  24,    56
+IRQ  25,    57
+IRQ  26,    58
+IRQ  27,    59
+IRQ  28,    60
+IRQ  29,    61
+IRQ  30,    62
+IRQ  31,    63
+IRQ  32,    64
+IRQ  33,    65
+IRQ  34,    66
+IRQ  35,    67
+IRQ  36,    68
+IRQ  37,    69
+IRQ  38,    70
+IRQ  39,    71
+IRQ  40,    72
+IRQ  41,    73
+IRQ  42,    74
+IRQ  43,    75
+IRQ  44,    76
+IRQ  45,    77
+IRQ  46,    78
+IRQ  47,    79
+ISR_NOERRCODE 255 ; local APIC spurious interrupt
 
 ISR_SYSCALL ludos, 0x70 ; ludos_syscall
 ISR_SYSCALL linux, 0x80 ; linux_syscall
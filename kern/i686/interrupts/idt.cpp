@@ -110,6 +110,39 @@ void init()
     set_gate(45, reinterpret_cast<uint32_t>(irq13), 0x08, 0x8E);
     set_gate(46, reinterpret_cast<uint32_t>(irq14), 0x08, 0x8E);
     set_gate(47, reinterpret_cast<uint32_t>(irq15), 0x08, 0x8E);
+    set_gate(48, reinterpret_cast<uint32_t>(irq16), 0x08, 0x8E);
+    set_gate(49, reinterpret_cast<uint32_t>(irq17), 0x08, 0x8E);
+    set_gate(50, reinterpret_cast<uint32_t>(irq18), 0x08, 0x8E);
+    set_gate(51, reinterpret_cast<uint32_t>(irq19), 0x08, 0x8E);
+    set_gate(52, reinterpret_cast<uint32_t>(irq20), 0x08, 0x8E);
+    set_gate(53, reinterpret_cast<uint32_t>(irq21), 0x08, 0x8E);
+    set_gate(54, reinterpret_cast<uint32_t>(irq22), 0x08, 0x8E);
+    set_gate(55, reinterpret_cast<uint32_t>(irq23), 0x08, 0x8E);
+    set_gate(56, reinterpret_cast<uint32_t>(irq24), 0x08, 0x8E);
+    set_gate(57, reinterpret_cast<uint32_t>(irq25), 0x08, 0x8E);
+    set_gate(58, reinterpret_cast<uint32_t>(irq26), 0x08, 0x8E);
+    set_gate(59, reinterpret_cast<uint32_t>(irq27), 0x08, 0x8E);
+    set_gate(60, reinterpret_cast<uint32_t>(irq28), 0x08, 0x8E);
+    set_gate(61, reinterpret_cast<uint32_t>(irq29), 0x08, 0x8E);
+    set_gate(62, reinterpret_cast<uint32_t>(irq30), 0x08, 0x8E);
+    set_gate(63, reinterpret_cast<uint32_t>(irq31), 0x08, 0x8E);
+    set_gate(64, reinterpret_cast<uint32_t>(irq32), 0x08, 0x8E);
+    set_gate(65, reinterpret_cast<uint32_t>(irq33), 0x08, 0x8E);
+    set_gate(66, reinterpret_cast<uint32_t>(irq34), 0x08, 0x8E);
+    set_gate(67, reinterpret_cast<uint32_t>(irq35), 0x08, 0x8E);
+    set_gate(68, reinterpret_cast<uint32_t>(irq36), 0x08, 0x8E);
+    set_gate(69, reinterpret_cast<uint32_t>(irq37), 0x08, 0x8E);
+    set_gate(70, reinterpret_cast<uint32_t>(irq38), 0x08, 0x8E);
+    set_gate(71, reinterpret_cast<uint32_t>(irq39), 0x08, 0x8E);
+    set_gate(72, reinterpret_cast<uint32_t>(irq40), 0x08, 0x8E);
+    set_gate(73, reinterpret_cast<uint32_t>(irq41), 0x08, 0x8E);
+    set_gate(74, reinterpret_cast<uint32_t>(irq42), 0x08, 0x8E);
+    set_gate(75, reinterpret_cast<uint32_t>(irq43), 0x08, 0x8E);
+    set_gate(76, reinterpret_cast<uint32_t>(irq44), 0x08, 0x8E);
+    set_gate(77, reinterpret_cast<uint32_t>(irq45), 0x08, 0x8E);
+    set_gate(78, reinterpret_cast<uint32_t>(irq46), 0x08, 0x8E);
+    set_gate(79, reinterpret_cast<uint32_t>(irq47), 0x08, 0x8E);
+    set_gate(255, reinterpret_cast<uint32_t>(isr255), 0x08, 0x8E);
 
     set_gate(ludos_syscall_int, (uint32_t)(syscall_ludos), 0x08, 0xEE);
     set_gate(linux_syscall_int, (uint32_t)(syscall_linux), 0x08, 0xEE);
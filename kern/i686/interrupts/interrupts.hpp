@@ -46,6 +46,18 @@ inline bool interrupts_enabled()
     return flags & (1 << 9);
 }
 
+// disables the interrupts for its lifetime, then restores them as they were
+struct IrqGuard
+{
+    IrqGuard() : enabled(interrupts_enabled()) { cli(); }
+    ~IrqGuard() { if (enabled) sti(); }
+
+    IrqGuard(const IrqGuard&) = delete;
+    IrqGuard& operator=(const IrqGuard&) = delete;
+
+    const bool enabled;
+};
+
 inline void interrupt(uint8_t code)
 {
     __asm__ __volatile__ ("int %0" : :"i"(code));
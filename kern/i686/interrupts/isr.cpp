@@ -25,6 +25,7 @@ SOFTWARE.
 
 #include "i686/cpu/registers.hpp"
 #include "i686/pc/devices/pic.hpp"
+#include "i686/pc/devices/lapic.hpp"
 #include "i686/tasking/process.hpp"
 #include "halt.hpp"
 #include "panic.hpp"
@@ -36,6 +37,7 @@ SOFTWARE.
 
 #include "tasking/process.hpp"
 #include "tasking/process_data.hpp"
+#include "tasking/softirq.hpp"
 #include "i686/tasking/tss.hpp"
 
 #include <stdio.h>
@@ -128,7 +130,14 @@ const registers* isr_handler(registers* const regs)
 extern "C"
 const registers* irq_handler(registers* const regs)
 {
-    pic::send_eoi(regs->int_no-31);
+    if (regs->int_no <= IRQ15)
+    {
+        pic::send_eoi(regs->int_no-31);
+    }
+    else
+    {
+        lapic::eoi(); // vectors past the PIC ones come from the local APIC
+    }
     if (auto handl = handlers[regs->int_no])
     {
         handl(regs);
@@ -138,6 +147,14 @@ const registers* irq_handler(registers* const regs)
         //log_serial("Unhandled irq %d\n", regs->int_no);
     }
 
+    // run the deferred work with interrupts enabled, so that it doesn't hold back other IRQs ;
+    // nested IRQs return right away as softirq::run() is already running
+    if (softirq::pending())
+    {
+        sti();
+        softirq::run();
+        cli();
+    }
 
     return regs;
 }
@@ -152,3 +169,23 @@ void isr::delete_handler(uint8_t num)
 {
     handlers[num] = nullptr;
 }
+
+uint8_t isr::allocate_vector(isr::isr_t handler)
+{
+    for (size_t num { FIRST_DYNAMIC_VECTOR }; num <= LAST_DYNAMIC_VECTOR; ++num)
+    {
+        if (!handlers[num])
+        {
+            handlers[num] = std::move(handler);
+            return num;
+        }
+    }
+
+    return 0;
+}
+
+void isr::free_vector(uint8_t num)
+{
+    assert(num >= FIRST_DYNAMIC_VECTOR && num <= LAST_DYNAMIC_VECTOR);
+    handlers[num] = nullptr;
+}
@@ -46,6 +46,10 @@ SOFTWARE.
 #define IRQ14 46
 #define IRQ15 47
 
+// vectors past the PIC ones, delivered by the local APIC
+#define FIRST_DYNAMIC_VECTOR 49
+#define LAST_DYNAMIC_VECTOR 79
+
 namespace isr
 {
 
@@ -64,6 +68,10 @@ using isr_t = std::function<bool(registers* const r)>;
 void register_handler(uint8_t num, isr_t handler);
 
 void delete_handler(uint8_t num);
+
+// installs 'handler' on a free vector in [FIRST_DYNAMIC_VECTOR; LAST_DYNAMIC_VECTOR] ; returns 0 when none is left
+uint8_t allocate_vector(isr_t handler);
+void free_vector(uint8_t num);
 }
 
 #endif // ISR_HPP
@@ -28,6 +28,9 @@ SOFTWARE.
 #include "panic.hpp"
 
 #include "mem/page_fault.hpp"
+#include "mem/uaccess.hpp"
+#include "tasking/process.hpp"
+#include "i686/interrupts/interrupts.hpp"
 
 #include <libdisasm/libdis.h>
 
@@ -49,11 +52,35 @@ bool Paging::page_fault_handler(registers *regs)
         panic("Reserved paging structure bit write !\n");
     }
 
-    log_serial("returning to 0x%x\n", regs->eip);
+    // the pages of mmap'ed ranges are brought in on first touch, the faulting access is then retried
+    if (fault.address < KERNEL_VIRTUAL_BASE && Process::has_current())
+    {
+        // reading the file may sleep, which is fine if the faulting context had interrupts enabled
+        const bool irqs = regs->eflags & (1<<9);
+        if (irqs) sti();
+        const bool handled = Process::current().handle_mmap_fault(fault.address, fault.type == PageFault::Write);
+        if (irqs) cli();
+
+        if (handled)
+        {
+            return true;
+        }
+    }
+
+    // a user copy routine faulted : resume at its fixup code, which makes it return -EFAULT
+    if (fault.level == PageFault::Kernel && fault.address < KERNEL_VIRTUAL_BASE)
+    {
+        if (uintptr_t fixup = search_exception_table(regs->eip))
+        {
+            regs->eip = fixup;
+            return true;
+        }
+    }
 
     // if eip seems invalid, try to manually pop the stack and return
     if (!Memory::is_mapped((unsigned char*)regs->eip))
     {
+        log_serial("returning to 0x%x\n", regs->eip);
         if (Memory::is_mapped((unsigned char*)regs->esp))
         {
             uintptr_t return_eip = *(uintptr_t*)(regs->esp);
@@ -56,6 +56,11 @@ void Paging::init()
     write_cr3(pd_addr);
     write_cr4(cr4_var);
 
+    // make the kernel honor read-only pages too, so that copy_to_user faults on them
+    uint32_t cr0_var = cr0();
+    bit_set(cr0_var, 16);
+    write_cr0(cr0_var);
+
     sti();
 }
 
@@ -0,0 +1,86 @@
+; uaccess.asm -- copies between kernel and user memory which recover from page faults
+
+global copy_user_impl
+global strncpy_from_user_impl
+
+EFAULT equ 14
+
+; registers an instruction which can fault on a user address, along with the code to resume at
+%macro EX_ENTRY 2
+section .ex_table progbits alloc noexec nowrite align=4
+    dd %1, %2
+section .text
+%endmacro
+
+section .text
+
+; size_t copy_user_impl(void* dst, const void* src, size_t len)
+; returns the number of bytes which couldn't be copied
+copy_user_impl:
+    push esi
+    push edi
+
+    mov edi, [esp+12]
+    mov esi, [esp+16]
+    mov edx, [esp+20]
+
+    mov ecx, edx
+    shr ecx, 2
+    and edx, 3
+.dwords:
+    rep movsd
+    mov ecx, edx
+.bytes:
+    rep movsb
+
+    xor eax, eax
+.out:
+    pop edi
+    pop esi
+    ret
+
+; ecx holds the dwords left, edx the trailing bytes
+.dwords_fault:
+    lea eax, [edx + ecx*4]
+    jmp .out
+.bytes_fault:
+    mov eax, ecx
+    jmp .out
+
+EX_ENTRY .dwords, .dwords_fault
+EX_ENTRY .bytes, .bytes_fault
+
+; long strncpy_from_user_impl(char* dst, const char* src, size_t len)
+; returns the string length, len if no terminator was found, or -EFAULT
+strncpy_from_user_impl:
+    push esi
+    push edi
+
+    mov edi, [esp+12]
+    mov esi, [esp+16]
+    mov ecx, [esp+20]
+    xor edx, edx
+
+.loop:
+    cmp edx, ecx
+    je .done
+.load:
+    mov al, [esi+edx]
+    mov [edi+edx], al
+    test al, al
+    jz .done
+    inc edx
+    jmp .loop
+
+.done:
+    mov eax, edx
+.out:
+    pop edi
+    pop esi
+    ret
+
+.fault:
+    mov eax, -EFAULT
+    jmp .out
+
+EX_ENTRY .load, .fault
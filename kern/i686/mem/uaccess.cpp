@@ -0,0 +1,102 @@
+/*
+uaccess.cpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "mem/uaccess.hpp"
+
+#include <errno.h>
+
+#include "utils/defs.hpp"
+
+struct ExceptionTableEntry
+{
+    uintptr_t insn;
+    uintptr_t fixup;
+};
+
+extern "C" ExceptionTableEntry start_ex_table[];
+extern "C" ExceptionTableEntry end_ex_table[];
+
+extern "C" size_t copy_user_impl(void* dst, const void* src, size_t len);
+extern "C" long strncpy_from_user_impl(char* dst, const char* src, size_t len);
+
+bool access_ok(const void* ptr, size_t len)
+{
+    const uintptr_t addr = (uintptr_t)ptr;
+
+    return addr + len >= addr && addr + len <= KERNEL_VIRTUAL_BASE;
+}
+
+int copy_from_user(void *dst, const void *user_src, size_t len)
+{
+    if (!access_ok(user_src, len))
+    {
+        return -EFAULT;
+    }
+
+    return copy_user_impl(dst, user_src, len) ? -EFAULT : 0;
+}
+
+int copy_to_user(void *user_dst, const void *src, size_t len)
+{
+    if (!access_ok(user_dst, len))
+    {
+        return -EFAULT;
+    }
+
+    return copy_user_impl(user_dst, src, len) ? -EFAULT : 0;
+}
+
+long strncpy_from_user(char *dst, const char *user_src, size_t len)
+{
+    const uintptr_t addr = (uintptr_t)user_src;
+    if (addr >= KERNEL_VIRTUAL_BASE)
+    {
+        return -EFAULT;
+    }
+
+    // never read past the end of user space
+    const size_t max_len = (len < KERNEL_VIRTUAL_BASE - addr) ? len : KERNEL_VIRTUAL_BASE - addr;
+
+    long result = strncpy_from_user_impl(dst, user_src, max_len);
+    if (result >= 0 && (size_t)result == max_len && max_len < len)
+    {
+        return -EFAULT;
+    }
+
+    return result;
+}
+
+uintptr_t search_exception_table(uintptr_t ip)
+{
+    for (auto entry = start_ex_table; entry != end_ex_table; ++entry)
+    {
+        if (entry->insn == ip)
+        {
+            return entry->fixup;
+        }
+    }
+
+    return 0;
+}
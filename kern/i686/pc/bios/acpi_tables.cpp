@@ -0,0 +1,143 @@
+/*
+acpi_tables.cpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "acpi_tables.hpp"
+
+#include <string.h>
+
+#include "bda.hpp"
+#include "mem/memmap.hpp"
+#include "utils/logging.hpp"
+
+namespace acpi_tables
+{
+namespace
+{
+struct [[gnu::packed]] RSDP
+{
+    char signature[8];
+    uint8_t checksum;
+    char oem_id[6];
+    uint8_t revision;
+    uint32_t rsdt_address;
+};
+
+uint8_t checksum(const uint8_t* data, size_t len)
+{
+    uint8_t sum = 0;
+    for (size_t i { 0 }; i < len; ++i)
+    {
+        sum += data[i];
+    }
+    return sum;
+}
+
+// physical address of the RSDT referenced by an RSDP in [base; base+len), 0 if none
+uintptr_t search_rsdp(uintptr_t base, size_t len)
+{
+    const uint8_t* addr = (const uint8_t*)Memory::mmap(base, len, Memory::Read);
+    uintptr_t result = 0;
+
+    // the RSDP is on a 16-byte boundary
+    for (size_t off { 0 }; off + sizeof(RSDP) <= len; off += 16)
+    {
+        if (memcmp(addr + off, "RSD PTR ", 8) == 0 && checksum(addr + off, sizeof(RSDP)) == 0)
+        {
+            result = reinterpret_cast<const RSDP*>(addr + off)->rsdt_address;
+            break;
+        }
+    }
+
+    Memory::unmap((void*)addr, len);
+    return result;
+}
+
+uintptr_t rsdt_address()
+{
+    static uintptr_t address = 0;
+    static bool searched = false;
+    if (searched) return address;
+    searched = true;
+
+    if (uintptr_t ebda = uintptr_t(BDA::ebda_segment()) << 4; ebda)
+    {
+        address = search_rsdp(ebda, 0x400);
+    }
+    if (!address)
+    {
+        address = search_rsdp(0xE0000, 0x20000);
+    }
+
+    if (!address) log(Debug, "no ACPI RSDP found\n");
+
+    return address;
+}
+}
+
+kpp::optional<uintptr_t> find(const char* signature)
+{
+    const uintptr_t rsdt = rsdt_address();
+    if (!rsdt) return {};
+
+    SDTHeader header;
+    Memory::phys_read(rsdt, &header, sizeof(header));
+    if (memcmp(header.signature, "RSDT", 4) != 0) return {};
+
+    const size_t count = (header.length - sizeof(SDTHeader)) / sizeof(uint32_t);
+    std::vector<uint32_t> entries(count);
+    Memory::phys_read(rsdt + sizeof(SDTHeader), entries.data(), count * sizeof(uint32_t));
+
+    for (uint32_t entry : entries)
+    {
+        Memory::phys_read(entry, &header, sizeof(header));
+        if (memcmp(header.signature, signature, 4) == 0)
+        {
+            return uintptr_t(entry);
+        }
+    }
+
+    return {};
+}
+
+std::vector<uint8_t> read(const char* signature)
+{
+    auto address = find(signature);
+    if (!address) return {};
+
+    SDTHeader header;
+    Memory::phys_read(*address, &header, sizeof(header));
+
+    std::vector<uint8_t> table(header.length);
+    Memory::phys_read(*address, table.data(), table.size());
+
+    if (checksum(table.data(), table.size()) != 0)
+    {
+        warn("ACPI table %.4s has a bad checksum, ignoring it\n", signature);
+        return {};
+    }
+
+    return table;
+}
+}
@@ -0,0 +1,57 @@
+/*
+acpi_tables.hpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+#ifndef ACPI_TABLES_HPP
+#define ACPI_TABLES_HPP
+
+#include <stdint.h>
+
+#include <optional.hpp>
+#include <vector.hpp>
+
+// Minimal lookup of the static ACPI tables through the RSDP and the RSDT, for the early users
+// that can't depend on ACPICA being built in (PCI ECAM through the MCFG)
+namespace acpi_tables
+{
+struct [[gnu::packed]] SDTHeader
+{
+    char signature[4];
+    uint32_t length;
+    uint8_t revision;
+    uint8_t checksum;
+    char oem_id[6];
+    char oem_table_id[8];
+    uint32_t oem_revision;
+    uint32_t creator_id;
+    uint32_t creator_revision;
+};
+
+// physical address of the first table with the given signature
+kpp::optional<uintptr_t> find(const char* signature);
+
+// copy of the whole table, empty if it doesn't exist or its checksum is wrong
+std::vector<uint8_t> read(const char* signature);
+}
+
+#endif // ACPI_TABLES_HPP
@@ -92,3 +92,8 @@ uint16_t BDA::video_io_port()
 {
     return *reinterpret_cast<uint16_t*>(0x0463 + KERNEL_VIRTUAL_BASE);
 }
+
+uint16_t BDA::ebda_segment()
+{
+    return *reinterpret_cast<uint16_t*>(0x040E + KERNEL_VIRTUAL_BASE);
+}
@@ -49,6 +49,8 @@ namespace BDA
     uint16_t txt_mode_columns();
 
     uint16_t video_io_port();
+
+    uint16_t ebda_segment();
 }
 
 #endif // BDA_HPP
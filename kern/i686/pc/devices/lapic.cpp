@@ -0,0 +1,208 @@
+/*
+lapic.cpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "lapic.hpp"
+
+#include "pic.hpp"
+#include "i686/cpu/cpuid.hpp"
+#include "i686/cpu/msr.hpp"
+#include "i686/interrupts/isr.hpp"
+#include "mem/memmap.hpp"
+#include "time/time.hpp"
+#include "debug/profiler.hpp"
+#include "utils/logging.hpp"
+
+namespace lapic
+{
+namespace
+{
+constexpr uint32_t apic_base_msr     = 0x1B;
+constexpr uint32_t apic_base_enable  = 1<<11;
+constexpr uint32_t svr_enable        = 1<<8;
+
+volatile uint32_t* regs { nullptr };
+}
+
+bool available()
+{
+    uint32_t edx, unused;
+    cpuid(1, unused, unused, unused, edx);
+
+    return (edx & (1<<9)) && has_msrs();
+}
+
+bool init()
+{
+    if (regs) return true;
+    if (!available()) return false;
+
+    const uint64_t base_msr = read_msr(apic_base_msr);
+    const uintptr_t base = base_msr & 0xFFFFF000;
+    write_msr(apic_base_msr, base_msr | apic_base_enable);
+
+    regs = static_cast<volatile uint32_t*>(Memory::mmap(base, 0x1000, Memory::Read|Memory::Write|Memory::Uncached));
+    if (!regs) return false;
+
+    isr::register_handler(LAPIC_SPURIOUS_VECTOR, [](const registers* const)
+    {
+        return true; // spurious interrupts must not be acknowledged
+    });
+
+    write(TPR, 0);
+    write(SVR, svr_enable | LAPIC_SPURIOUS_VECTOR);
+
+    log(Info, "Local APIC %d initialized at 0x%x (version 0x%x)\n", id(), base, read(Version) & 0xFF);
+
+    return true;
+}
+
+uint32_t read(Register reg)
+{
+    return regs[reg / sizeof(uint32_t)];
+}
+
+void write(Register reg, uint32_t value)
+{
+    regs[reg / sizeof(uint32_t)] = value;
+}
+
+void eoi()
+{
+    write(EOI, 0);
+}
+
+uint8_t id()
+{
+    return read(ID) >> 24;
+}
+}
+
+namespace
+{
+constexpr uint32_t tsc_deadline_msr  = 0x6E0;
+constexpr uint32_t lvt_masked        = 1<<16;
+constexpr uint32_t lvt_oneshot       = 0b00<<17;
+constexpr uint32_t lvt_tsc_deadline  = 0b10<<17;
+constexpr uint32_t divide_by_16      = 0b0011;
+constexpr uint32_t calibration_ticks = 10;
+
+bool has_tsc_deadline()
+{
+    uint32_t ecx, unused;
+    cpuid(1, unused, unused, ecx, unused);
+
+    return ecx & (1<<24);
+}
+}
+
+bool LAPICTimer::init()
+{
+    if (!lapic::init() || !freq())
+    {
+        return false;
+    }
+
+    m_tsc_deadline = has_tsc_deadline();
+    if (!m_tsc_deadline)
+    {
+        calibrate();
+        if (!m_khz)
+        {
+            warn("Local APIC timer didn't count during calibration, keeping the PIT\n");
+            return false;
+        }
+    }
+
+    isr::register_handler(LAPIC_TIMER_VECTOR, &irq_callback);
+    lapic::write(lapic::LVTTimer, LAPIC_TIMER_VECTOR | (m_tsc_deadline ? lvt_tsc_deadline : lvt_oneshot));
+
+    Timer::set_oneshot_device(&program);
+
+    // the one-shot timer drives everything from now on
+    pic::set_mask(0);
+
+    if (m_tsc_deadline)
+    {
+        log(Info, "Local APIC timer initialized in TSC-deadline mode, kernel is tickless\n");
+    }
+    else
+    {
+        log(Info, "Local APIC timer initialized at %d kHz, kernel is tickless\n", (uint32_t)m_khz);
+    }
+
+    return true;
+}
+
+bool LAPICTimer::tsc_deadline_mode()
+{
+    return m_tsc_deadline;
+}
+
+uint64_t LAPICTimer::khz()
+{
+    return m_khz;
+}
+
+bool LAPICTimer::irq_callback(const registers * const regs)
+{
+    profiler::sample(regs->eip, regs->ebp, regs->cs & 0x3);
+    Timer::oneshot_callback();
+    return true;
+}
+
+void LAPICTimer::calibrate()
+{
+    lapic::write(lapic::TimerDivide, divide_by_16);
+    lapic::write(lapic::LVTTimer, lvt_masked);
+
+    // count down over a few PIT periods, starting on a tick edge
+    uint32_t ticks = Timer::ticks();
+    while (ticks == Timer::ticks()) { nop(); }
+    ticks = Timer::ticks();
+
+    lapic::write(lapic::TimerInitial, 0xFFFFFFFF);
+    while (ticks + calibration_ticks > Timer::ticks()) { nop(); }
+    const uint32_t elapsed = 0xFFFFFFFF - lapic::read(lapic::TimerCurrent);
+
+    lapic::write(lapic::TimerInitial, 0);
+
+    m_khz = uint64_t(elapsed) * freq() / 1000 / calibration_ticks;
+}
+
+void LAPICTimer::program(uint64_t deadline)
+{
+    if (m_tsc_deadline)
+    {
+        // a zero deadline disarms the timer
+        write_msr(tsc_deadline_msr, deadline ? deadline : 1);
+        return;
+    }
+
+    const uint64_t now = Time::total_ticks();
+    const uint64_t delta = deadline > now ? deadline - now : 0;
+
+    const uint64_t count = delta * m_khz / Time::tsc_khz();
+    lapic::write(lapic::TimerInitial, std::clamp<uint64_t>(count, 1, 0xFFFFFFFF));
+}
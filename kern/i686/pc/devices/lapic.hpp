@@ -0,0 +1,88 @@
+/*
+lapic.hpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+#ifndef LAPIC_HPP
+#define LAPIC_HPP
+
+#include <stdint.h>
+
+#include "i686/cpu/registers.hpp"
+#include "time/timer.hpp"
+
+#define LAPIC_TIMER_VECTOR 48
+#define LAPIC_SPURIOUS_VECTOR 0xFF
+
+namespace lapic
+{
+enum Register : uint32_t
+{
+    ID            = 0x20,
+    Version       = 0x30,
+    TPR           = 0x80,
+    EOI           = 0xB0,
+    SVR           = 0xF0,
+    LVTTimer      = 0x320,
+    TimerInitial  = 0x380,
+    TimerCurrent  = 0x390,
+    TimerDivide   = 0x3E0
+};
+
+bool available();
+
+// maps and software-enables the local APIC of the boot CPU ; false if there is none
+bool init();
+
+uint32_t read(Register reg);
+void write(Register reg, uint32_t value);
+
+void eoi();
+
+uint8_t id();
+}
+
+// One-shot event device driving the Timer once calibrated against the PIT ;
+// uses the TSC-deadline mode when the CPU supports it, the APIC timer count otherwise
+class LAPICTimer : public Timer
+{
+public:
+    // switches the Timer to tickless mode and masks the PIT ; false if no local APIC timer is usable
+    static bool init();
+
+    static bool tsc_deadline_mode();
+
+    // APIC timer frequency after the divider, 0 in TSC-deadline mode
+    static uint64_t khz();
+
+private:
+    static bool irq_callback(const registers* const);
+
+    static void calibrate();
+    static void program(uint64_t deadline);
+
+private:
+    static inline bool m_tsc_deadline { false };
+    static inline uint64_t m_khz { 0 };
+};
+
+#endif // LAPIC_HPP
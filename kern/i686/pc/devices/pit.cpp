@@ -31,6 +31,7 @@ SOFTWARE.
 #include "i686/interrupts/isr.hpp"
 #include "time/timer.hpp"
 #include "time/time.hpp"
+#include "debug/profiler.hpp"
 
 void PIT::init(uint32_t freq)
 {
@@ -72,8 +73,9 @@ void PIT::set_pcspeaker_frequency(uint16_t freq)
     outb(0x42, static_cast<uint8_t>(div >> 8));
 }
 
-bool PIT::irq_callback(const registers * const)
+bool PIT::irq_callback(const registers * const regs)
 {
+    profiler::sample(regs->eip, regs->ebp, regs->cs & 0x3);
     Timer::irq_callback();
     return true;
 }
@@ -61,6 +61,7 @@ bool PS2Keyboard::accept()
 }
 
 PS2Keyboard::PS2Keyboard()
+    : m_events("ps2kbd", [](const DriverKbdEvent& e) { kmsgbus.send(e); })
 {
     isr::register_handler(IRQ1, [this](const registers* const r){return isr(r);});
 
@@ -145,11 +146,11 @@ bool PS2Keyboard::isr(const registers *)
         // TODO : inherit from keyboard driver and automatically set the kbd id
         if (last_is_e0 && e0_key_assocs[code] != 0xFF)
         {
-            kmsgbus.send<DriverKbdEvent>({0, {e0_key_assocs[code]}, key_state});
+            m_events.push({0, {e0_key_assocs[code]}, key_state});
         }
         else if (key_assocs[code] != 0xFF)
         {
-            kmsgbus.send<DriverKbdEvent>({0, {key_assocs[code]}, key_state});
+            m_events.push({0, {key_assocs[code]}, key_state});
         }
 
         last_is_e0 = false;
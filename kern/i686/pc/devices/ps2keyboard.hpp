@@ -31,6 +31,8 @@ SOFTWARE.
 #include <vector.hpp>
 
 #include "drivers/driver.hpp"
+#include "drivers/kbd/driver_kbd_event.hpp"
+#include "tasking/softirq.hpp"
 
 class PS2Keyboard : public Driver
 {
@@ -62,6 +64,7 @@ private:
     uint8_t leds { 0 };
 
     bool last_is_e0 { false };
+    softirq::Queue<DriverKbdEvent> m_events;
 
     kpp::array<uint8_t, 256> key_assocs;
 
@@ -60,6 +60,7 @@ bool PS2Mouse::accept()
 }
 
 PS2Mouse::PS2Mouse()
+    : m_packets("ps2mouse", [](const MousePacket& packet) { kmsgbus.post(packet); })
 {
     enable();
 
@@ -124,7 +125,7 @@ bool PS2Mouse::isr(const registers *regs)
             !(packet.z == -8 && (static_cast<int16_t>(packet.y_sign-static_cast<int16_t>(packet.y)) == 90
                                  || static_cast<int16_t>(packet.y_sign-static_cast<int16_t>(packet.y)) == 91))) // it oftens indicate a broken packet, dunno why
     {
-        kmsgbus.send<MousePacket>({static_cast<int16_t>(packet.x_sign-static_cast<int16_t>(packet.x)), static_cast<int16_t>(packet.y_sign-static_cast<int16_t>(packet.y)),
+        m_packets.push({static_cast<int16_t>(packet.x_sign-static_cast<int16_t>(packet.x)), static_cast<int16_t>(packet.y_sign-static_cast<int16_t>(packet.y)),
                                        static_cast<int16_t>(packet.z), static_cast<bool>(packet.left_but), static_cast<bool>(packet.mid_but), static_cast<bool>(packet.right_but),
                                        static_cast<bool>(packet.but_4), static_cast<bool>(packet.but_5)});
     }
@@ -28,6 +28,8 @@ SOFTWARE.
 #include "i686/cpu/registers.hpp"
 
 #include "drivers/driver.hpp"
+#include "drivers/mouse/mouse.hpp"
+#include "tasking/softirq.hpp"
 
 class PS2Mouse : public Driver
 {
@@ -56,6 +58,7 @@ private:
 
 private:
     bool is_intellimouse { false };
+    softirq::Queue<MousePacket> m_packets;
 };
 
 #endif // PS2MOUSE_HPP
@@ -32,11 +32,13 @@ SOFTWARE.
 #include "cpu/traps.hpp"
 #include "devices/pic.hpp"
 #include "devices/pit.hpp"
+#include "devices/lapic.hpp"
 #include "i686/fpu/fpu.hpp"
 #include "i686/interrupts/idt.hpp"
 #include "i686/interrupts/isr.hpp"
 #include "i686/cpu/cpuinfo.hpp"
 #include "i686/cpu/mtrr.hpp"
+#include "i686/cpu/memops.hpp"
 #include "i686/simd/simd.hpp"
 #include "i686/cpu/cpuid.hpp"
 #include "i686/pc/terminal/textterminal.hpp"
@@ -82,6 +84,10 @@ SOFTWARE.
 #include "utils/env.hpp"
 #include "utils/virt_machine_detect.hpp"
 #include "utils/logging.hpp"
+#include "utils/klog.hpp"
+#include "utils/kmsgbus.hpp"
+#include "tasking/softirq.hpp"
+#include "i686/cpu/idle.hpp"
 #include "utils/defs.hpp"
 #include "utils/memutils.hpp"
 
@@ -233,14 +239,6 @@ void init(uint32_t magic, const multiboot_info_t* mbd_info)
     if (simd_features() & SSE)
     {
         log(Debug, "CPU is SSE capable\n");
-
-        aligned_memcpy = _memcpy_mmx;
-        if (simd_features() & SSE2)
-        {
-            aligned_memcpy = _aligned_memcpy_sse2;
-            aligned_memsetl = _aligned_memsetl_sse2;
-            aligned_double_memsetl = _aligned_double_memsetl_sse2;
-        }
     }
     else
     {
@@ -248,6 +246,8 @@ void init(uint32_t magic, const multiboot_info_t* mbd_info)
         panic("No SSE support on this CPU\nThis kernel was built with SSE support, halting\n");
 #endif
     }
+    memops::select();
+    memops::register_bench_cases();
 
     traps::init();
 
@@ -266,6 +266,16 @@ void init(uint32_t magic, const multiboot_info_t* mbd_info)
     log(Info, "CPU clock speed : ~%llu MHz\n", clock_speed());
     detect_cpu();
 
+    // switch from the periodic PIT to one-shot local APIC timer events, the PIT stays as a fallback
+    if (kgetenv("notickless"))
+    {
+        log(Info, "Tickless mode disabled, keeping the %d Hz PIT tick\n", Timer::freq());
+    }
+    else if (!LAPICTimer::init())
+    {
+        log(Info, "No usable local APIC timer, keeping the %d Hz PIT tick\n", Timer::freq());
+    }
+
 #ifdef USE_MTRRS
     if (mtrr::available() && mtrr::available_variable_ranges()>0)
     {
@@ -306,13 +316,29 @@ void init(uint32_t magic, const multiboot_info_t* mbd_info)
 
     tasking::scheduler_init();
 
+    klog::start_drain_task();
+    start_kmsgbus_task();
+
     auto idle_task = Process::create_kernel_task([]()
     {
         while (true)
         {
-//            asm volatile ("sti; hlt\n"); // wait for an interrupt to occur
-//            asm volatile ("cli\n");      // at this point, an interrupt occured, disable them again
+            softirq::run();
+            klog::drain();
             tasking::schedule();
+
+            // nothing else to run : halt until an interrupt brings new work or a sleeper's tick
+            cli();
+            if (!tasking::has_ready_process() && !softirq::pending())
+            {
+                const uint64_t start = Time::total_ticks();
+                cpu_idle();
+                tasking::halted_ticks += Time::total_ticks() - start;
+            }
+            else
+            {
+                sti();
+            }
         }
     });
     //idle_task->arch_context->init_regs->eflags = 0x0; // disable interrupts for the idle task
@@ -87,5 +87,16 @@ void write(const char *fmt, ...)
     }
 }
 
+void write_raw(const char *str, size_t len)
+{
+    static int com_port = BDA::com1_port();
+
+    for (size_t i { 0 }; i < len; ++i)
+    {
+        write_serial(com_port, str[i]);
+        outb(0xe9, str[i]); // bochs
+    }
+}
+
 }
 }
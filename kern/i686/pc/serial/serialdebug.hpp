@@ -40,6 +40,8 @@ void write(uint16_t comport, const char* fmt, ...);
 PRINTF_FMT(1, 2)
 void write(const char* fmt, ...);
 
+void write_raw(const char* str, size_t len);
+
 }
 }
 
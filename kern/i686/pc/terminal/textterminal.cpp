@@ -38,28 +38,42 @@ TextTerminal::TextTerminal(uintptr_t fb, size_t iwidth, size_t iheight, Terminal
 
 void TextTerminal::move_cursor(size_t x, size_t y)
 {
-    termio_move_cursor(x, y, 80);
+    termio_move_cursor(x, y, width());
 }
 
 void TextTerminal::putchar(size_t x, size_t y, TermEntry entry)
 {
-    assert(x < 80);
-    assert(y < 25);
+    assert(x < width());
+    assert(y < true_height());
 
     auto fb = reinterpret_cast<uint16_t*>(m_fb);
-    fb[y * 80 + x] = graphics::vga::entry(entry.c, graphics::vga::entry_color(graphics::vga::color_to_vga(entry.pair.fg),
+    fb[y * width() + x] = graphics::vga::entry(entry.c, graphics::vga::entry_color(graphics::vga::color_to_vga(entry.pair.fg),
                                                                               graphics::vga::color_to_vga(entry.pair.bg)));
 }
 
 void TextTerminal::clear_line(size_t y, graphics::Color color, size_t size)
 {
-    assert(y < 25);
+    assert(y < true_height());
 
     auto fb = reinterpret_cast<uint16_t*>(m_fb);
-    memsetw(fb + y*80, graphics::vga::entry(' ', graphics::vga::entry_color(graphics::vga::color_to_vga(color),
+    memsetw(fb + y*width(), graphics::vga::entry(' ', graphics::vga::entry_color(graphics::vga::color_to_vga(color),
                                 graphics::vga::color_to_vga(color))), size * sizeof(uint16_t));
 }
 
+bool TextTerminal::scroll_impl(size_t top, size_t lines)
+{
+    if (top + lines >= true_height())
+    {
+        return false;
+    }
+
+    // the text framebuffer rows are contiguous, move them all at once
+    auto fb = reinterpret_cast<uint16_t*>(m_fb);
+    memmove(fb + top*width(), fb + (top + lines)*width(), (true_height() - top - lines)*width()*sizeof(uint16_t));
+
+    return true;
+}
+
 void TextTerminal::draw_impl()
 {
 
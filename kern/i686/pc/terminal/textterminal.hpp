@@ -36,6 +36,7 @@ private:
     virtual void move_cursor(size_t x, size_t y) override;
     virtual void putchar(size_t x, size_t y, TermEntry entry) override;
     virtual void clear_line(size_t y, graphics::Color color, size_t size) override;
+    virtual bool scroll_impl(size_t top, size_t lines) override;
     virtual void draw_impl() override;
     virtual void disable_impl() override {}
 
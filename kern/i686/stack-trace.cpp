@@ -53,3 +53,18 @@ std::vector<TraceEntry> trace_stack(void *addr, size_t frames)
 
     return trace;
 }
+
+size_t capture_stack(void *addr, uintptr_t *addresses, size_t max)
+{
+    size_t count = 0;
+
+    auto fp = (const stack_frame*)addr;
+    // stop at the first frame outside of the kernel, e.g. the user frame a syscall came from
+    while (count < max && (uintptr_t)fp >= KERNEL_VIRTUAL_BASE && Memory::is_mapped(fp) && fp->return_addr)
+    {
+        addresses[count++] = fp->return_addr;
+        fp = fp->previous;
+    }
+
+    return count;
+}
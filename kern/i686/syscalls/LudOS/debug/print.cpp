@@ -32,6 +32,6 @@ SOFTWARE.
 void sys_panic(user_ptr<const char> string)
 {
     panic_regs = *Process::current().arch_context->user_regs;
-    if (string.check())
-        panic("%s", string.get());
+    if (auto str = string.str(0x10000))
+        panic("%s", str->c_str());
 }
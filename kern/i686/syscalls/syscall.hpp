@@ -32,6 +32,7 @@ SOFTWARE.
 #include "i686/cpu/registers.hpp"
 
 extern "C" const registers *syscall_handler(registers * const regs);
+extern "C" const registers *sysenter_handler(registers * const regs);
 
 using syscall_ptr = std::function<uint32_t(const registers* const)>;
 
@@ -33,6 +33,9 @@ SOFTWARE.
 
 #include "tasking/process_data.hpp"
 
+#include "mem/memmap.hpp"
+#include "mem/uaccess.hpp"
+
 
 extern "C" const registers* syscall_handler(registers* const regs)
 {
@@ -69,3 +72,19 @@ exit:
 
     return regs;
 }
+
+// Entered through the vDSO : the frame's esp is the user stack pointer the vDSO passed in ebp,
+// right where it pushed the user's ebp, the sixth argument
+extern "C" const registers* sysenter_handler(registers* const regs)
+{
+    uint32_t ebp;
+    if (copy_from_user(&ebp, (const void*)regs->esp, sizeof(ebp)) < 0)
+    {
+        regs->eax = -EFAULT;
+        return regs;
+    }
+
+    regs->ebp = ebp;
+
+    return syscall_handler(regs);
+}
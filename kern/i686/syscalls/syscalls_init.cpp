@@ -25,7 +25,10 @@ SOFTWARE.
 
 #include "syscall_table_init.hpp"
 
+#include "tasking/vdso.hpp"
+
 void init_syscalls()
 {
     init_syscall_table();
+    vdso::init();
 }
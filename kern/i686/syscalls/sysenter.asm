@@ -0,0 +1,119 @@
+; sysenter.asm -- fast system call entry, and the code pages mapped into processes as the vDSO
+
+%include "defs.asm"
+
+global sysenter_entry
+global vdso_sysenter_page
+global vdso_int80_page
+
+extern sysenter_handler
+
+VDSO_CODE_ADDR  equ KERNEL_VIRTUAL_BASE - 2*PAGE_SIZE
+USER_CODE_SEL   equ 0x1B ; gdt::user_code_selector, RPL 3
+USER_DATA_SEL   equ 0x23 ; gdt::user_data_selector, RPL 3
+
+; user address the vDSO expects to be resumed at
+SYSENTER_RETURN equ VDSO_CODE_ADDR + (vdso_sysenter_return - vdso_sysenter_page)
+
+; sysenter saves nothing : the vDSO left the user stack pointer in ebp, and is always resumed
+; at SYSENTER_RETURN
+sysenter_entry:
+    ; SYSENTER_ESP points at tss.esp0, load the kernel stack of the running task
+    mov esp, [esp]
+
+    ; build the same frame as int 0x80 would, so that the rest of the kernel (signals, fork, execve...)
+    ; doesn't have to know how the system call was entered
+    push dword USER_DATA_SEL ; ss
+    push ebp                 ; esp
+    pushfd
+    or dword [esp], 0x200    ; IF, cleared by sysenter
+    push dword USER_CODE_SEL ; cs
+    push dword SYSENTER_RETURN ; eip
+    push byte 0              ; err_code
+    push dword 0x80          ; int_no, use the linux syscall table
+
+    ; Store general purpose
+    pushad
+
+    ; Store segments
+    push ds
+    push es
+    push fs
+    push gs
+
+    ; Switch to kernel segments
+    mov ax, 0x10
+    mov ds, ax
+    mov es, ax
+    mov fs, ax
+    mov gs, ax
+
+    ; Push stack pointer
+    push esp
+
+    ; Restore interrupts
+    sti
+
+    ; Call handler
+    call sysenter_handler
+    ; Set stack pointer to returned value
+
+    mov esp, eax
+
+    ; Restore segments
+    pop gs
+    pop fs
+    pop es
+    pop ds
+
+    ; Restore general purpose
+    popad
+
+    ; Skip intr and error in Registers struct
+    add esp, 8
+
+    ; the frame can have been changed to return somewhere else (signal handler, execve...), iret then
+    cmp dword [esp], SYSENTER_RETURN
+    jne .iret_exit
+
+    ; sysexit loads eip from edx and esp from ecx, the vDSO restores both
+    mov edx, [esp]
+    mov ecx, [esp+12]
+
+    ; restore eflags, keeping interrupts disabled until sysexit
+    and dword [esp+8], ~0x200
+    add esp, 8
+    popfd
+    sti ; only takes effect after the next instruction
+    sysexit
+
+.iret_exit:
+    iret
+
+; The pages below are mapped read-only at VDSO_CODE_ADDR into every process, their code must stay position
+; independent. __kernel_vsyscall takes the int 0x80 convention : eax holds the system call number, ebx, ecx,
+; edx, esi, edi and ebp the arguments, and the result is returned in eax.
+
+align PAGE_SIZE
+
+; used when the cpu supports sysenter
+vdso_sysenter_page:
+    push ecx
+    push edx
+    push ebp ; the kernel reads the sixth argument from here
+    mov ebp, esp
+    sysenter
+vdso_sysenter_return:
+    pop ebp
+    pop edx
+    pop ecx
+    ret
+
+align PAGE_SIZE
+
+; fallback
+vdso_int80_page:
+    int 0x80
+    ret
+
+align PAGE_SIZE
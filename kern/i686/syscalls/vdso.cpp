@@ -0,0 +1,136 @@
+/*
+vdso.cpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "tasking/vdso.hpp"
+
+#include <sys/vdso.h>
+#include <string.h>
+
+#include "mem/memmap.hpp"
+#include "time/time.hpp"
+#include "utils/defs.hpp"
+#include "utils/env.hpp"
+#include "utils/logging.hpp"
+
+#include "i686/cpu/msr.hpp"
+#include "i686/gdt/gdt.hpp"
+#include "i686/tasking/tss.hpp"
+
+extern "C" void sysenter_entry();
+extern "C" void vdso_sysenter_page();
+extern "C" void vdso_int80_page();
+
+static_assert(VDSO_CODE_ADDR == KERNEL_VIRTUAL_BASE - 2*0x1000);
+static_assert(VDSO_DATA_ADDR == KERNEL_VIRTUAL_BASE - 3*0x1000);
+
+namespace vdso
+{
+
+namespace
+{
+constexpr uint32_t sysenter_cs_msr  = 0x174;
+constexpr uint32_t sysenter_esp_msr = 0x175;
+constexpr uint32_t sysenter_eip_msr = 0x176;
+
+uintptr_t code_paddr { 0 };
+uintptr_t data_paddr { 0 };
+vdso_data* data { nullptr };
+bool sysenter { false };
+
+bool has_sep()
+{
+    uint32_t eax, edx, unused;
+    cpuid(1, eax, unused, unused, edx);
+
+    if (!(edx & (1 << 11)))
+        return false;
+
+    // early Pentium Pros report SEP without supporting it
+    const uint32_t family   = (eax >> 8) & 0xF;
+    const uint32_t model    = (eax >> 4) & 0xF;
+    const uint32_t stepping = eax & 0xF;
+
+    return !(family == 6 && model < 3 && stepping < 3);
+}
+
+void setup_sysenter()
+{
+    write_msr(sysenter_cs_msr, gdt::kernel_code_selector*sizeof(gdt::entry));
+    // the entry stub loads the kernel stack of the running task from tss.esp0,
+    // so the MSR never has to be rewritten on task switches
+    write_msr(sysenter_esp_msr, (uintptr_t)&tss.esp0);
+    write_msr(sysenter_eip_msr, (uintptr_t)sysenter_entry);
+}
+}
+
+void init()
+{
+    data_paddr = Memory::allocate_physical_page();
+    assert(data_paddr);
+
+    data = (vdso_data*)Memory::mmap(data_paddr, Memory::page_size());
+    memset(data, 0, Memory::page_size());
+
+    const auto clock = Time::clocksource_info();
+    data->tsc_base   = clock.base_ticks;
+    data->tsc_mult   = clock.mult;
+    data->tsc_shift  = clock.shift;
+    data->boot_epoch = Time::boot_epoch();
+
+    sysenter = has_msrs() && has_sep() && !kgetenv("nosysenter");
+    if (sysenter)
+    {
+        setup_sysenter();
+    }
+
+    code_paddr = Memory::physical_address((void*)(sysenter ? vdso_sysenter_page : vdso_int80_page));
+
+    log_serial("vDSO system calls through %s\n", sysenter ? "sysenter" : "int 0x80");
+}
+
+uintptr_t code_page()
+{
+    return code_paddr;
+}
+
+uintptr_t data_page()
+{
+    return data_paddr;
+}
+
+bool fast_syscalls()
+{
+    return sysenter;
+}
+
+void set_current(pid_t pid, pid_t tid)
+{
+    if (!data) return;
+
+    data->pid = pid;
+    data->tid = tid;
+}
+
+}
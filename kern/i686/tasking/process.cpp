@@ -26,6 +26,8 @@ SOFTWARE.
 #include "tasking/process.hpp"
 #include "tasking/process_data.hpp"
 #include "i686/tasking/process.hpp"
+#include "syscalls/syscalls.hpp"
+#include "tasking/vdso.hpp"
 
 #include <vector.hpp>
 
@@ -42,6 +44,7 @@ SOFTWARE.
 
 #include "utils/membuffer.hpp"
 #include "utils/align.hpp"
+#include "time/time.hpp"
 
 #include <sched.h>
 
@@ -56,7 +59,7 @@ static_assert(sizeof(SignalTrampolineInfo) == 16);
 
 extern "C" [[noreturn]] void userspace_jump(const registers* regs);
 
-void Process::load_user_code(gsl::span<const uint8_t> code_to_copy, size_t allocated_size)
+void Process::reset_user_context()
 {
     auto* regs = arch_context->user_regs;
 
@@ -76,13 +79,36 @@ void Process::load_user_code(gsl::span<const uint8_t> code_to_copy, size_t alloc
         unmap_address_space();
 
     release_mappings();
-    create_mappings(code_to_copy, allocated_size, 2*Paging::page_size);
+}
+
+void Process::load_user_code(gsl::span<const uint8_t> code_to_copy, size_t allocated_size)
+{
+    reset_user_context();
+
+    create_mappings(code_to_copy, allocated_size, user_stack_size);
     init_tls();
 
     //    if (m_current_process == this)
     //        map_address_space();
 }
 
+bool Process::load_user_image(const std::function<bool()>& map_image)
+{
+    reset_user_context();
+
+    create_mappings({}, 0, user_stack_size);
+    // the TLS area goes to the first free range, after the program's segments
+    if (!map_image())
+    {
+        warn("Can't map the image of process %d, killing it\n", pid);
+        Process::kill(pid, __W_EXITCODE(255, SIGKILL));
+        return false;
+    }
+    init_tls();
+
+    return true;
+}
+
 void Process::expand_stack(size_t size)
 {
     arch_context->user_regs->esp -= size;
@@ -169,63 +195,51 @@ void Process::exit_signal()
     if (pid != returning_pid) task_switch(returning_pid);
 }
 
-bool Process::user_callback_fault_handler(const PageFault &fault)
+// Every stub has the same layout, only the handle changes :
+//     push ebx
+//     mov ebx, <handle>
+//     lea ecx, [esp+8] ; arguments pushed by the cdecl caller
+//     mov eax, SYS_interface_call
+//     int 0x70
+//     pop ebx
+//     ret
+static void write_callback_stub(uint8_t* stub, uint32_t handle)
 {
-    if (fault.level != PageFault::User) return false;
-    if (fault.type != PageFault::Read && fault.type != PageFault::Execute) return false;
-    if (!data->user_callbacks->list.count(fault.address)) return false;
-
-    auto entry = data->user_callbacks->list.at(fault.address);
-    do_user_callback(entry.callback, entry.arg_sizes);
-
-    return true;
+    const uint32_t sys_num = SYS_interface_call;
+    size_t idx = 0;
+
+    stub[idx++] = 0x53;
+    stub[idx++] = 0xBB; memcpy(stub + idx, &handle, 4); idx += 4;
+    stub[idx++] = 0x8D; stub[idx++] = 0x4C; stub[idx++] = 0x24; stub[idx++] = 0x08;
+    stub[idx++] = 0xB8; memcpy(stub + idx, &sys_num, 4); idx += 4;
+    stub[idx++] = 0xCD; stub[idx++] = ludos_syscall_int;
+    stub[idx++] = 0x5B;
+    stub[idx++] = 0xC3;
+
+    assert(idx <= Process::callback_stub_size);
+    memset(stub + idx, 0xCC, Process::callback_stub_size - idx); // int3
 }
 
-void Process::do_user_callback(const std::function<int (const std::vector<uintptr_t> &)> &callback, const std::vector<size_t>& arg_sizes)
+uintptr_t Process::callback_stub_page(size_t index)
 {
-    // TODO : copy_from_user
+    static std::vector<uintptr_t> stub_pages;
 
-    // will be released by the jump_to_userspace call
-    auto* regs = new registers{*arch_context->user_regs};
-    uintptr_t return_address = *(uintptr_t*)(regs->esp);
-
-    uintptr_t esp_copy = regs->esp;
-
-    std::vector<uintptr_t> arguments;
-    for (auto len : arg_sizes)
+    while (stub_pages.size() <= index)
     {
-        if (len == 2)
-        {
-            arguments.push_back(*(uint16_t*)(esp_copy));
-            esp_copy += 2;
-        }
-        else if (len == 4)
-        {
-            arguments.push_back(*(uint32_t*)(esp_copy));
-            esp_copy += 4;
-        }
-        else if (len == 8)
-        {
-            arguments.push_back(*(uint64_t*)(esp_copy));
-            esp_copy += 8;
-        }
-        else
+        uintptr_t phys_addr = Memory::allocate_physical_page();
+        assert(phys_addr);
+
+        auto page = (uint8_t*)Memory::mmap(phys_addr, Memory::page_size());
+        for (size_t i { 0 }; i < callback_stubs_per_page; ++i)
         {
-            assert(!!"Invalid argument size");
+            write_callback_stub(page + i*callback_stub_size, stub_pages.size()*callback_stubs_per_page + i);
         }
-    }
+        Memory::unmap(page, Memory::page_size());
 
-    for (auto arg : arguments)
-    {
-        kprintf("arg : 0x%x\n", arg);
+        stub_pages.emplace_back(phys_addr);
     }
 
-    int ret = callback(arguments);
-    regs->eax = ret;
-
-    arch_context->user_regs = regs;
-
-    jump_to_user_space(return_address);
+    return stub_pages[index];
 }
 
 Process *Process::create_kernel_task(void (*procedure)())
@@ -292,8 +306,16 @@ void Process::task_switch(pid_t pid)
 
     FPU::load(next->arch_context->fpu_state);
 
+    const uint64_t now = Time::total_ticks();
+    prev->cpu_time += now - m_switch_timestamp;
+    m_switch_timestamp = now;
+
     m_current_process = next;
 
+    // the next kernel entry from user mode, through an interrupt or sysenter, lands on this stack
+    tss.esp0 = (uintptr_t)(next->data->kernel_stack + ProcessData::kernel_stack_size);
+    vdso::set_current(next->tgid, next->pid);
+
     assert(next->arch_context->init_regs->dummy_esp == 0xcafebabe); // check stack integrity
     ::task_switch(&prev->arch_context->esp, &next->arch_context->esp);
 }
@@ -368,8 +390,11 @@ Process *Process::clone(Process &proc, uint32_t flags)
     else
         new_proc->data->fd_table = std::make_shared<std::vector<tasking::FDInfo>>(*proc.data->fd_table);
 
-    // TODO : refactor this
-    new_proc->data->user_callbacks = std::make_shared<tasking::UserCallbacks>(*proc.data->user_callbacks);
+    // the callback stubs live in the address space
+    if (flags & CLONE_VM)
+        new_proc->data->user_callbacks = proc.data->user_callbacks;
+    else
+        new_proc->data->user_callbacks = std::make_shared<tasking::UserCallbacks>(*proc.data->user_callbacks);
 
     new_proc->data->args = proc.data->args;
 
@@ -392,10 +417,16 @@ Process *Process::clone(Process &proc, uint32_t flags)
     if (flags & CLONE_VM)
     {
         new_proc->data->mappings = proc.data->mappings;
+        new_proc->data->shm_list = proc.data->shm_list;
+        new_proc->data->mmap_list = proc.data->mmap_list;
     }
     else
     {
         proc.copy_page_directory(*new_proc);
+        // attached segments stay attached at the same address in the child
+        *new_proc->data->shm_list = *proc.data->shm_list;
+        // so are the mmap'ed ranges, private pages already written were copied with the others
+        *new_proc->data->mmap_list = *proc.data->mmap_list;
     }
 
     new_proc->init_tls();
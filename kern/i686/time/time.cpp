@@ -34,11 +34,43 @@ namespace Time
 
 bool timer_ready = false;
 
+namespace
+{
+struct
+{
+    uint64_t khz { 0 };
+    uint32_t mult { 0 };  // ns per tick, scaled by 2^shift
+    uint32_t shift { 0 };
+    uint64_t boot_ticks { 0 };
+} clocksource;
+
+void init_clocksource()
+{
+    clocksource.khz = ::tsc_khz();
+    clocksource.boot_ticks = total_ticks();
+
+    // largest shift for which mult fits in 32 bits
+    uint32_t shift = 32;
+    while (shift > 0 && (1'000'000ULL << shift) / clocksource.khz > 0xFFFFFFFF)
+    {
+        --shift;
+    }
+    clocksource.shift = shift;
+    clocksource.mult = (1'000'000ULL << shift) / clocksource.khz;
+}
+}
+
 uint64_t clock_speed()
 {
     return ::clock_speed();
 }
 
+uint64_t tsc_khz()
+{
+    if (!clocksource.khz) init_clocksource();
+    return clocksource.khz;
+}
+
 uint64_t total_ticks()
 {
     uint64_t ret;
@@ -46,21 +78,48 @@ uint64_t total_ticks()
     return ret;
 }
 
-double uptime()
+uint64_t ticks_to_ns(uint64_t ticks)
 {
-    if (!timer_ready) return 0;
+    if (!clocksource.khz) init_clocksource();
+
+    // split the 64x32 multiplication so that it doesn't overflow
+    const uint64_t hi = (ticks >> 32) * clocksource.mult;
+    const uint64_t lo = (ticks & 0xFFFFFFFF) * clocksource.mult;
+
+    return (hi << (32 - clocksource.shift)) + (lo >> clocksource.shift);
+}
 
-    static double initial_ticks = total_ticks();
-    double ticks = total_ticks() - initial_ticks;
+uint64_t ns_to_ticks(uint64_t ns)
+{
+    const uint64_t khz = tsc_khz();
+    return (ns / 1'000'000) * khz + (ns % 1'000'000) * khz / 1'000'000;
+}
 
-    return ticks / (double(clock_speed()) * 1'000'000.0); // MHz -> Hz
+ClockSourceInfo clocksource_info()
+{
+    if (!clocksource.khz) init_clocksource();
+
+    return {clocksource.boot_ticks, clocksource.mult, clocksource.shift};
+}
+
+uint64_t uptime_ns()
+{
+    if (!timer_ready) return 0;
+    if (!clocksource.khz) init_clocksource();
+
+    return ticks_to_ns(total_ticks() - clocksource.boot_ticks);
 }
 
 size_t epoch()
 {
-    static auto boot_date = Time::to_unix(rtc::get_time());
+    return boot_epoch() + uptime_ns()/1'000'000'000;
+}
+
+size_t boot_epoch()
+{
+    static auto boot_date = Time::to_unix(rtc::get_time()) - uptime_ns()/1'000'000'000;
 
-    return boot_date + ticks_since_boot()/Timer::freq();
+    return boot_date;
 }
 
 uint64_t ticks_since_boot()
@@ -33,4 +33,23 @@ struct timespec
     long   tv_nsec;       /* nanoseconds */
 };
 
+struct timeval
+{
+    time_t      tv_sec;   /* seconds */
+    suseconds_t tv_usec;  /* microseconds */
+};
+
+struct timezone
+{
+    int tz_minuteswest;   /* minutes west of Greenwich */
+    int tz_dsttime;       /* type of DST correction */
+};
+
+#ifdef LUDOS_USER
+#ifdef __cplusplus
+extern "C"
+#endif
+int gettimeofday(struct timeval* tv, struct timezone* tz);
+#endif
+
 #endif // LUDOS_TIME_H
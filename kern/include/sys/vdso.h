@@ -0,0 +1,51 @@
+/*
+vdso.h
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+#ifndef LUDOS_VDSO_H
+#define LUDOS_VDSO_H
+
+#include <stdint.h>
+
+/* Pages mapped by the kernel into every process, right below the signal trampoline :
+ * the code page holds the system call entry (__kernel_vsyscall), the data page is read-only
+ * and kept up to date by the kernel, so that time and pid queries don't need a trap */
+#define VDSO_CODE_ADDR 0xBFFFE000
+#define VDSO_DATA_ADDR 0xBFFFD000
+
+#define VDSO_VSYSCALL  VDSO_CODE_ADDR
+
+struct vdso_data
+{
+    uint32_t pid; /* thread group id of the running process */
+    uint32_t tid;
+
+    /* uptime in ns = ((tsc - tsc_base) * tsc_mult) >> tsc_shift */
+    uint64_t tsc_base;
+    uint32_t tsc_mult;
+    uint32_t tsc_shift;
+
+    uint64_t boot_epoch; /* unix time at boot, in seconds */
+};
+
+#endif // LUDOS_VDSO_H
@@ -0,0 +1,56 @@
+/*
+uaccess.cpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "uaccess.hpp"
+
+#include <errno.h>
+
+#include <kstring/kstring.hpp>
+
+kpp::expected<kpp::string, int> user_string(const char *user_str, size_t max_len)
+{
+    kpp::string str;
+
+    // copy by chunks, so that short strings don't need a max_len sized buffer
+    char buf[128];
+    while (str.size() < max_len)
+    {
+        const size_t chunk_len = (max_len - str.size() < sizeof(buf)) ? max_len - str.size() : sizeof(buf);
+
+        long len = strncpy_from_user(buf, user_str + str.size(), chunk_len);
+        if (len < 0)
+        {
+            return kpp::make_unexpected(-len);
+        }
+
+        str.append(buf, len);
+        if ((size_t)len < chunk_len)
+        {
+            return str; // hit the terminator
+        }
+    }
+
+    return kpp::make_unexpected(ENAMETOOLONG);
+}
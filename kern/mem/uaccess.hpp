@@ -0,0 +1,56 @@
+/*
+uaccess.hpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+#ifndef UACCESS_HPP
+#define UACCESS_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <limits.h>
+
+#include <kstring/kstrfwd.hpp>
+#include <expected.hpp>
+
+// Accesses to user memory from the kernel.
+// The pointers are only range checked, the copy is then attempted directly : a fault on an unmapped
+// or read-only user page is caught through the exception table and reported as -EFAULT.
+
+// Returns true if [ptr, ptr+len) lies entirely in user space
+bool access_ok(const void* ptr, size_t len);
+
+// Return 0 on success, -EFAULT if part of the user range couldn't be accessed
+[[nodiscard]] int copy_from_user(void* dst, const void* user_src, size_t len);
+[[nodiscard]] int copy_to_user(void* user_dst, const void* src, size_t len);
+
+// Copies at most len bytes of the user string, null terminator included.
+// Returns the length of the string, len if it didn't fit, or -EFAULT.
+[[nodiscard]] long strncpy_from_user(char* dst, const char* user_src, size_t len);
+
+// Copies a user string of at most max_len characters, fails with EFAULT or ENAMETOOLONG
+kpp::expected<kpp::string, int> user_string(const char* user_str, size_t max_len = PATH_MAX);
+
+// Returns the fixup address for a faulting kernel instruction accessing user memory, or 0 if there is none
+uintptr_t search_exception_table(uintptr_t ip);
+
+#endif // UACCESS_HPP
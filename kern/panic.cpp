@@ -41,6 +41,7 @@ SOFTWARE.
 #include "drivers/sound/beep.hpp"
 
 #include "terminal/terminal.hpp"
+#include "utils/klog.hpp"
 
 #ifdef ARCH_i686
 #include "i686/pc/devices/speaker.hpp"
@@ -170,6 +171,8 @@ void panic(const char *fmt, ...)
 {
     cli();
 
+    klog::drain();
+
     term_data().clear();
     term_data().push_color({0xffffff, 0xaa0000});
 
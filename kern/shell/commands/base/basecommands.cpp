@@ -328,11 +328,11 @@ void install_base_commands(Shell &sh)
      {
          kpp::string command = join(args, " ");
 
-         auto start = Time::uptime();
+         const uint64_t start = Time::uptime_us();
          sh.command(command);
-         auto end = Time::uptime();
+         const uint64_t elapsed = Time::uptime_us() - start;
 
-         kprintf("Elapsed time : %f\n", end - start);
+         kprintf("Elapsed time : %lu.%06lu\n", (unsigned long)(elapsed / 1'000'000), (unsigned long)(elapsed % 1'000'000));
          return 0;
      }});
 
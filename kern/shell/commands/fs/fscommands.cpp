@@ -373,7 +373,7 @@ void install_fs_commands(Shell &sh)
      "Usage : sync",
      [](const std::vector<kpp::string>&)
      {
-         kmsgbus.send(SyncDisksCache{});
+         kmsgbus.post(SyncDisksCache{});
          return 0;
      }});
 
@@ -32,6 +32,7 @@ SOFTWARE.
 #include "graphics/drawing/image_loader.hpp"
 #include "graphics/video.hpp"
 #include "graphics/drawing/display_draw.hpp"
+#include "graphics/drawing/pixel_ops.hpp"
 #include "graphics/text/graphicterm.hpp"
 #include "graphics/fonts/font.hpp"
 #include "graphics/fonts/psf.hpp"
@@ -43,6 +44,7 @@ SOFTWARE.
 #include "utils/stlutils.hpp"
 #include "utils/crc32.hpp"
 #include "drivers/kbd/kbd_mappings.hpp"
+#include "i686/simd/simd.hpp"
 
 void console_perf_test()
 {
@@ -104,9 +106,11 @@ void install_gfx_commands(Shell &sh)
 
          img->resize(graphics::screen()->width(), graphics::screen()->height());
 
+         // graphics::screen() is the terminal's back buffer, don't draw the image into it
+         graphics::Screen image_screen(graphics::screen()->width(), graphics::screen()->height());
          term().disable();
-         graphics::screen()->blit(*img, {0, 0});
-         graphics::draw_to_display(*graphics::screen());
+         image_screen.blit(*img, {0, 0});
+         graphics::draw_to_display(image_screen);
 
          volatile bool escape { false };
 
@@ -125,7 +129,7 @@ void install_gfx_commands(Shell &sh)
 
          kmsgbus.remove_handler(handl);
 
-         graphics::clear_display(graphics::color_black);
+         graphics::draw_to_display(*graphics::screen());
 
          term().enable();
          //term().force_redraw();
@@ -231,6 +235,7 @@ void install_gfx_commands(Shell &sh)
          kprintf("---- clocks per 32 pixels : %llu\n", delta*32/(graphics::current_video_mode().height*
          graphics::current_video_mode().bytes_per_line));
 
+         graphics::draw_to_display(*graphics::screen());
          term().enable();
          term().force_redraw();
          return 0;
@@ -243,14 +248,128 @@ void install_gfx_commands(Shell &sh)
      {
          const size_t iters = 1024;
 
+         const size_t start_bytes = graphics::display_bytes_written();
          uint64_t start_ticks = Time::total_ticks();
          for (size_t i { 0 }; i < iters; ++i)
          {
              kprintf("Line %d\n", i);
          }
          uint64_t delta = (Time::total_ticks() - start_ticks) / iters;
+         const size_t bytes = (graphics::display_bytes_written() - start_bytes) / iters;
 
          kprintf("---- clocks per line : %llu\n", delta);
+         kprintf("---- framebuffer bytes flushed per line : %d (full frame : %d)\n", bytes,
+                 graphics::current_video_mode().height*graphics::current_video_mode().bytes_per_line);
+
+         return 0;
+     }});
+
+    sh.register_command(
+    {"pixelbench", "Benchmarks the pixel kernels on a 1024x768 image",
+     "Usage : 'pixelbench [iterations]'",
+     [](const std::vector<kpp::string>& args)
+     {
+         size_t iters = 16;
+         if (args.size() >= 1)
+         {
+             iters = std::max<size_t>(1, kpp::stoul(args[0]));
+         }
+
+         constexpr size_t width = 1024;
+         constexpr size_t height = 768;
+         constexpr size_t count = width*height;
+
+         std::vector<uint8_t> rgba(count*4);
+         uint32_t seed = 0x12345678;
+         for (auto& byte : rgba)
+         {
+             seed = seed*1103515245 + 12345;
+             byte = seed >> 16;
+         }
+
+         // premultiplied source with some fully transparent and white pixels
+         graphics::Bitmap src(width, height);
+         for (size_t i { 0 }; i < count; ++i)
+         {
+             auto& pix = src.data()[i];
+             pix = graphics::Color(rgba[i*4], rgba[i*4+1], rgba[i*4+2], rgba[i*4+3]);
+             pix.r = pix.r * pix.a / 255; pix.g = pix.g * pix.a / 255; pix.b = pix.b * pix.a / 255;
+             if (i % 13 == 0) pix = graphics::color_white;
+             if (i % 7 == 0) pix.a = 0;
+         }
+
+         graphics::Bitmap reference(width, height);
+         graphics::Bitmap dst(width, height);
+
+         // clocks per 100 pixels of one call of 'op' on the whole image
+         auto measure = [&](auto op)
+         {
+             uint64_t start = Time::total_ticks();
+             for (size_t i { 0 }; i < iters; ++i)
+             {
+                 op();
+             }
+             return (Time::total_ticks() - start) * 100 / (iters*count);
+         };
+
+         // the column-major conversion image_loader used to do
+         const uint64_t legacy = measure([&]
+         {
+             memcpyl(dst.data(), rgba.data(), count*4);
+             for (size_t i { 0 }; i < width; ++i)
+             {
+                 for (size_t j { 0 }; j < height; ++j)
+                 {
+                     dst[{i, j}] = graphics::Color(dst[{i, j}].b, dst[{i, j}].g, dst[{i, j}].r, dst[{i, j}].a);
+                 }
+             }
+         });
+         kprintf("legacy image conversion : %d.%02d clocks/pixel\n", (int)legacy/100, (int)legacy%100);
+
+         kprintf("%-8s %10s %10s %10s %10s %10s   (clocks/pixel)\n", "kernels", "convert", "fill", "multiply",
+                 "blend", "color key");
+
+         const uint16_t feature_sets[] = {0, SSE2, SSE2|SSSE3};
+         for (auto features : feature_sets)
+         {
+             if ((simd_features() & features) != features) continue;
+
+             const auto& k = graphics::pixel_kernels(features);
+             const auto& ref = graphics::pixel_kernels(0);
+             const graphics::Color tint(200, 150, 100);
+             const graphics::Color white(10, 20, 30);
+             const graphics::Color transparent(40, 50, 60);
+             bool mismatch = false;
+             auto check = [&]
+             {
+                 if (memcmp(dst.data(), reference.data(), count*sizeof(graphics::Color)) != 0) mismatch = true;
+             };
+
+             uint64_t results[5];
+             results[0] = measure([&]{ k.rgba_to_color(dst.data(), rgba.data(), count); });
+             ref.rgba_to_color(reference.data(), rgba.data(), count); check();
+
+             results[1] = measure([&]{ k.fill(dst.data(), count, tint); });
+             ref.fill(reference.data(), count, tint); check();
+
+             results[2] = measure([&]{ k.multiply(dst.data(), count, tint); });
+             k.rgba_to_color(dst.data(), rgba.data(), count); k.multiply(dst.data(), count, tint);
+             ref.rgba_to_color(reference.data(), rgba.data(), count); ref.multiply(reference.data(), count, tint); check();
+
+             results[3] = measure([&]{ k.blend(dst.data(), src.data(), count); });
+             k.rgba_to_color(dst.data(), rgba.data(), count); k.blend(dst.data(), src.data(), count);
+             ref.rgba_to_color(reference.data(), rgba.data(), count); ref.blend(reference.data(), src.data(), count); check();
+
+             results[4] = measure([&]{ k.color_key(dst.data(), src.data(), count, white, &transparent); });
+             ref.color_key(reference.data(), src.data(), count, white, &transparent); check();
+
+             kprintf("%-8s", k.name);
+             for (auto result : results)
+             {
+                 kprintf(" %7d.%02d", (int)result/100, (int)result%100);
+             }
+             kprintf("%s\n", mismatch ? "   MISMATCH" : "");
+         }
 
          return 0;
      }});
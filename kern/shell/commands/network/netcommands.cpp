@@ -29,7 +29,91 @@ SOFTWARE.
 
 #include "drivers/network/driver.hpp"
 
+#include "tasking/atomic.hpp"
+#include "time/time.hpp"
+#include "time/timer.hpp"
 #include "utils/logging.hpp"
+#include "utils/kmsgbus.hpp"
+#include "utils/stlutils.hpp"
+
+#include <string.h>
+
+namespace
+{
+kpp::optional<kpp::array<uint8_t, 4>> parse_ipv4(const kpp::string& str)
+{
+    auto parts = tokenize(str, ".");
+    if (parts.size() != 4) return {};
+
+    kpp::array<uint8_t, 4> ip;
+    for (size_t i { 0 }; i < 4; ++i)
+    {
+        ip[i] = kpp::stoul(kpp::string(parts[i]));
+    }
+
+    return ip;
+}
+
+// ARP reply awaited by 'arping' ; the received frames are posted from the softirq, so the subscription is made
+// once and kept, unsubscribing could race with a post
+struct ArpWait
+{
+    kpp::array<uint8_t, 4> target;
+    kpp::array<uint8_t, 6> reply_mac;
+    bool waiting { false };
+    bool replied { false };
+} arp_wait;
+
+bool watch_arp_replies()
+{
+    static bool subscribed { false };
+    if (subscribed) return true;
+
+    subscribed = kmsgbus.subscribe<PacketReceived>([](const PacketReceived& msg)
+    {
+        if (!atomic_load(&arp_wait.waiting)) return;
+
+        const uint8_t* frame = msg.packet->data();
+        if (msg.packet->size() < 14 + 28 || frame[12] != 0x08 || frame[13] != 0x06) return;
+
+        const uint8_t* arp = frame + 14;
+        if (arp[7] == 0x02 && memcmp(arp + 14, arp_wait.target.data(), 4) == 0) // reply from the target
+        {
+            memcpy(arp_wait.reply_mac.data(), arp + 8, 6);
+            atomic_store(&arp_wait.replied, true);
+        }
+    }).has_value();
+
+    return subscribed;
+}
+
+// Ethernet broadcast ARP request asking for 'target', from 'source'
+net::PacketRef make_arp_request(const kpp::array<uint8_t, 6>& mac, const kpp::array<uint8_t, 4>& source,
+                                const kpp::array<uint8_t, 4>& target)
+{
+    auto packet = net::PacketPool::kernel().allocate();
+    if (!packet) return {};
+
+    uint8_t* frame = packet->data();
+    memset(frame, 0xFF, 6);              // broadcast destination
+    memcpy(frame + 6, mac.data(), 6);
+    frame[12] = 0x08; frame[13] = 0x06;  // ARP
+
+    uint8_t* arp = frame + 14;
+    arp[0] = 0x00; arp[1] = 0x01;        // Ethernet
+    arp[2] = 0x08; arp[3] = 0x00;        // IPv4
+    arp[4] = 6; arp[5] = 4;
+    arp[6] = 0x00; arp[7] = 0x01;        // request
+    memcpy(arp + 8, mac.data(), 6);
+    memcpy(arp + 14, source.data(), 4);
+    memset(arp + 18, 0, 6);
+    memcpy(arp + 24, target.data(), 4);
+
+    packet->resize(14 + 28);
+
+    return packet;
+}
+}
 
 void install_net_commands(Shell &sh)
 {
@@ -51,4 +135,91 @@ void install_net_commands(Shell &sh)
 
          return 0;
      }});
+
+    sh.register_command(
+    {"netstat", "Show network interface statistics",
+     "Usage : 'netstat'",
+     [](const std::vector<kpp::string>&)
+     {
+         auto result = NetworkDriver::get();
+         if (!result)
+         {
+             err("Network error : %s\n", result.error().to_string().c_str());
+             return -1;
+         }
+
+         const auto& stats = result.value().get().stats();
+         kprintf("RX : %d packets, %d bytes, %d dropped, %d errors\n", stats.rx_packets, stats.rx_bytes, stats.rx_dropped, stats.rx_errors);
+         kprintf("TX : %d packets, %d bytes, %d errors\n", stats.tx_packets, stats.tx_bytes, stats.tx_errors);
+         kprintf("Packet buffers : %d/%d free\n", net::PacketPool::kernel().available(), net::PacketPool::kernel().size());
+
+         return 0;
+     }});
+
+    sh.register_command(
+    {"arping", "Send an ARP request and wait for the reply",
+     "Usage : 'arping <target ip> [source ip]' (QEMU user networking : 'arping 10.0.2.2 10.0.2.15')",
+     [](const std::vector<kpp::string>& args)
+     {
+         if (args.empty())
+         {
+             err("Missing target address\n");
+             return -1;
+         }
+
+         auto target = parse_ipv4(args[0]);
+         auto source = parse_ipv4(args.size() >= 2 ? args[1] : "0.0.0.0");
+         if (!target || !source)
+         {
+             err("Invalid IPv4 address\n");
+             return -1;
+         }
+
+         auto result = NetworkDriver::get();
+         if (!result)
+         {
+             err("Network error : %s\n", result.error().to_string().c_str());
+             return -1;
+         }
+         NetworkDriver& nic = result.value().get();
+
+         if (!watch_arp_replies())
+         {
+             err("Cannot subscribe to the received packets\n");
+             return -1;
+         }
+         arp_wait.target = *target;
+         atomic_store(&arp_wait.replied, false);
+         atomic_store(&arp_wait.waiting, true);
+
+         auto packet = make_arp_request(nic.mac_address(), *source, *target);
+         if (!packet)
+         {
+             atomic_store(&arp_wait.waiting, false);
+             err("No packet buffer available\n");
+             return -1;
+         }
+
+         const uint64_t start = Time::uptime_us();
+         if (auto sent = nic.send(std::move(packet)); !sent)
+         {
+             atomic_store(&arp_wait.waiting, false);
+             err("Network error : %s\n", sent.error().to_string().c_str());
+             return -1;
+         }
+
+         const bool replied = Timer::sleep_until([]{ return atomic_load(&arp_wait.replied); }, 1000);
+         atomic_store(&arp_wait.waiting, false);
+         if (!replied)
+         {
+             kprintf("No reply from %s\n", args[0].c_str());
+             return -1;
+         }
+
+         const auto& mac = arp_wait.reply_mac;
+         kprintf("Reply from %s : %02x:%02x:%02x:%02x:%02x:%02x in %d us\n", args[0].c_str(),
+                 mac[0], mac[1], mac[2], mac[3], mac[4], mac[5],
+                 (int)(Time::uptime_us() - start));
+         return 0;
+     }});
 }
@@ -36,9 +36,14 @@ SOFTWARE.
 #include "mem/memmap.hpp"
 #include "power/powermanagement.hpp"
 #include "time/time.hpp"
+#include "time/timer.hpp"
 #include "drivers/pci/pci.hpp"
 #include "drivers/pci/pci_vendors.hpp"
+#include "drivers/pci/msi.hpp"
 #include "drivers/driver.hpp"
+#include "debug/profiler.hpp"
+#include "debug/bench.hpp"
+#include "i686/cpu/memops.hpp"
 
 void install_sys_commands(Shell &sh)
 {
@@ -62,6 +67,150 @@ void install_sys_commands(Shell &sh)
      [](const std::vector<kpp::string>&)
      {
          liballoc_dump();
+         liballoc_cache_dump();
+         return 0;
+     }});
+
+    sh.register_command(
+    {"heapbench", "Kernel heap stress benchmark",
+     "Usage : 'heapbench [rounds]'",
+     [](const std::vector<kpp::string>& args)
+     {
+         size_t rounds = 200;
+         if (args.size() >= 1)
+         {
+             rounds = std::max<size_t>(1, kpp::stoul(args[0]));
+         }
+         constexpr size_t batch = 64;
+         const size_t sizes[] = {16, 48, 200, 1024, 2048, 4096, 32768};
+
+         const uint64_t tick_period = Time::clock_speed()*1'000'000 / Timer::freq();
+         auto to_ns = [](uint64_t ticks) { return ticks*1000 / Time::clock_speed(); };
+
+         void* ptrs[batch];
+         liballoc_longest_lock(true);
+
+         // the timer callback compares the time it runs at with the time it was due ; its 1 ms period is shorter
+         // than a periodic tick, so without a one-shot timer it runs on every tick and is due one tick later
+         const uint64_t callback_interval = Timer::tickless() ? Time::ns_to_ticks(1'000'000) : tick_period;
+         static uint64_t last_fire;
+         static uint64_t worst_irq_delay;
+         last_fire = Time::total_ticks();
+         worst_irq_delay = 0;
+         auto delay_probe = Timer::register_callback(1, [callback_interval]
+         {
+             const uint64_t now = Time::total_ticks();
+             if (now > last_fire + callback_interval)
+             {
+                 worst_irq_delay = std::max(worst_irq_delay, now - last_fire - callback_interval);
+             }
+             last_fire = now;
+         }, false);
+
+         kprintf("%-8s %12s %12s %12s\n", "size", "avg malloc", "max malloc", "avg free");
+         for (size_t size : sizes)
+         {
+             uint64_t alloc_total = 0, alloc_max = 0, free_total = 0;
+
+             for (size_t round { 0 }; round < rounds; ++round)
+             {
+                 for (size_t i { 0 }; i < batch; ++i)
+                 {
+                     uint64_t start = Time::total_ticks();
+                     ptrs[i] = kmalloc(size);
+                     uint64_t duration = Time::total_ticks() - start;
+                     alloc_total += duration;
+                     alloc_max = std::max(alloc_max, duration);
+                 }
+                 // free in a different order than the allocations to mix the free lists
+                 for (size_t i { 0 }; i < batch; ++i)
+                 {
+                     uint64_t start = Time::total_ticks();
+                     kfree(ptrs[(i * 7) % batch]);
+                     free_total += Time::total_ticks() - start;
+                 }
+             }
+
+             const size_t count = rounds*batch;
+             kprintf("%-8d %9d ns %9d ns %9d ns\n", size, (int)to_ns(alloc_total/count), (int)to_ns(alloc_max),
+                     (int)to_ns(free_total/count));
+         }
+
+         Timer::remove_callback(delay_probe);
+
+         kprintf("Longest interrupts-off section in the heap : %d ns\n", (int)to_ns(liballoc_longest_lock(false)));
+         kprintf("Worst timer IRQ delay observed : %d ns\n", (int)to_ns(worst_irq_delay));
+         return 0;
+     }});
+
+    sh.register_command(
+    {"profile", "Kernel sampling profiler",
+     "Usage : 'profile start [hz]|stop|status', reports are in /proc/profile and /proc/profile_folded",
+     [](const std::vector<kpp::string>& args)
+     {
+         if (args.size() >= 1 && args[0] == "start")
+         {
+             const uint32_t hz = args.size() >= 2 ? kpp::stoul(args[1]) : 1000;
+             const uint32_t rate = profiler::start(hz);
+             if (rate != hz)
+             {
+                 warn("The timer can't sample at %d Hz\n", hz);
+             }
+             kprintf("Profiling at %d Hz\n", rate);
+         }
+         else if (args.size() >= 1 && args[0] == "stop")
+         {
+             profiler::stop();
+         }
+         else if (args.size() >= 1 && args[0] == "status")
+         {
+             kprintf("Profiler is %s\n", profiler::running() ? "running" : "stopped");
+         }
+         else
+         {
+             kprintf("Usage : 'profile start [hz]|stop|status'\n");
+             return -1;
+         }
+         return 0;
+     }});
+
+    sh.register_command(
+    {"bench", "Run the kernel microbenchmarks",
+     "Usage : 'bench [filter] [iterations]', the last results are in /proc/bench",
+     [](const std::vector<kpp::string>& args)
+     {
+         const kpp::string filter = args.size() >= 1 && args[0] != "all" ? args[0] : "";
+         const size_t iterations = args.size() >= 2 ? kpp::stoul(args[1]) : bench::default_iterations;
+
+         const auto results = bench::run(filter, iterations);
+         if (results.empty())
+         {
+             kprintf("No benchmark matches '%s'\n", filter.c_str());
+             return -1;
+         }
+
+         kprintf("TSC cycles per iteration, %d MHz\n", (int)Time::clock_speed());
+         kprintf("%s", bench::format_header().c_str());
+         for (const auto& result : results)
+         {
+             kprintf("%s", bench::format(result).c_str());
+         }
+         return 0;
+     }});
+
+    sh.register_command(
+    {"memtest", "Check the memcpy/memset variants against the naive ones",
+     "Usage : 'memtest'",
+     [](const std::vector<kpp::string>&)
+     {
+         const size_t failures = memops::self_test();
+         if (failures)
+         {
+             kprintf("%d variant(s) failed, see the log\n", (int)failures);
+             return -1;
+         }
+
+         kprintf("All the variants supported by this CPU are correct\n");
          return 0;
      }});
 
@@ -98,7 +247,8 @@ void install_sys_commands(Shell &sh)
      "Usage : 'uptime'",
      [](const std::vector<kpp::string>&)
      {
-         kprintf("Uptime : %f sec\n", Time::uptime());
+         const uint64_t us = Time::uptime_us();
+         kprintf("Uptime : %lu.%06lu sec\n", (unsigned long)(us / 1'000'000), (unsigned long)(us % 1'000'000));
          return 0;
      }});
 
@@ -114,6 +264,10 @@ void install_sys_commands(Shell &sh)
              kprintf("   Device : '%s' (0x%x)\n", pci::dev_string(dev.vendorID, dev.deviceID).c_str(), dev.deviceID);
              kprintf("   Class : '%s' (0x%x:0x%x:0x%x)\n", pci::class_code_string(dev.classCode, dev.subclass, dev.progIF).c_str(),
                                                            dev.classCode, dev.subclass, dev.progIF);
+             if (pci::has_msi(dev))
+             {
+                 kprintf("   Capabilities : MSI\n");
+             }
          }
          return 0;
      }});  
@@ -34,6 +34,7 @@ SOFTWARE.
 #include "tasking/process_data.hpp"
 #include "tasking/loaders/process_loader.hpp"
 #include "tasking/scheduler.hpp"
+#include "time/time.hpp"
 
 #include <sys/wait.h>
 
@@ -58,13 +59,7 @@ void install_task_commands(Shell &sh)
              return -2;
          }
 
-         auto result = node->read();
-         if (!result)
-         {
-             sh.error("Can't read file %s : %s\n", args[0].c_str(), result.error().to_string());
-             return -5;
-         }
-         auto loader = ProcessLoader::get(result.value());
+         auto loader = ProcessLoader::get(node);
          if (!loader)
          {
              sh.error("File '%s' is not in an executable format\n", args[0].c_str());
@@ -115,8 +110,10 @@ void install_task_commands(Shell &sh)
          for (auto pid : Process::process_list())
          {
              auto proc = Process::by_pid(pid);
-             kprintf("Process '%s' : PID %d, parent %d, status %d\n", proc->data->name.c_str(), pid, proc->parent, proc->status);
+             kprintf("Process '%s' : PID %d, parent %d, status %d, cpu time %lld ms\n", proc->data->name.c_str(), pid,
+                     proc->parent, proc->status, proc->cpu_ticks() / (Time::clock_speed()*1000));
          }
+         kprintf("Halted while idle : %lld ms\n", tasking::halted_ticks / (Time::clock_speed()*1000));
 
          return 0;
      }});
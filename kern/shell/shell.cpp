@@ -28,6 +28,7 @@ SOFTWARE.
 #include <stdio.h>
 
 #include "utils/kmsgbus.hpp"
+#include "tasking/scheduler.hpp"
 
 #include "terminal/terminal.hpp"
 
@@ -178,6 +179,7 @@ kpp::string Shell::read_input()
     term().set_accept_input(true);
     while (m_waiting_input)
     {
+        tasking::schedule(); // let the kernel tasks run while waiting
         wait_for_interrupts();
     }
     term().set_accept_input(false);
@@ -53,12 +53,13 @@ static int chdir_impl(const std::shared_ptr<vfs::node>& node)
 
 int sys_chdir(user_ptr<const char> path)
 {
-    if (!path.check())
+    auto path_str = path.str();
+    if (!path_str)
     {
-        return -EFAULT;
+        return -path_str.error();
     }
 
-    auto result = vfs::user_find(path.get());
+    auto result = vfs::user_find(*path_str);
     if (result.target_node == nullptr)
     {
         return -result.error;
@@ -33,12 +33,13 @@ SOFTWARE.
 
 int sys_chroot(user_ptr<const char> path)
 {
-    if (!path.check())
+    auto path_str = path.str();
+    if (!path_str)
     {
-        return -EFAULT;
+        return -path_str.error();
     }
 
-    auto result = vfs::user_find(path.get());
+    auto result = vfs::user_find(*path_str);
     if (result.target_node == nullptr)
     {
         return -result.error;
@@ -34,11 +34,6 @@ SOFTWARE.
 
 int sys_getcwd(user_ptr<char> buf, unsigned long size)
 {
-    if (!buf.check())
-    {
-        return -EFAULT;
-    }
-
     if (size == 0)
     {
         return -EINVAL;
@@ -51,8 +46,10 @@ int sys_getcwd(user_ptr<char> buf, unsigned long size)
         return -ERANGE;
     }
 
-    std::copy(pwd.begin(), pwd.end(), buf.get());
-    buf.get()[pwd.size()] = '\0';
+    if (copy_to_user((void*)buf.as_raw(), pwd.c_str(), pwd.size() + 1) < 0)
+    {
+        return -EFAULT;
+    }
 
     return EOK;
 }
@@ -38,12 +38,13 @@ SOFTWARE.
 
 int sys_open(user_ptr<const char> path, int flags, int mode)
 {
-    if (!path.check())
+    auto path_str = path.str();
+    if (!path_str)
     {
-        return -EFAULT;
+        return -path_str.error();
     }
 
-    auto result = vfs::user_find(path.get());
+    auto result = vfs::user_find(*path_str);
     if (result.target_node == nullptr)
     {
         return -result.error;
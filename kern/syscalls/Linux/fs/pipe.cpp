@@ -34,7 +34,7 @@ SOFTWARE.
 
 int sys_pipe(user_ptr<int> fd)
 {
-    if (!fd.check())
+    if (!access_ok((void*)fd.as_raw(), 2*sizeof(int)))
     {
         return -EFAULT;
     }
@@ -46,8 +46,16 @@ int sys_pipe(user_ptr<int> fd)
     fd1.read  = true ; fd2.read  = false;
     fd1.write = false; fd2.write = true ;
 
-    fd.get()[0] = Process::current().add_fd(fd1);
-    fd.get()[1] = Process::current().add_fd(fd2);
+    int fds[2];
+    fds[0] = Process::current().add_fd(fd1);
+    fds[1] = Process::current().add_fd(fd2);
+
+    if (copy_to_user((void*)fd.as_raw(), fds, sizeof(fds)) < 0)
+    {
+        Process::current().close_fd(fds[0]);
+        Process::current().close_fd(fds[1]);
+        return -EFAULT;
+    }
 
     return EOK;
 }
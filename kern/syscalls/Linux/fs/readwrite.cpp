@@ -30,73 +30,296 @@ SOFTWARE.
 #include "errno.h"
 #include "drivers/storage/disk.hpp"
 #include "utils/user_ptr.hpp"
+#include "utils/membuffer.hpp"
 
 #include "fs/vfs.hpp"
+#include "fs/pipe.hpp"
 
-size_t sys_read(unsigned int fd, user_ptr<void> buf, size_t count)
+#include <sys/uio.h>
+
+#include <algorithm.hpp>
+
+// the vfs nodes must not fault on user memory, the data goes through a page-sized kernel buffer
+static constexpr size_t bounce_size = 0x1000;
+
+static size_t read_to_user(const vfs::node& node, size_t offset, uintptr_t buf, size_t count, MemBuffer& bounce)
 {
-    if (!buf.check())
+    if (node.size() && offset + count > node.size())
     {
-        return -EFAULT;
+        return -EIO;
+    }
+
+    bounce.resize(bounce_size);
+
+    size_t done = 0;
+    while (done < count)
+    {
+        const size_t chunk = std::min(count - done, bounce_size);
+        auto result = node.read(offset + done, {bounce.data(), chunk});
+        if (!result)
+        {
+            return done ? done : -result.error().to_errno();
+        }
+
+        if (copy_to_user((void*)(buf + done), bounce.data(), *result) < 0)
+        {
+            return -EFAULT;
+        }
+        done += *result;
+
+        // pipes and terminals (which have no size) return what they have, reading more could block
+        if (*result < chunk || node.size() == 0)
+        {
+            break;
+        }
+    }
+
+    return done; // again, to allow errno numbers
+}
+
+static size_t write_from_user(vfs::node& node, size_t offset, uintptr_t buf, size_t count, MemBuffer& bounce)
+{
+    if (node.size() && offset + count >= node.size())
+    {
+        return -EIO;
     }
 
+    bounce.resize(bounce_size);
+
+    // pipe writes must stay under the pipe buffer size
+    const size_t max_chunk = node.type() == vfs::node::FIFO ? vfs::pipe::pipe_buf_size / 2 : bounce_size;
+
+    size_t done = 0;
+    while (done < count)
+    {
+        const size_t chunk = std::min(count - done, max_chunk);
+        if (copy_from_user(bounce.data(), (const void*)(buf + done), chunk) < 0)
+        {
+            return -EFAULT;
+        }
+
+        auto result = node.write(offset + done, {bounce.data(), (gsl::span<uint8_t>::index_type)(chunk)});
+        if (!result)
+        {
+            return done ? done : -result.error().to_errno();
+        }
+        done += chunk;
+    }
+
+    return count; // again, to allow errno numbers
+}
+
+// returns the node behind 'fd' if it can be read (or written), sets 'error' otherwise
+static std::shared_ptr<vfs::node> io_node(unsigned int fd, bool write, size_t& error)
+{
     auto fd_entry = Process::current().get_fd(fd);
-    if (!fd_entry || !fd_entry->read)
+    if (!fd_entry || !(write ? fd_entry->write : fd_entry->read))
     {
-        return -EBADFD;
+        error = -EBADFD;
+        return nullptr;
     }
 
-    auto node = fd_entry->node;
-    if (node->type() == vfs::node::Directory)
+    if (fd_entry->node->type() == vfs::node::Directory)
     {
-        return -EISDIR;
+        error = write ? -EINVAL : -EISDIR;
+        return nullptr;
     }
 
-    if (node->size() && fd_entry->cursor + count > node->size())
+    return fd_entry->node;
+}
+
+// copies the iovec array and checks the segments, returns 0 or an errno value
+static size_t fetch_iovecs(user_ptr<const struct iovec> iov, int iovcnt, std::vector<iovec>& vecs)
+{
+    if (iovcnt < 0 || iovcnt > IOV_MAX)
     {
-        return -EIO;
+        return -EINVAL;
+    }
+
+    vecs.resize(iovcnt);
+    if (copy_from_user(vecs.data(), (const void*)iov.as_raw(), iovcnt*sizeof(iovec)) < 0)
+    {
+        return -EFAULT;
     }
 
-    auto result = node->read(fd_entry->cursor, {(uint8_t*)buf.get(), count});
-    if (!result)
+    size_t total = 0;
+    for (const auto& vec : vecs)
     {
-        return -result.error().to_errno();
+        if (total + vec.iov_len < total || (int)(total + vec.iov_len) < 0)
+        {
+            return -EINVAL; // the total must fit in the return value
+        }
+        total += vec.iov_len;
+
+        if (!access_ok(vec.iov_base, vec.iov_len))
+        {
+            return -EFAULT;
+        }
     }
 
-    return *result; // again, to allow errno numbers
+    return 0;
+}
+
+size_t sys_read(unsigned int fd, user_ptr<void> buf, size_t count)
+{
+    if (!access_ok((void*)buf.as_raw(), count))
+    {
+        return -EFAULT;
+    }
+
+    size_t error = 0;
+    auto node = io_node(fd, false, error);
+    if (!node)
+    {
+        return error;
+    }
+
+    MemBuffer bounce;
+    return read_to_user(*node, Process::current().get_fd(fd)->cursor, buf.as_raw(), count, bounce);
 }
 
 size_t sys_write(unsigned int fd, user_ptr<const void> buf, size_t count)
 {
+    if (!access_ok((const void*)buf.as_raw(), count))
+    {
+        return -EFAULT;
+    }
+
+    size_t error = 0;
+    auto node = io_node(fd, true, error);
+    if (!node)
+    {
+        return error;
+    }
+
+    MemBuffer bounce;
+    return write_from_user(*node, Process::current().get_fd(fd)->cursor, buf.as_raw(), count, bounce);
+}
+
+// like read() and write(), the vectored and positioned versions leave the file cursor alone
+size_t sys_readv(unsigned int fd, user_ptr<const struct iovec> iov, int iovcnt)
+{
+    size_t error = 0;
+    auto node = io_node(fd, false, error);
+    if (!node)
+    {
+        return error;
+    }
+
+    std::vector<iovec> vecs;
+    if (size_t result = fetch_iovecs(iov, iovcnt, vecs); result != 0)
+    {
+        return result;
+    }
+
+    // the segments are filled one after the other, reusing the same kernel buffer
+    size_t offset = Process::current().get_fd(fd)->cursor;
+    size_t total = 0;
+    MemBuffer bounce;
+    for (const auto& vec : vecs)
+    {
+        const size_t result = read_to_user(*node, offset, (uintptr_t)vec.iov_base, vec.iov_len, bounce);
+        if ((int)result < 0)
+        {
+            return total ? total : result;
+        }
+
+        offset += result;
+        total += result;
+
+        if (result < vec.iov_len)
+        {
+            break; // short read, the next segments could block
+        }
+    }
+
+    return total;
+}
+
+size_t sys_writev(unsigned int fd, user_ptr<const struct iovec> iov, int iovcnt)
+{
+    size_t error = 0;
+    auto node = io_node(fd, true, error);
+    if (!node)
+    {
+        return error;
+    }
 
-    if (!buf.check())
+    std::vector<iovec> vecs;
+    if (size_t result = fetch_iovecs(iov, iovcnt, vecs); result != 0)
+    {
+        return result;
+    }
+
+    size_t offset = Process::current().get_fd(fd)->cursor;
+    size_t total = 0;
+    MemBuffer bounce;
+    for (const auto& vec : vecs)
+    {
+        const size_t result = write_from_user(*node, offset, (uintptr_t)vec.iov_base, vec.iov_len, bounce);
+        if ((int)result < 0)
+        {
+            return total ? total : result;
+        }
+
+        offset += result;
+        total += result;
+    }
+
+    return total;
+}
+
+size_t sys_pread64(unsigned int fd, user_ptr<void> buf, size_t count, uint32_t pos_lo, uint32_t pos_hi)
+{
+    if (!access_ok((void*)buf.as_raw(), count))
     {
         return -EFAULT;
     }
 
-    auto fd_entry = Process::current().get_fd(fd);
-    if (!fd_entry || !fd_entry->write)
+    size_t error = 0;
+    auto node = io_node(fd, false, error);
+    if (!node)
     {
-        return -EBADFD;
+        return error;
     }
 
-    auto node = fd_entry->node;
-    if (node->type() == vfs::node::Directory)
+    // only files have positions, and they don't go past 4GiB here
+    if (node->type() == vfs::node::FIFO)
+    {
+        return -ESPIPE;
+    }
+    if (pos_hi != 0 || (int)pos_lo < 0)
     {
         return -EINVAL;
     }
 
-    if (node->size() && fd_entry->cursor + count >= node->size())
+    MemBuffer bounce;
+    return read_to_user(*node, pos_lo, buf.as_raw(), count, bounce);
+}
+
+size_t sys_pwrite64(unsigned int fd, user_ptr<const void> buf, size_t count, uint32_t pos_lo, uint32_t pos_hi)
+{
+    if (!access_ok((const void*)buf.as_raw(), count))
     {
-        return -EIO;
+        return -EFAULT;
     }
 
-    auto result = node->write(fd_entry->cursor, {(uint8_t*)buf.get(), (gsl::span<uint8_t>::index_type)(count)});
-    if (!result)
+    size_t error = 0;
+    auto node = io_node(fd, true, error);
+    if (!node)
     {
-        return -result.error().to_errno();
+        return error;
     }
 
-    return count; // again, to allow errno numbers
-}
+    if (node->type() == vfs::node::FIFO)
+    {
+        return -ESPIPE;
+    }
+    if (pos_hi != 0 || (int)pos_lo < 0)
+    {
+        return -EINVAL;
+    }
 
+    MemBuffer bounce;
+    return write_from_user(*node, pos_lo, buf.as_raw(), count, bounce);
+}
@@ -0,0 +1,200 @@
+/*
+sendfile.cpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "syscalls/Linux/syscalls.hpp"
+
+#include <algorithm.hpp>
+
+#include "tasking/process.hpp"
+#include "errno.h"
+#include "utils/user_ptr.hpp"
+#include "utils/membuffer.hpp"
+
+#include "fs/vfs.hpp"
+#include "fs/pipe.hpp"
+
+// the data moves from node to node through this much kernel memory at a time, it never goes to user space
+constexpr size_t transfer_chunk { 0x4000 };
+
+static tasking::FDInfo* transfer_fd(unsigned int fd, bool write)
+{
+    auto fd_entry = Process::current().get_fd(fd);
+    if (!fd_entry || !(write ? fd_entry->write : fd_entry->read) || fd_entry->node->type() == vfs::node::Directory)
+    {
+        return nullptr;
+    }
+
+    return fd_entry;
+}
+
+// returns the bytes moved, or an errno value if nothing could be
+static size_t transfer(const vfs::node& in, size_t in_offset, vfs::node& out, size_t out_offset, size_t count)
+{
+    // pipe writes must stay under the pipe buffer size
+    const size_t chunk_size = out.type() == vfs::node::FIFO ? vfs::pipe::pipe_buf_size / 2 : transfer_chunk;
+    MemBuffer chunk(std::min(count, chunk_size));
+
+    size_t done = 0;
+    while (done < count)
+    {
+        const size_t len = std::min(count - done, chunk_size);
+        if (out.size() && out_offset + done + len > out.size())
+        {
+            return done ? done : -EIO;
+        }
+
+        auto read = in.read(in_offset + done, {chunk.data(), len});
+        if (!read || *read == 0)
+        {
+            return done ? done : (read ? 0 : -read.error().to_errno());
+        }
+
+        auto written = out.write(out_offset + done, {chunk.data(), *read});
+        if (!written)
+        {
+            return done ? done : -written.error().to_errno();
+        }
+
+        done += *read;
+    }
+
+    return done;
+}
+
+// reads the optional user offset, 'offset' keeps the file cursor otherwise ; returns 0, -EFAULT or -EINVAL
+static int read_offset(user_ptr<off_t> ptr, size_t& offset)
+{
+    if (ptr.as_raw() == 0)
+    {
+        return 0;
+    }
+
+    off_t value;
+    if (!ptr.read(value))
+    {
+        return -EFAULT;
+    }
+    if (value < 0 || (value >> 32))
+    {
+        return -EINVAL;
+    }
+
+    offset = value;
+    return 0;
+}
+
+// like read() and write(), these leave the file cursors alone : pass an offset to walk through a file
+size_t sys_sendfile(unsigned int out_fd, unsigned int in_fd, user_ptr<off_t> offset, size_t count)
+{
+    auto in = transfer_fd(in_fd, false);
+    auto out = transfer_fd(out_fd, true);
+    if (!in || !out)
+    {
+        return -EBADFD;
+    }
+
+    // the input is read at an offset, it must be a file
+    if (in->node->type() != vfs::node::File)
+    {
+        return -EINVAL;
+    }
+
+    size_t in_offset = in->cursor;
+    if (int err = read_offset(offset, in_offset))
+    {
+        return err;
+    }
+
+    const size_t in_size = in->node->size();
+    count = std::min(count, in_offset < in_size ? in_size - in_offset : 0);
+
+    const size_t result = transfer(*in->node, in_offset, *out->node, out->cursor, count);
+    if ((int)result > 0 && offset.as_raw() && !offset.write(off_t(in_offset + result)))
+    {
+        return -EFAULT;
+    }
+
+    return result;
+}
+
+size_t sys_splice(unsigned int fd_in, user_ptr<off_t> off_in, unsigned int fd_out, user_ptr<off_t> off_out, size_t len,
+                  unsigned int flags)
+{
+    (void)flags; // the moves are always done by copy, there's no page to gift
+
+    auto in = transfer_fd(fd_in, false);
+    auto out = transfer_fd(fd_out, true);
+    if (!in || !out)
+    {
+        return -EBADFD;
+    }
+
+    const bool in_pipe = in->node->type() == vfs::node::FIFO;
+    const bool out_pipe = out->node->type() == vfs::node::FIFO;
+    if (!in_pipe && !out_pipe)
+    {
+        return -EINVAL;
+    }
+    if ((in_pipe && off_in.as_raw()) || (out_pipe && off_out.as_raw()))
+    {
+        return -ESPIPE;
+    }
+
+    size_t in_offset = in->cursor;
+    size_t out_offset = out->cursor;
+    if (int err = read_offset(off_in, in_offset))
+    {
+        return err;
+    }
+    if (int err = read_offset(off_out, out_offset))
+    {
+        return err;
+    }
+
+    if (in_pipe)
+    {
+        // a pipe read waits for all the bytes asked : take what is there, or wait for a single one
+        auto& pipe = static_cast<const vfs::pipe&>(*in->node);
+        len = std::min(len, std::max<size_t>(1, pipe.available()));
+        len = std::min(len, vfs::pipe::pipe_buf_size);
+    }
+    else
+    {
+        const size_t in_size = in->node->size();
+        len = std::min(len, in_offset < in_size ? in_size - in_offset : 0);
+    }
+
+    const size_t result = transfer(*in->node, in_offset, *out->node, out_offset, len);
+    if ((int)result > 0)
+    {
+        if ((off_in.as_raw() && !off_in.write(off_t(in_offset + result))) ||
+            (off_out.as_raw() && !off_out.write(off_t(out_offset + result))))
+        {
+            return -EFAULT;
+        }
+    }
+
+    return result;
+}
@@ -36,12 +36,13 @@ SOFTWARE.
 
 int sys_stat(user_ptr<const char> path, user_ptr<struct stat> ptr)
 {
-    if (!path.check() || !ptr.check())
+    auto path_str = path.str();
+    if (!path_str)
     {
-        return -EFAULT;
+        return -path_str.error();
     }
 
-    auto result = vfs::user_find(path.get());
+    auto result = vfs::user_find(*path_str);
     if (result.target_node == nullptr)
     {
         return -result.error;
@@ -54,7 +55,8 @@ int sys_stat(user_ptr<const char> path, user_ptr<struct stat> ptr)
         return -EPERM;
     }
 
-    auto stat = ptr.get();
+    struct stat stat_buf {};
+    auto stat = &stat_buf;
     // TODO : dev/ino
     const auto* fs = result.target_node->get_fs();
     stat->st_dev = fs ? fs->fs_id : 0;
@@ -83,5 +85,10 @@ int sys_stat(user_ptr<const char> path, user_ptr<struct stat> ptr)
             stat->st_mode |= S_IFIFO;
     }
 
+    if (!ptr.write(stat_buf))
+    {
+        return -EFAULT;
+    }
+
     return EOK;
 }
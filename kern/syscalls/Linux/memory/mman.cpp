@@ -0,0 +1,188 @@
+/*
+mman.cpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include <errno.h>
+#include <sys/mman.h>
+
+#include "syscalls/Linux/syscalls.hpp"
+
+#include "tasking/process.hpp"
+#include "tasking/process_data.hpp"
+#include "fs/mapped_file.hpp"
+#include "mem/memmap.hpp"
+#include "utils/user_ptr.hpp"
+
+// checks that [addr; addr+length[ is page aligned and in user space, and returns its page count, or 0
+static size_t user_range_pages(uintptr_t addr, size_t length)
+{
+    if (length == 0 || Memory::offset(addr) != 0)
+    {
+        return 0;
+    }
+
+    const size_t pages = length / Memory::page_size() + (length%Memory::page_size()?1:0);
+    const uintptr_t end = addr + pages*Memory::page_size();
+    if (addr < USER_VIRTUAL_BASE || end > KERNEL_VIRTUAL_BASE || end < addr)
+    {
+        return 0;
+    }
+
+    return pages;
+}
+
+// common part of the two mmap system calls, 'pgoffset' is the file offset in pages
+static uintptr_t map_region(uintptr_t addr, size_t len, int prot, int flags, int fd, size_t pgoffset)
+{
+    const bool shared = flags & MAP_SHARED;
+    if (len == 0 || shared == bool(flags & MAP_PRIVATE) || (prot & ~(PROT_READ|PROT_WRITE|PROT_EXEC)))
+    {
+        return -EINVAL;
+    }
+
+    const size_t pages = len / Memory::page_size() + (len%Memory::page_size()?1:0);
+
+    // the file pages are addressed with 32-bit byte offsets
+    constexpr size_t max_file_pages = size_t(1) << (32 - 12);
+    if (!(flags & MAP_ANONYMOUS) && (pgoffset >= max_file_pages || pages > max_file_pages - pgoffset))
+    {
+        return -EOVERFLOW;
+    }
+
+    auto& process = Process::current();
+
+    uintptr_t v_addr = 0;
+    if (flags & MAP_FIXED)
+    {
+        v_addr = addr;
+        if (user_range_pages(v_addr, len) == 0)
+        {
+            return -EINVAL;
+        }
+    }
+    else if (user_range_pages(addr, len))
+    {
+        v_addr = addr; // only a hint, map_file() picks another address if the range isn't free
+    }
+
+    std::shared_ptr<vfs::mapped_file> file;
+    if (!(flags & MAP_ANONYMOUS))
+    {
+        auto fd_entry = process.get_fd(fd);
+        if (!fd_entry)
+        {
+            return -EBADF;
+        }
+        if (fd_entry->node->type() != vfs::node::File)
+        {
+            return -ENODEV;
+        }
+        if (!fd_entry->read || (shared && (prot & PROT_WRITE) && !fd_entry->write))
+        {
+            return -EACCES;
+        }
+
+        file = vfs::mapped_file::get(fd_entry->node);
+    }
+    else if (shared)
+    {
+        return -EINVAL; // shared anonymous memory goes through shmget
+    }
+
+    if (flags & MAP_FIXED)
+    {
+        // the previous mmap'ed pages of the range are replaced, once the request is known to be valid
+        process.unmap_range(v_addr, pages);
+    }
+
+    uintptr_t result = process.map_file(v_addr, pages, prot, shared, file, pgoffset);
+    if (result == 0 && v_addr != 0 && !(flags & MAP_FIXED))
+    {
+        result = process.map_file(0, pages, prot, shared, file, pgoffset);
+    }
+
+    if (result == 0)
+    {
+        return -ENOMEM;
+    }
+
+    return result;
+}
+
+// old i386 ABI : the arguments are in memory, the offset is in bytes
+uintptr_t sys_mmap(user_ptr<const struct mmap_arg_struct> args)
+{
+    mmap_arg_struct arg;
+    if (!args.read(arg))
+    {
+        return -EFAULT;
+    }
+
+    if (Memory::offset(arg.offset) != 0)
+    {
+        return -EINVAL;
+    }
+
+    return map_region(arg.addr, arg.len, arg.prot, arg.flags, arg.fd, arg.offset / Memory::page_size());
+}
+
+// the sixth argument comes in ebp, the offset is in pages
+uintptr_t sys_mmap2(user_ptr<void> addr, size_t length, int prot, int flags, int fd, uint32_t pgoffset)
+{
+    return map_region(addr.as_raw(), length, prot, flags, fd, pgoffset);
+}
+
+int sys_munmap(user_ptr<void> addr, size_t length)
+{
+    const size_t pages = user_range_pages(addr.as_raw(), length);
+    if (pages == 0)
+    {
+        return -EINVAL;
+    }
+
+    return Process::current().unmap_range(addr.as_raw(), pages);
+}
+
+int sys_mprotect(user_ptr<void> addr, size_t length, int prot)
+{
+    const size_t pages = user_range_pages(addr.as_raw(), length);
+    if (pages == 0 || (prot & ~(PROT_READ|PROT_WRITE|PROT_EXEC)))
+    {
+        return -EINVAL;
+    }
+
+    return Process::current().protect_range(addr.as_raw(), pages, prot);
+}
+
+int sys_msync(user_ptr<void> addr, size_t length, int flags)
+{
+    const size_t pages = user_range_pages(addr.as_raw(), length);
+    if (pages == 0 || (flags & ~(MS_ASYNC|MS_INVALIDATE|MS_SYNC)) || ((flags & MS_ASYNC) && (flags & MS_SYNC)))
+    {
+        return -EINVAL;
+    }
+
+    // the write back is always synchronous, and the mappings share the cache pages so there's nothing to invalidate
+    return Process::current().sync_range(addr.as_raw(), pages);
+}
@@ -46,12 +46,19 @@ extern "C" void enter_ring3(uint32_t esp, uint32_t eip, uint32_t argc, uint32_t
 // TODO : envp
 int sys_execve(user_ptr<const char> path, user_ptr<user_ptr<const char>> argv, user_ptr<user_ptr<const char>> envp)
 {
-    if (!path.check() || !argv.check() || !envp.check())
+    user_ptr<const char> first_env;
+    if (envp.as_raw() != 0 && !envp.read(first_env)) // the environment isn't passed yet, only check the array
     {
         return -EFAULT;
     }
 
-    auto res = vfs::user_find(path.get());
+    auto path_str = path.str();
+    if (!path_str)
+    {
+        return -path_str.error();
+    }
+
+    auto res = vfs::user_find(*path_str);
     if (res.target_node == nullptr)
     {
         return -ENOENT;
@@ -69,16 +76,25 @@ int sys_execve(user_ptr<const char> path, user_ptr<user_ptr<const char>> argv, u
 
     std::vector<kpp::string> args;
 
-    user_ptr<const char>* str = argv.get();
-    if (str->as_raw() != 0)
+    for (auto arg_ptr = (const user_ptr<const char>*)argv.as_raw();; ++arg_ptr)
     {
-        if (!str->check()) return -EFAULT;
-        while (str->get())
+        user_ptr<const char> arg;
+        if (copy_from_user(&arg, arg_ptr, sizeof(arg)) < 0)
+        {
+            return -EFAULT;
+        }
+        if (arg.as_raw() == 0)
         {
-            args.emplace_back(str->get());
-            str++;
-            if (!str->check()) return -EFAULT;
+            break;
         }
+
+        // the arguments have to fit in a page anyway
+        auto arg_str = arg.str(Memory::page_size());
+        if (!arg_str)
+        {
+            return arg_str.error() == ENAMETOOLONG ? -E2BIG : -arg_str.error();
+        }
+        args.emplace_back(std::move(*arg_str));
     }
 
     if (!Process::check_args_size(args))
@@ -86,32 +102,29 @@ int sys_execve(user_ptr<const char> path, user_ptr<user_ptr<const char>> argv, u
         return -E2BIG;
     }
 
-    auto result = res.target_node->read();
-    if (!result)
-    {
-        return -result.error().to_errno();
-    }
-
-    MemBuffer data = std::move(result.value());
-
-    if (data.empty())
+    if (res.target_node->size() == 0)
     {
         return -EIO;
     }
 
-    auto loader = ProcessLoader::get(data);
+    // only the headers are read here, the loader maps or reads the rest of the file
+    auto loader = ProcessLoader::get(res.target_node);
     if (!loader)
     {
         return -ENOEXEC;
     }
 
-    kpp::string proc_name = path.get();
+    kpp::string proc_name = *path_str;
 
     auto& process = Process::current();
 
-    process.data->name = filename(proc_name).to_string();
+    // the loaders check the file before replacing the current image, past that point a failure kills the process
+    if (!loader->load(process))
+    {
+        return -ENOEXEC;
+    }
 
-    loader->load(process);
+    process.data->name = filename(proc_name).to_string();
 
     process.push_args(args);
 
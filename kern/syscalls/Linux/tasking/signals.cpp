@@ -66,12 +66,13 @@ sighandler_t sys_signal(int num, user_ptr<sighandler_noptr_t> handler)
     else if (handler.as_raw() == (uintptr_t)SIG_IGN) table[num].sa_handler = (sighandler_t)SIG_ACTION_IGN;
     else
     {
+        // the handler is only ever jumped to in user mode, the kernel never reads through it : checking the range is enough
         if (!handler.check())
         {
             return (sighandler_t)-EFAULT;
         }
 
-        table[num].sa_handler = handler.get();
+        table[num].sa_handler = (sighandler_t)handler.as_raw();
     }
 
     return (sighandler_t)handler.as_raw();
@@ -84,24 +85,35 @@ int sys_sigaction(int num, user_ptr<const struct sigaction> act, user_ptr<struct
         return -EINVAL;
     }
 
-    if (!act.check() || (oldact.as_raw() != (uintptr_t)nullptr && !oldact.check()))
+    struct sigaction new_act;
+    if (!act.read(new_act))
+    {
+        return -EFAULT;
+    }
+    if (new_act.sa_handler != SIG_DFL && new_act.sa_handler != SIG_IGN &&
+        !Memory::check_user_ptr((const void*)new_act.sa_handler, sizeof(sighandler_t))) // not read, see sys_signal
     {
         return -EFAULT;
     }
 
     auto& table = *Process::current().data->sig_handlers;
-    if (act.get()->sa_handler == SIG_DFL) table[num].sa_handler = (sighandler_t)Process::default_sighandler_actions[num];
-    else if (act.get()->sa_handler == SIG_IGN) table[num].sa_handler = (sighandler_t)SIG_ACTION_IGN;
-    else
+    if (oldact.as_raw() != (uintptr_t)nullptr)
     {
-        if (!Memory::check_user_ptr((const void*)act.get()->sa_handler, sizeof(sighandler_t)))
+        // the table holds the kernel actions, report them as the user constants
+        struct sigaction old_act = table[num];
+        if ((uintptr_t)old_act.sa_handler == Process::default_sighandler_actions[num]) old_act.sa_handler = SIG_DFL;
+        else if ((uintptr_t)old_act.sa_handler == SIG_ACTION_IGN) old_act.sa_handler = SIG_IGN;
+
+        if (!oldact.write(old_act))
         {
             return -EFAULT;
         }
-
-        table[num].sa_handler = act.get()->sa_handler;
     }
 
+    if (new_act.sa_handler == SIG_DFL) table[num].sa_handler = (sighandler_t)Process::default_sighandler_actions[num];
+    else if (new_act.sa_handler == SIG_IGN) table[num].sa_handler = (sighandler_t)SIG_ACTION_IGN;
+    else table[num].sa_handler = new_act.sa_handler;
+
     return EOK;
 }
 
@@ -33,7 +33,9 @@ SOFTWARE.
 
 pid_t sys_waitpid(pid_t pid, user_ptr<int> wstatus, int options)
 {
-    if (!wstatus.check()) return -EFAULT;
+    // the status is written when the child exits, through the physical address of wstatus : touch the page now
+    // so that it is present and private to the process
+    if (!wstatus.write(0)) return -EFAULT;
 
     if (pid == -1) // wait on all children
     {
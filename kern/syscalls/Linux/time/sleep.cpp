@@ -32,26 +32,24 @@ SOFTWARE.
 
 int sys_nanosleep(user_ptr<const struct timespec> req, user_ptr<struct timespec> rem)
 {
-    if (!req.check())
+    struct timespec duration;
+    if (!req.read(duration))
     {
         return -EFAULT;
     }
-    if (rem.as_raw() != 0 && !rem.check())
+    if (rem.as_raw() != 0 && !access_ok((void*)rem.as_raw(), sizeof(struct timespec)))
     {
         return -EFAULT;
     }
 
-    if (req.get()->tv_nsec < 0 || req.get()->tv_nsec > 999999999 || req.get()->tv_sec < 0)
+    if (duration.tv_nsec < 0 || duration.tv_nsec > 999999999 || duration.tv_sec < 0)
     {
         return -EINVAL;
     }
 
-    Process::current().status = Process::Sleeping;
-    uint64_t ticks = (req.get()->tv_nsec/1000) * Time::clock_speed() + (req.get()->tv_sec * (Time::clock_speed()*1'000'000));
+    uint64_t ticks = (duration.tv_nsec/1000) * Time::clock_speed() + (duration.tv_sec * (Time::clock_speed()*1'000'000));
 
-    tasking::sleep_queue.insert(Process::current().pid, ticks);
-
-    tasking::schedule();
+    tasking::sleep(ticks);
 
     return EOK;
 }
@@ -28,37 +28,58 @@ SOFTWARE.
 #include <time.h>
 
 #include "time/time.hpp"
-#include "time/timer.hpp"
 
 #include "utils/user_ptr.hpp"
 
 time_t sys_time(user_ptr<time_t> t_loc)
 {
-    if (t_loc.as_raw() != (uintptr_t)nullptr && !t_loc.check()) return -EFAULT;
-
-    const auto epoch = Time::epoch();
-    if (t_loc.as_raw() != (uintptr_t)nullptr) *t_loc.get() = epoch;
+    const time_t epoch = Time::epoch();
+    if (t_loc.as_raw() != (uintptr_t)nullptr && !t_loc.write(epoch)) return -EFAULT;
 
     return epoch;
 }
 
 int sys_clock_gettime(clockid_t clock, user_ptr<timespec> tp)
 {
-    if (!tp.check())
-        return -EFAULT;
-
     if (clock != CLOCK_REALTIME)
         return -EINVAL;
 
-    const uint64_t ticks = Time::ticks_since_boot();
+    const uint64_t ns = Time::uptime_ns();
+
+    timespec ts;
+    ts.tv_sec = ns / 1'000'000'000;
+    ts.tv_nsec = ns % 1'000'000'000;
 
-    const uint64_t secs = ticks / Timer::freq();
-    const uint64_t nanosec_ticks = ticks % Timer::freq();
+    if (!tp.write(ts))
+        return -EFAULT;
 
-    const uint64_t nanosecs = (nanosec_ticks * 1'000'000'000) / Timer::freq();
+    return EOK;
+}
 
-    tp.get()->tv_sec = secs;
-    tp.get()->tv_nsec = nanosecs;
+int sys_gettimeofday(user_ptr<timeval> tv, user_ptr<struct timezone> tz)
+{
+    if (tv.as_raw() != (uintptr_t)nullptr)
+    {
+        const uint64_t ns = Time::uptime_ns();
+
+        timeval val;
+        val.tv_sec = Time::boot_epoch() + ns / 1'000'000'000;
+        val.tv_usec = (ns % 1'000'000'000) / 1000;
+
+        if (!tv.write(val))
+            return -EFAULT;
+    }
+
+    if (tz.as_raw() != (uintptr_t)nullptr)
+    {
+        // the RTC is assumed to be in UTC
+        struct timezone zone;
+        zone.tz_minuteswest = 0;
+        zone.tz_dsttime = 0;
+
+        if (!tz.write(zone))
+            return -EFAULT;
+    }
 
     return EOK;
 }
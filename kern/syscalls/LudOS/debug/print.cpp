@@ -29,16 +29,20 @@ SOFTWARE.
 #include "panic.hpp"
 #include "utils/user_ptr.hpp"
 
+static constexpr size_t max_message_len = 0x10000;
+
 void sys_print_serial(user_ptr<const char> string)
 {
-    if (!string.check()) return;
+    auto str = string.str(max_message_len);
+    if (!str) return;
 
-    log_serial("%s", string.get());
+    log_serial("%s", str->c_str());
 }
 
 void sys_print_debug(user_ptr<const char> string)
 {
-    if (!string.check()) return;
+    auto str = string.str(max_message_len);
+    if (!str) return;
 
-    kprintf("%s", string.get());
+    kprintf("%s", str->c_str());
 }
@@ -26,6 +26,7 @@ SOFTWARE.
 #include <errno.h>
 
 #include "tasking/process.hpp"
+#include "tasking/process_data.hpp"
 #include "fs/vfs.hpp"
 
 #include "utils/logging.hpp"
@@ -37,12 +38,29 @@ int sys_get_interface(unsigned int fd, int interface_id, user_ptr<void> interfac
     auto entry = Process::current().get_fd(fd);
     if (!entry) return -EBADF;
 
-    if (!interface.check()) return -EFAULT;
-
     if (!entry->node->implements(interface_id)) return -EINVAL;
 
-    int interface_size = entry->node->get_interface(interface_id, interface.get());
+    uintptr_t interface_copy[vfs::node::max_interface_size / sizeof(uintptr_t)];
+    int interface_size = entry->node->get_interface(interface_id, interface_copy);
     if (interface_size == -1) return -EINVAL;
 
+    if (copy_to_user((void*)interface.as_raw(), interface_copy, interface_size) < 0) return -EFAULT;
+
     return EOK;
 }
+
+int sys_interface_call(unsigned int handle, user_ptr<const uintptr_t> args)
+{
+    auto& callbacks = *Process::current().data->user_callbacks;
+    if (handle >= callbacks.list.size()) return -EINVAL;
+
+    const size_t arg_count = callbacks.list[handle].arg_count;
+
+    uintptr_t arg_copy[tasking::UserCallbackEntry::max_args];
+    if (arg_count)
+    {
+        if (copy_from_user(arg_copy, (const void*)args.as_raw(), arg_count*sizeof(uintptr_t)) < 0) return -EFAULT;
+    }
+
+    return Process::current().call_user_callback(handle, arg_copy);
+}
@@ -35,32 +35,47 @@ SOFTWARE.
 
 int sys_shmget(key_t key, size_t size, int shmflags)
 {
-    return -ENOSYS;
-//    if (get_shared_mem(key))
-//    {
-//        if (shmflags & IPC_CREAT && shmflags & IPC_EXCL)
-//        {
-//            return -EEXIST;
-//        }
+    auto& shm_list = *Process::current().data->shm_list;
 
-//        return key;
-//    }
-//    else
-//    {
-//        if (!(shmflags & IPC_CREAT))
-//        {
-//            return -ENOENT;
-//        }
+    std::shared_ptr<SharedMemorySegment> shm;
 
-//        if (key == IPC_PRIVATE) key = create_shared_memory_id();
+    if (key != IPC_PRIVATE && (shm = get_shared_mem(key)))
+    {
+        if (shmflags & IPC_CREAT && shmflags & IPC_EXCL)
+        {
+            return -EEXIST;
+        }
+        if (size > shm->size())
+        {
+            return -EINVAL;
+        }
+    }
+    else
+    {
+        if (key != IPC_PRIVATE && !(shmflags & IPC_CREAT))
+        {
+            return -ENOENT;
+        }
+        if (size == 0)
+        {
+            return -EINVAL;
+        }
 
-//        auto shm = create_shared_mem(key, size);
-//        if (!shm) return -ENOMEM;
+        if (key == IPC_PRIVATE) key = create_shared_memory_id();
 
-//        assert(!Process::current().data->shm_list.count(key));
-//        Process::current().data->shm_list[key].shm = shm;
-//        Process::current().data->shm_list[key].v_addr = nullptr; // not yet mapped
+        shm = create_shared_mem(key, size);
+        if (!shm) return -ENOMEM;
+    }
 
-//        return key;
-//    }
+    // keep a reference on the segment for as long as the process lives
+    bool referenced = std::any_of(shm_list.begin(), shm_list.end(), [&shm](const tasking::ShmEntry& entry)
+    {
+        return entry.shm == shm;
+    });
+    if (!referenced)
+    {
+        shm_list.push_back(tasking::ShmEntry{(unsigned int)key, shm, nullptr});
+    }
+
+    return key;
 }
@@ -36,51 +36,54 @@ SOFTWARE.
 
 long sys_shmat(int shmid, user_ptr<const void> shmaddr, int shmflg)
 {
-    return -ENOSYS;
-//    uintptr_t v_addr = (uintptr_t)shmaddr.as_raw();
-
-//    if (!get_shared_mem(shmid) || v_addr >= KERNEL_VIRTUAL_BASE)
-//    {
-//        return -EINVAL;
-//    }
-
-//    if (v_addr != 0)
-//    {
-//        if (Memory::offset(v_addr) != 0 && !(shmflg & SHM_RND))
-//        {   // not rounded
-//            return -EINVAL;
-//        }
-//        v_addr += (Memory::page_size() - Memory::offset(v_addr));
-//        if (Memory::is_mapped((void*)v_addr))
-//        {
-//            return -EINVAL;
-//        }
-//    }
-//    else
-//    {
-//        v_addr = Memory::allocate_virtual_page(1, true);
-//        assert(!Memory::is_mapped((void*)v_addr));
-//    }
-
-//    Process::current().data->shm_list.at(shmid).v_addr = (void*)v_addr;
-//    Process::current().data->shm_list.at(shmid).shm->map((void*)v_addr);
-
-//    return v_addr;
+    uintptr_t v_addr = shmaddr.as_raw();
+
+    auto shm = get_shared_mem(shmid);
+    if (!shm)
+    {
+        return -EINVAL;
+    }
+
+    if (v_addr != 0)
+    {
+        if (Memory::offset(v_addr) != 0)
+        {
+            if (!(shmflg & SHM_RND))
+            {   // not rounded
+                return -EINVAL;
+            }
+            v_addr = Memory::page(v_addr);
+        }
+
+        if (v_addr < USER_VIRTUAL_BASE || v_addr + shm->size() > KERNEL_VIRTUAL_BASE ||
+            v_addr + shm->size() < v_addr)
+        {
+            return -EINVAL;
+        }
+    }
+
+    v_addr = Process::current().attach_shm(shmid, v_addr, shmflg & SHM_RDONLY);
+    if (v_addr == 0)
+    {
+        return -EINVAL;
+    }
+
+    return v_addr;
 }
 
 long sys_shmdt(user_ptr<const void> shmaddr)
 {
-    return -ENOSYS;
-//    if (!shmaddr.check() || Memory::offset((uintptr_t)shmaddr.get()) != 0)
-//    {
-//        return -EINVAL;
-//    }
-//    uintptr_t v_addr = (uintptr_t)shmaddr.get();
-
-//    erase_if(Process::current().data->shm_list, [v_addr](const std::pair<unsigned int, tasking::ShmEntry>& pair)
-//    {
-//        return (uintptr_t)pair.second.v_addr == v_addr;
-//    });
-
-//    return 0;
+    uintptr_t v_addr = shmaddr.as_raw();
+
+    if (Memory::offset(v_addr) != 0)
+    {
+        return -EINVAL;
+    }
+
+    if (!Process::current().detach_shm(v_addr))
+    {
+        return -EINVAL;
+    }
+
+    return 0;
 }
@@ -76,32 +76,37 @@ int sys_lud_sem_init(user_ptr<lud_sem_t> lud_sem_id, int pshared, unsigned int v
 {
     if (pshared)
         return -ENOSYS;
-    if (!lud_sem_id.check())
-        return -EFAULT;
 
-    *lud_sem_id.get() = create_new_sem(value);
+    const lud_sem_t id = create_new_sem(value);
+    if (!lud_sem_id.write(id))
+    {
+        destroy_sem(id);
+        return -EFAULT;
+    }
 
     return EOK;
 }
 
 int sys_lud_sem_destroy(user_ptr<lud_sem_t> lud_sem_id)
 {
-    if (!lud_sem_id.check())
+    lud_sem_t id;
+    if (!lud_sem_id.read(id))
         return -EFAULT;
-    if (get_sem(*lud_sem_id.get()) == nullptr)
+    if (get_sem(id) == nullptr)
         return -EINVAL;
 
-    destroy_sem(*lud_sem_id.get());
+    destroy_sem(id);
 
     return EOK;
 }
 
 int sys_lud_sem_post(user_ptr<lud_sem_t> lud_sem_id)
 {
-    if (!lud_sem_id.check())
+    lud_sem_t id;
+    if (!lud_sem_id.read(id))
         return -EFAULT;
 
-    auto sem = get_sem(*lud_sem_id.get());
+    auto sem = get_sem(id);
     if (sem == nullptr)
         return -EINVAL;
 
@@ -112,10 +117,11 @@ int sys_lud_sem_post(user_ptr<lud_sem_t> lud_sem_id)
 
 int sys_lud_sem_wait(user_ptr<lud_sem_t> lud_sem_id)
 {
-    if (!lud_sem_id.check())
+    lud_sem_t id;
+    if (!lud_sem_id.read(id))
         return -EFAULT;
 
-    auto sem = get_sem(*lud_sem_id.get());
+    auto sem = get_sem(id);
     if (sem == nullptr)
         return -EINVAL;
 
@@ -126,10 +132,11 @@ int sys_lud_sem_wait(user_ptr<lud_sem_t> lud_sem_id)
 
 int sys_lud_sem_trywait(user_ptr<lud_sem_t> lud_sem_id)
 {
-    if (!lud_sem_id.check())
+    lud_sem_t id;
+    if (!lud_sem_id.read(id))
         return -EFAULT;
 
-    auto sem = get_sem(*lud_sem_id.get());
+    auto sem = get_sem(id);
     if (sem == nullptr)
         return -EINVAL;
 
@@ -143,14 +150,16 @@ int sys_lud_sem_trywait(user_ptr<lud_sem_t> lud_sem_id)
 
 int sys_lud_sem_timedwait(user_ptr<lud_sem_t> lud_sem_id, user_ptr<const struct timespec> tp)
 {
-    if (!lud_sem_id.check() || !tp.check())
+    lud_sem_t id;
+    struct timespec time;
+    if (!lud_sem_id.read(id) || !tp.read(time))
         return -EFAULT;
 
-    auto sem = get_sem(*lud_sem_id.get());
+    auto sem = get_sem(id);
     if (sem == nullptr)
         return -EINVAL;
 
-    uint64_t ticks = (tp.get()->tv_nsec/1000) * Time::clock_speed() + (tp.get()->tv_sec * (Time::clock_speed()*1'000'000));
+    uint64_t ticks = (time.tv_nsec/1000) * Time::clock_speed() + (time.tv_sec * (Time::clock_speed()*1'000'000));
 
     int ret = sem->wait(&ticks);
 
@@ -162,17 +171,19 @@ int sys_lud_sem_timedwait(user_ptr<lud_sem_t> lud_sem_id, user_ptr<const struct
 
 int sys_lud_sem_getvalue(user_ptr<lud_sem_t> lud_sem_id, user_ptr<int> sval)
 {
-    if (!lud_sem_id.check() || !sval.check())
+    lud_sem_t id;
+    if (!lud_sem_id.read(id))
         return -EFAULT;
 
-    auto sem = get_sem(*lud_sem_id.get());
+    auto sem = get_sem(id);
     if (sem == nullptr)
     {
-        kprintf("PID %d, sem %d (%p) doesn't exist\n", Process::current().pid, *lud_sem_id.get(), lud_sem_id.as_raw());
+        kprintf("PID %d, sem %d (%p) doesn't exist\n", Process::current().pid, id, lud_sem_id.as_raw());
         return -EINVAL;
     }
 
-    *sval.get() = sem->count();
+    if (!sval.write(int(sem->count())))
+        return -EFAULT;
 
     return EOK;
 }
@@ -31,6 +31,5 @@ SOFTWARE.
 
 uint64_t sys_uptime()
 {
-    double secs = Time::uptime();
-    return (uint64_t)(secs * 1'000'000);
+    return Time::uptime_us();
 }
@@ -0,0 +1,162 @@
+/*
+elf_loader.cpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+#include "elf_loader.hpp"
+
+#include "elf/elf.hpp"
+#include "fs/mapped_file.hpp"
+#include "fs/vfs.hpp"
+#include "tasking/process.hpp"
+#include "utils/defs.hpp"
+
+#include <sys/mman.h>
+
+static int segment_prot(uint32_t flags)
+{
+    int prot = PROT_NONE;
+    if (flags & elf::PF_R) prot |= PROT_READ;
+    if (flags & elf::PF_W) prot |= PROT_WRITE;
+    if (flags & elf::PF_X) prot |= PROT_EXEC;
+
+    return prot;
+}
+
+// the segments are checked before the current image of the process is thrown away
+static bool check_segment(const elf::Elf32_Phdr& phdr, uintptr_t prev_end, size_t file_size)
+{
+    const uintptr_t end = phdr.p_vaddr + phdr.p_memsz;
+
+    // the stack, the vDSO and the signal trampoline are above
+    if (phdr.p_filesz > phdr.p_memsz || end < phdr.p_vaddr || end > Process::user_stack_top - Process::user_stack_size)
+    {
+        return false;
+    }
+    // the file pages are mapped as they are
+    if (Memory::offset(phdr.p_vaddr) != Memory::offset(phdr.p_offset))
+    {
+        return false;
+    }
+    if (phdr.p_offset + phdr.p_filesz < phdr.p_offset || phdr.p_offset + phdr.p_filesz > file_size)
+    {
+        return false;
+    }
+
+    // segments are sorted by address and don't share pages
+    return Memory::page(phdr.p_vaddr) >= prev_end;
+}
+
+bool ElfLoader::accept(gsl::span<const uint8_t> file)
+{
+    if (file.size() < (int)sizeof(elf::Elf32_Ehdr)) return false;
+
+    auto hdr = reinterpret_cast<const elf::Elf32_Ehdr*>(file.data());
+    if (!elf::check_supported(hdr) || hdr->e_type != elf::ET_EXEC)
+    {
+        return false;
+    }
+
+    // the program headers must be within the start of the file we are given
+    return hdr->e_phentsize == sizeof(elf::Elf32_Phdr) && hdr->e_phnum > 0 &&
+            hdr->e_phoff + hdr->e_phnum*sizeof(elf::Elf32_Phdr) <= (size_t)file.size();
+}
+
+bool ElfLoader::load(Process &p)
+{
+    // the segments are mapped from the page cache of the node
+    if (!m_node)
+    {
+        return false;
+    }
+
+    auto hdr = reinterpret_cast<const elf::Elf32_Ehdr*>(m_file.data());
+
+    std::vector<const elf::Elf32_Phdr*> segments;
+    uintptr_t prev_end = USER_VIRTUAL_BASE;
+    for (size_t i { 0 }; i < hdr->e_phnum; ++i)
+    {
+        auto phdr = elf::program_header(hdr, i);
+        if (phdr->p_type != elf::PT_LOAD || phdr->p_memsz == 0)
+        {
+            continue;
+        }
+
+        if (!check_segment(*phdr, prev_end, m_node->size()))
+        {
+            warn("Invalid ELF segment at 0x%x (size 0x%x)\n", phdr->p_vaddr, phdr->p_memsz);
+            return false;
+        }
+
+        prev_end = Memory::page(phdr->p_vaddr + phdr->p_memsz + Memory::page_size() - 1);
+        segments.emplace_back(phdr);
+    }
+
+    if (segments.empty())
+    {
+        return false;
+    }
+
+    auto file = vfs::mapped_file::get(m_node);
+
+    // map_segment() copies the last file page of the segments followed by bss, read it while we can still fail
+    for (auto phdr : segments)
+    {
+        const uintptr_t file_end = phdr->p_vaddr + phdr->p_filesz;
+        if (phdr->p_filesz && phdr->p_memsz > phdr->p_filesz && Memory::offset(file_end) &&
+                !file->page((phdr->p_offset + phdr->p_filesz) / Memory::page_size()))
+        {
+            return false;
+        }
+    }
+
+    // from here on a failure kills the process
+    bool loaded = p.load_user_image([&p, &segments, &file]
+    {
+        for (auto phdr : segments)
+        {
+            if (!p.map_segment(phdr->p_vaddr, phdr->p_filesz, phdr->p_memsz, segment_prot(phdr->p_flags),
+                               file, phdr->p_offset))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    });
+
+    if (!loaded)
+    {
+        return false;
+    }
+
+    p.set_instruction_pointer(hdr->e_entry);
+
+    return true;
+}
+
+kpp::string ElfLoader::file_type() const
+{
+    return "ELF32 executable";
+}
+
+ADD_PROCESS_LOADER(ElfLoader);
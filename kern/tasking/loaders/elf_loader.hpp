@@ -0,0 +1,43 @@
+/*
+elf_loader.hpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+#ifndef ELF_LOADER_HPP
+#define ELF_LOADER_HPP
+
+#include "process_loader.hpp"
+
+// Loads static ELF32 executables.
+// The PT_LOAD segments are mapped from the file's page cache : read-only pages are shared by every process
+// running the same file, writable ones are copied on the first write and bss pages are zero-filled when touched.
+class ElfLoader : public ProcessLoader
+{
+public:
+    static bool accept(gsl::span<const uint8_t> file);
+
+public:
+    virtual bool load(Process& p);
+    virtual kpp::string file_type() const;
+};
+
+#endif // ELF_LOADER_HPP
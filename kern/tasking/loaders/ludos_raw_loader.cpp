@@ -27,6 +27,7 @@ SOFTWARE.
 
 #include "tasking/process.hpp"
 #include "tasking/process_data.hpp"
+#include "fs/vfs.hpp"
 
 constexpr char ludos_raw_magic[] = "LUDOSBIN";
 constexpr size_t ludos_raw_len = sizeof(ludos_raw_magic) - 1 + sizeof(uint32_t); // size to alloc
@@ -40,6 +41,18 @@ bool LudosRawLoader::accept(gsl::span<const uint8_t> file)
 
 bool LudosRawLoader::load(Process &p)
 {
+    // the whole image is copied into the process
+    if (m_node && (size_t)m_file.size() < m_node->size())
+    {
+        auto result = m_node->read();
+        if (!result)
+        {
+            return false;
+        }
+        m_buffer = std::move(*result);
+        set_file(m_buffer);
+    }
+
     uint32_t allocated_size = *(uint32_t*)(m_file.data() + 8);
 
     p.load_user_code(m_file, allocated_size - 0x8000000); // TODO : name
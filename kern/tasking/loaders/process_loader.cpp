@@ -26,6 +26,7 @@ SOFTWARE.
 #include "process_loader.hpp"
 
 #include "tasking/process.hpp"
+#include "fs/vfs.hpp"
 
 namespace detail
 {
@@ -45,6 +46,25 @@ std::unique_ptr<ProcessLoader> ProcessLoader::get(gsl::span<const uint8_t> file)
     return nullptr;
 }
 
+std::unique_ptr<ProcessLoader> ProcessLoader::get(const std::shared_ptr<vfs::node> &node)
+{
+    auto result = node->read(0, std::min(node->size(), header_size));
+    if (!result || result->empty())
+    {
+        return nullptr;
+    }
+
+    auto ldr = get(*result);
+    if (ldr)
+    {
+        ldr->m_node = node;
+        ldr->m_buffer = std::move(*result);
+        ldr->set_file(ldr->m_buffer);
+    }
+
+    return ldr;
+}
+
 void ProcessLoader::set_file(gsl::span<const uint8_t> file)
 {
     m_file = file;
@@ -32,15 +32,26 @@ SOFTWARE.
 
 #include "utils/gsl/gsl_span.hpp"
 #include "utils/logging.hpp"
+#include "utils/membuffer.hpp"
 
 class Process;
 
+namespace vfs
+{
+struct node;
+}
+
 class ProcessLoader
 {
 public:
     static bool accept(gsl::span<const uint8_t> file);
 
     static std::unique_ptr<ProcessLoader> get(gsl::span<const uint8_t> file);
+    // only reads the start of 'node' to find its loader, which reads what else it needs from the node
+    static std::unique_ptr<ProcessLoader> get(const std::shared_ptr<vfs::node>& node);
+
+    // size of the part of the file given to accept() by the node overload of get()
+    static constexpr size_t header_size { 0x1000 };
 
 public:
     virtual bool load(Process&) = 0;
@@ -51,6 +62,9 @@ public:
 
 protected:
     gsl::span<const uint8_t> m_file;
+    // set when the loader comes from a node, m_file then only holds its first header_size bytes
+    std::shared_ptr<vfs::node> m_node;
+    MemBuffer m_buffer;
 };
 
 namespace detail
@@ -32,6 +32,7 @@ SOFTWARE.
 
 #include "syscalls/syscalls.hpp"
 #include "tasking/scheduler.hpp"
+#include "time/time.hpp"
 
 #include "mem/memmap.hpp"
 #include "mem/meminfo.hpp"
@@ -62,6 +63,8 @@ Process::Process()
 
     data->user_callbacks = std::make_shared<tasking::UserCallbacks>();
     data->mappings = std::make_shared<std::unordered_map<uintptr_t, tasking::MemoryMapping>>();
+    data->shm_list = std::make_shared<std::vector<tasking::ShmEntry>>();
+    data->mmap_list = std::make_shared<std::vector<tasking::MmapEntry>>();
 
     arch_init();
 }
@@ -286,6 +289,15 @@ Process *Process::by_pid(pid_t pid)
     return m_processes[pid].get();
 }
 
+uint64_t Process::cpu_ticks() const
+{
+    if (this == m_current_process)
+    {
+        return cpu_time + (Time::total_ticks() - m_switch_timestamp);
+    }
+    return cpu_time;
+}
+
 std::vector<pid_t> Process::process_list()
 {
     std::vector<pid_t> vec;
@@ -392,14 +404,6 @@ void Process::push_args(const std::vector<kpp::string>& args)
 Process::~Process()
 {
     // TODO : do this per fd ? and use destructor for this
-    if (data->user_callbacks.use_count() == 1)
-    {
-        for (auto entry : data->user_callbacks->pages)
-        {
-            detach_fault_handler(entry.base);
-        }
-    }
-
     if (data->fd_table.use_count() == 1)
     {
         for (size_t fd { 0 }; fd < data->fd_table->size(); ++fd)
@@ -29,6 +29,10 @@ SOFTWARE.
 
 #include <vector.hpp>
 #include <functional.hpp>
+#include <type_traits.hpp>
+#include <utility.hpp>
+
+#include <errno.h>
 
 #include "mem/memmap.hpp"
 
@@ -57,7 +61,25 @@ class SharedMemorySegment;
 struct ProcessArchContext;
 struct ProcessData;
 
-struct PageFault;
+namespace vfs
+{
+class mapped_file;
+}
+
+namespace tasking
+{
+struct UserCallbackEntry
+{
+    static constexpr size_t max_args = 6;
+
+    using invoke_ptr = int(*)(const void* object, const void* member, const uintptr_t* args);
+
+    invoke_ptr invoke { nullptr };
+    const void* object { nullptr };
+    uint8_t member[2*sizeof(uintptr_t)]; // pointer to member function, type-erased
+    uint8_t arg_count { 0 };
+};
+}
 
 class Process : NonCopyable
 {
@@ -86,7 +108,12 @@ public:
     static constexpr int    min_priority = 1;
     static constexpr size_t tls_pages = 1;
     static constexpr uintptr_t signal_trampoline_page = KERNEL_VIRTUAL_BASE - (1*Memory::page_size());
-    static constexpr size_t    user_stack_top         = KERNEL_VIRTUAL_BASE - (1*Memory::page_size());
+    static constexpr uintptr_t vdso_code_page         = KERNEL_VIRTUAL_BASE - (2*Memory::page_size());
+    static constexpr uintptr_t vdso_data_page         = KERNEL_VIRTUAL_BASE - (3*Memory::page_size());
+    static constexpr size_t    callback_stub_size     = 32;
+    static constexpr size_t    callback_stubs_per_page = Memory::page_size() / callback_stub_size;
+    static constexpr size_t    user_stack_top         = vdso_data_page;
+    static constexpr size_t    user_stack_size        = 2*Memory::page_size();
     static constexpr kpp::array<uintptr_t, 64> default_sighandler_actions
     {{
             SIG_ACTION_TERM, // 0
@@ -131,6 +158,7 @@ public:
     static Process* create_user_task();
     static Process* clone(Process& proc, uint32_t flags = 0);
     static Process& current()    { return *m_current_process ; }
+    static bool     has_current(){ return  m_current_process != nullptr; }
     static size_t   count()      { return  m_process_count   ; }
     static size_t   highest_pid(){ return  m_processes.size(); }
     static void     task_switch(pid_t pid);
@@ -148,6 +176,10 @@ public:
     ~Process();
 
     void load_user_code(gsl::span<const uint8_t> code_to_copy, size_t allocated_size = 0);
+    // like load_user_code, but the program's pages are set up by 'map_image' instead of being copied.
+    // The previous image is gone by then : if 'map_image' fails the process is killed and false is returned
+    // (which only happens when it isn't the current one)
+    bool load_user_image(const std::function<bool()>& map_image);
     void set_instruction_pointer(unsigned int value);
 
     void push_args(const std::vector<kpp::string> &args);
@@ -165,13 +197,15 @@ public:
 
     void* map_range(uintptr_t phys, size_t len);
 
-    // creates a way to call the kernel by triggering a page fault
-    template <typename... Args>
-    uintptr_t create_user_callback(const std::function<int(Args...)>& callback);
+    // returns the user address of a stub calling object->*func through the interface_call syscall
+    template <typename Object, typename Return, typename... Args>
+    uintptr_t create_user_callback(const Object* object, Return(Object::*func)(Args...) const);
 
-    uintptr_t create_user_callback_impl(const std::function<int(const std::vector<uintptr_t>&)> &callback, const std::vector<size_t>& arg_sizes);
+    uintptr_t create_user_callback_impl(const tasking::UserCallbackEntry& entry);
     void allocate_user_callback_page();
 
+    int call_user_callback(size_t handle, const uintptr_t* args);
+
     void raise(pid_t target_pid, int sig, const siginfo_t& siginfo);
     void exit_signal();
 
@@ -183,6 +217,27 @@ public:
     uintptr_t allocate_pages(size_t pages);
     bool      release_pages(uintptr_t ptr, size_t pages);
 
+    // maps the physical pages of the segment at v_addr, or at the first free range if v_addr is 0
+    // returns 0 on failure
+    uintptr_t attach_shm(unsigned int id, uintptr_t v_addr, bool read_only);
+    bool      detach_shm(uintptr_t v_addr);
+
+    // reserves 'pages' pages at v_addr for 'file', starting at its page 'file_page', or for zero-filled memory
+    // if 'file' is null. The pages are mapped by handle_mmap_fault() when first touched.
+    // v_addr is chosen if 0, returns 0 on failure
+    uintptr_t map_file(uintptr_t v_addr, size_t pages, int prot, bool shared,
+                       const std::shared_ptr<vfs::mapped_file>& file, size_t file_page);
+    // maps a segment of an executable : 'file_size' bytes of 'file' from 'offset', then zeroes up to 'mem_size'.
+    // The file pages are the cache's own until written to, the rest is zero-filled when first touched
+    bool      map_segment(uintptr_t v_addr, size_t file_size, size_t mem_size, int prot,
+                          const std::shared_ptr<vfs::mapped_file>& file, size_t offset);
+    // these return 0 or a negative errno value
+    int       unmap_range(uintptr_t v_addr, size_t pages);
+    int       protect_range(uintptr_t v_addr, size_t pages, int prot);
+    int       sync_range(uintptr_t v_addr, size_t pages);
+    // maps the page of a mmap'ed range containing 'address', returns false if the access isn't allowed
+    bool      handle_mmap_fault(uintptr_t address, bool write);
+
 private:
     Process();
 
@@ -204,6 +259,10 @@ public:
     } status = Active;
     status_info status_info;
     int priority { 0 };
+    uint64_t cpu_time { 0 }; // TSC ticks spent running, up to the last switch away from the process
+
+    // cpu time including the currently running time slice
+    uint64_t cpu_ticks() const;
 
 private:
     static pid_t find_free_pid();
@@ -231,19 +290,23 @@ private:
 
     void execute_sighandler(int signal, pid_t returning_pid, const siginfo_t& siginfo);
 
-    bool user_callback_fault_handler(const PageFault& fault);
-    void do_user_callback(const std::function<int(const std::vector<uintptr_t>&)>& callback, const std::vector<size_t> &arg_sizes);
+    // physical address of the page containing the stubs for the handles [index*callback_stubs_per_page; (index+1)*callback_stubs_per_page[
+    static uintptr_t callback_stub_page(size_t index);
 
     static void switch_mappings(Process *prev, Process* next);
 
     void map_code(gsl::span<const uint8_t> code, size_t allocated_size);
     void map_stack(size_t stack_size);
 
+    void reset_user_context();
     void create_mappings(gsl::span<const uint8_t> code, size_t allocated_size, size_t stack_size);
     void release_mappings();
 
     uintptr_t allocate_virtual_page(size_t count);
+    bool is_range_free(uintptr_t virt_addr, size_t count) const;
+    bool is_page_free(uintptr_t virt_addr) const;
     void map_page(uintptr_t virt_addr, uintptr_t phys_addr, uint32_t flags, bool owned);
+    void unmap_page(uintptr_t virt_addr);
 
     void map_address_space();
     void unmap_address_space();
@@ -255,6 +318,7 @@ private:
 
 private:
     static inline Process* m_current_process { nullptr };
+    static inline uint64_t m_switch_timestamp { 0 };
     static inline std::vector<std::unique_ptr<Process>> m_processes;
     static inline size_t m_process_count { 0 };
 };
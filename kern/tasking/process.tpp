@@ -23,24 +23,55 @@ SOFTWARE.
 
 */
 
-template <typename... Args, size_t... Idx>
-void apply_vec(std::tuple<Args...>& t, const std::vector<uintptr_t>& vec, std::index_sequence<Idx...>) {
-    ((std::get<Idx>(t) = (typename std::tuple_element<Idx, std::tuple<Args...>>::type)vec[Idx]), ...);
+namespace tasking::detail
+{
+// the raw register value reinterpreted as the argument type, pointers come as user_ptr<> and are copied from or to
+template <typename Arg>
+Arg callback_arg(uintptr_t value)
+{
+    static_assert(!std::is_pointer_v<Arg>, "Use user_ptr<>");
+
+    Arg arg;
+    memcpy(&arg, &value, sizeof(arg));
+    return arg;
 }
 
-template <typename... Args>
-uintptr_t Process::create_user_callback(const std::function<int(Args...)>& callback)
+template <typename Object, typename Return, typename... Args, size_t... Idx>
+int invoke_user_callback(const void* object, const void* member, const uintptr_t* args, std::index_sequence<Idx...>)
 {
-    std::vector<size_t> arg_sizes(sizeof...(Args));
-
-    size_t i { 0 };
-    ((arg_sizes[i++] = sizeof(Args)), ...);
+    Return(Object::*func)(Args...) const;
+    memcpy(&func, member, sizeof(func));
 
-    return create_user_callback_impl([callback](const std::vector<uintptr_t>& args)->int
+    if constexpr (std::is_same_v<Return, void>)
     {
-        std::tuple<Args...> tuple;
-        apply_vec(tuple, args, std::make_index_sequence<sizeof...(Args)>());
+        (((const Object*)object)->*func)(callback_arg<Args>(args[Idx])...);
+        return 0;
+    }
+    else
+    {
+        return (int)(((const Object*)object)->*func)(callback_arg<Args>(args[Idx])...);
+    }
+}
+
+template <typename Object, typename Return, typename... Args>
+int invoke_user_callback(const void* object, const void* member, const uintptr_t* args)
+{
+    return invoke_user_callback<Object, Return, Args...>(object, member, args, std::index_sequence_for<Args...>{});
+}
+}
+
+template <typename Object, typename Return, typename... Args>
+uintptr_t Process::create_user_callback(const Object* object, Return(Object::*func)(Args...) const)
+{
+    static_assert(sizeof...(Args) <= tasking::UserCallbackEntry::max_args, "too many arguments for a user callback");
+    static_assert(((sizeof(Args) <= sizeof(uintptr_t)) && ...), "user callback arguments must fit in a register");
+    static_assert(sizeof(func) <= sizeof(tasking::UserCallbackEntry::member));
+
+    tasking::UserCallbackEntry entry;
+    entry.invoke = tasking::detail::invoke_user_callback<Object, Return, Args...>;
+    entry.object = object;
+    entry.arg_count = sizeof...(Args);
+    memcpy(entry.member, &func, sizeof(func));
 
-        return std::apply(callback, tuple);
-    }, arg_sizes);
+    return create_user_callback_impl(entry);
 }
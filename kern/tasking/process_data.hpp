@@ -41,8 +41,8 @@ SOFTWARE.
 #include <signal.h>
 
 #include "mem/memmap.hpp"
-#include "mem/page_fault.hpp"
 
+#include "process.hpp"
 #include "shared_memory.hpp"
 
 #include "fdinfo.hpp"
@@ -52,6 +52,7 @@ SOFTWARE.
 namespace vfs
 {
 class node;
+class mapped_file;
 }
 
 namespace tasking
@@ -65,26 +66,28 @@ struct MemoryMapping
 
 struct ShmEntry
 {
+    unsigned int id;
     std::shared_ptr<SharedMemorySegment> shm;
-    void* v_addr;
+    void* v_addr; // nullptr if only referenced by shmget and not yet attached
 };
 
-struct UserCallbacks
+// a range reserved by mmap, its pages are mapped when first touched
+struct MmapEntry
 {
-    struct CallbackEntry
-    {
-        std::vector<size_t> arg_sizes;
-        std::function<int(const std::vector<uintptr_t>&)> callback;
-    };
-    struct PageEntry
-    {
-        uintptr_t base;
-        fault_handle page_fault_handle;
-    };
+    uintptr_t v_addr;
+    size_t    pages;
+    int       prot;
+    bool      shared;
+    std::shared_ptr<vfs::mapped_file> file; // nullptr for zero-filled memory
+    size_t    file_page; // index of the file page mapped at v_addr
+};
 
-    std::unordered_set<uintptr_t> free_entries;
-    std::unordered_map<uintptr_t, CallbackEntry> list;
-    std::vector<PageEntry> pages;
+struct UserCallbacks
+{
+    // indexed by callback handle
+    std::vector<UserCallbackEntry> list;
+    // virtual address of each stub page, page i holds the stubs for the handles [i*stubs_per_page; (i+1)*stubs_per_page[
+    std::vector<uintptr_t> pages;
 };
 }
 
@@ -130,7 +133,9 @@ struct ProcessData
 
     std::vector<kpp::string> args;
 
-    //std::unordered_map<unsigned int, tasking::ShmEntry> shm_list;
+    shared_resource<std::vector<tasking::ShmEntry>> shm_list;
+
+    shared_resource<std::vector<tasking::MmapEntry>> mmap_list;
 
     struct SigContext
     {
@@ -25,6 +25,14 @@ SOFTWARE.
 
 #include "tasking/process.hpp"
 #include "tasking/process_data.hpp"
+#include "tasking/shared_memory.hpp"
+#include "tasking/vdso.hpp"
+#include "fs/mapped_file.hpp"
+
+#include "utils/stlutils.hpp"
+
+#include <sys/tls.h>
+#include <sys/mman.h>
 
 extern "C" void signal_trampoline();
 
@@ -63,7 +71,7 @@ void Process::map_code(gsl::span<const uint8_t> code, size_t allocated_size)
         }
         else
         {
-            aligned_memsetl(dest_ptr, 0, Memory::page_size());
+            zero_page(dest_ptr);
         }
 
         Memory::unmap(dest_ptr, Memory::page_size());
@@ -94,6 +102,12 @@ void Process::create_mappings(gsl::span<const uint8_t> code, size_t allocated_si
     map_stack(stack_size);
 
     map_page(signal_trampoline_page, Memory::physical_address((void*)signal_trampoline), Memory::Read|Memory::User|Memory::Executable, false);
+
+    if (vdso::code_page())
+    {
+        map_page(vdso_code_page, vdso::code_page(), Memory::Read|Memory::User|Memory::Executable, false);
+        map_page(vdso_data_page, vdso::data_page(), Memory::Read|Memory::User, false);
+    }
 }
 
 void Process::release_mappings()
@@ -111,6 +125,25 @@ void Process::release_mappings()
     }
 
     data->mappings->clear();
+
+    // shared memory segments are released when their last user detaches from them
+    if (data->shm_list.use_count() == 1)
+    {
+        data->shm_list->clear();
+    }
+
+    // the file caches write back their dirty pages when their last mapping goes away
+    if (data->mmap_list.use_count() == 1)
+    {
+        data->mmap_list->clear();
+    }
+
+    // the callback stubs aren't mapped anymore
+    if (data->user_callbacks.use_count() == 1)
+    {
+        data->user_callbacks->list.clear();
+        data->user_callbacks->pages.clear();
+    }
 }
 
 uintptr_t Process::allocate_virtual_page(size_t count)
@@ -119,7 +152,7 @@ uintptr_t Process::allocate_virtual_page(size_t count)
     size_t counter = 0;
     for (size_t i { USER_VIRTUAL_BASE >> 12 }; i < KERNEL_VIRTUAL_BASE >> 12; ++i)
     {
-        if (!data->mappings->count(i << 12))
+        if (is_page_free(i << 12))
         {
             if (counter++ == 0) addr = i << 12;
         }
@@ -137,6 +170,33 @@ uintptr_t Process::allocate_virtual_page(size_t count)
     assert(false);
 }
 
+bool Process::is_range_free(uintptr_t virt_addr, size_t count) const
+{
+    for (size_t i { 0 }; i < count; ++i)
+    {
+        if (!is_page_free(virt_addr + i*Memory::page_size()))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Process::is_page_free(uintptr_t virt_addr) const
+{
+    if (data->mappings->count(virt_addr))
+    {
+        return false;
+    }
+
+    // mmap'ed pages aren't mapped until they are touched
+    return std::none_of(data->mmap_list->begin(), data->mmap_list->end(), [virt_addr](const MmapEntry& entry)
+    {
+        return virt_addr >= entry.v_addr && virt_addr < entry.v_addr + entry.pages*Memory::page_size();
+    });
+}
+
 void Process::map_page(uintptr_t virt_addr, uintptr_t phys_addr, uint32_t flags, bool owned)
 {
     if (data->mappings == m_current_process->data->mappings)
@@ -146,6 +206,21 @@ void Process::map_page(uintptr_t virt_addr, uintptr_t phys_addr, uint32_t flags,
     (*data->mappings)[(uintptr_t)virt_addr] = {phys_addr, flags, owned};
 }
 
+void Process::unmap_page(uintptr_t virt_addr)
+{
+    assert(data->mappings->count(virt_addr));
+
+    if (data->mappings == m_current_process->data->mappings)
+        Memory::unmap_page((void*)virt_addr);
+
+    if (data->mappings->at(virt_addr).owned)
+    {
+        Memory::release_physical_page(data->mappings->at(virt_addr).paddr);
+    }
+
+    data->mappings->erase(virt_addr);
+}
+
 void Process::map_address_space()
 {
     for (const auto& pair : *data->mappings)
@@ -166,39 +241,35 @@ void *Process::map_range(uintptr_t phys, size_t len)
     return (void*)virt;
 }
 
-uintptr_t Process::create_user_callback_impl(const std::function<int(const std::vector<uintptr_t>&)> &callback, const std::vector<size_t> &arg_sizes)
+uintptr_t Process::create_user_callback_impl(const UserCallbackEntry& entry)
 {
-    if (data->user_callbacks->free_entries.empty())
+    const size_t handle = data->user_callbacks->list.size();
+    if (handle / callback_stubs_per_page >= data->user_callbacks->pages.size())
     {
         allocate_user_callback_page();
     }
-    assert(!data->user_callbacks->free_entries.empty());
+    assert(handle / callback_stubs_per_page < data->user_callbacks->pages.size());
 
-    const auto address = *data->user_callbacks->free_entries.begin();
-    data->user_callbacks->list[address] = {arg_sizes, callback};
-    data->user_callbacks->free_entries.erase(data->user_callbacks->free_entries.begin());
+    data->user_callbacks->list.push_back(entry);
 
-    return address;
+    return data->user_callbacks->pages[handle / callback_stubs_per_page] + (handle % callback_stubs_per_page)*callback_stub_size;
 }
 
 void Process::allocate_user_callback_page()
 {
     auto virt_page = allocate_virtual_page(1);
-    map_page((uintptr_t)virt_page, 0, Memory::Sentinel|Memory::User, false);
+    // the stub pages are identical for every process
+    map_page((uintptr_t)virt_page, callback_stub_page(data->user_callbacks->pages.size()), Memory::Read|Memory::User|Memory::Executable, false);
 
+    data->user_callbacks->pages.push_back(virt_page);
+}
 
-    // Mark these new callbacks as free
-    for (size_t i { 0 }; i < Memory::page_size(); ++i)
-    {
-        data->user_callbacks->free_entries.insert(virt_page+i);
-    }
-
-    auto handle = attach_fault_handler((void*)virt_page, [this](const PageFault& fault)
-    {
-        return user_callback_fault_handler(fault);
-    });
+int Process::call_user_callback(size_t handle, const uintptr_t *args)
+{
+    assert(handle < data->user_callbacks->list.size());
 
-    data->user_callbacks->pages.push_back(UserCallbacks::PageEntry{virt_page, handle});
+    const auto& entry = data->user_callbacks->list[handle];
+    return entry.invoke(entry.object, entry.member, args);
 }
 
 uintptr_t Process::allocate_pages(size_t pages)
@@ -216,6 +287,422 @@ uintptr_t Process::allocate_pages(size_t pages)
     return (uintptr_t)addr;
 }
 
+uintptr_t Process::attach_shm(unsigned int id, uintptr_t v_addr, bool read_only)
+{
+    auto shm = get_shared_mem(id);
+    if (!shm) return 0;
+
+    if (v_addr == 0)
+    {
+        v_addr = allocate_virtual_page(shm->page_count());
+    }
+    else if (!is_range_free(v_addr, shm->page_count()))
+    {
+        return 0;
+    }
+
+    uint32_t flags = Memory::Read|Memory::User;
+    if (!read_only) flags |= Memory::Write;
+
+    // the pages belong to the segment, the process only borrows them
+    for (size_t i { 0 }; i < shm->page_count(); ++i)
+    {
+        map_page(v_addr + i*Memory::page_size(), shm->physical_pages()[i], flags, false);
+    }
+
+    // reuse the reference obtained by shmget if it isn't attached yet
+    auto it = std::find_if(data->shm_list->begin(), data->shm_list->end(), [id](const ShmEntry& entry)
+    {
+        return entry.id == id && entry.v_addr == nullptr;
+    });
+    if (it != data->shm_list->end())
+    {
+        it->v_addr = (void*)v_addr;
+    }
+    else
+    {
+        data->shm_list->push_back(ShmEntry{id, shm, (void*)v_addr});
+    }
+
+    return v_addr;
+}
+
+bool Process::detach_shm(uintptr_t v_addr)
+{
+    auto it = std::find_if(data->shm_list->begin(), data->shm_list->end(), [v_addr](const ShmEntry& entry)
+    {
+        return (uintptr_t)entry.v_addr == v_addr;
+    });
+    if (v_addr == 0 || it == data->shm_list->end())
+    {
+        return false;
+    }
+
+    for (size_t i { 0 }; i < it->shm->page_count(); ++i)
+    {
+        unmap_page(v_addr + i*Memory::page_size());
+    }
+
+    data->shm_list->erase(it);
+
+    return true;
+}
+
+static MmapEntry* find_mmap(std::vector<MmapEntry>& list, uintptr_t addr)
+{
+    auto it = std::find_if(list.begin(), list.end(), [addr](const MmapEntry& entry)
+    {
+        return addr >= entry.v_addr && addr < entry.v_addr + entry.pages*Memory::page_size();
+    });
+
+    return it != list.end() ? &*it : nullptr;
+}
+
+// makes 'addr' the start of a range if it falls inside one, so that ranges are either fully in or out of an operation
+static void split_mmap(std::vector<MmapEntry>& list, uintptr_t addr)
+{
+    auto entry = find_mmap(list, addr);
+    if (!entry || entry->v_addr == addr)
+    {
+        return;
+    }
+
+    const size_t head_pages = (addr - entry->v_addr) / Memory::page_size();
+
+    MmapEntry tail = *entry;
+    tail.v_addr = addr;
+    tail.pages = entry->pages - head_pages;
+    tail.file_page = entry->file_page + head_pages;
+
+    entry->pages = head_pages;
+    list.emplace_back(std::move(tail));
+}
+
+// writes are only allowed once a private page is copied or a shared one is marked dirty, so that both get noticed
+static uint32_t mmap_page_flags(const MmapEntry& entry, size_t file_page, bool owned)
+{
+    if (entry.prot == PROT_NONE)
+    {
+        return Memory::User|Memory::Sentinel;
+    }
+
+    uint32_t flags = Memory::Read|Memory::User;
+    if (entry.prot & PROT_EXEC)
+    {
+        flags |= Memory::Executable;
+    }
+    if (entry.prot & PROT_WRITE)
+    {
+        const bool writable = entry.file == nullptr || (entry.shared ? entry.file->is_dirty(file_page) : owned);
+        if (writable) flags |= Memory::Write;
+    }
+
+    return flags;
+}
+
+uintptr_t Process::map_file(uintptr_t v_addr, size_t pages, int prot, bool shared,
+                            const std::shared_ptr<vfs::mapped_file> &file, size_t file_page)
+{
+    assert(pages > 0);
+
+    if (v_addr == 0)
+    {
+        v_addr = allocate_virtual_page(pages);
+    }
+    else if (!is_range_free(v_addr, pages))
+    {
+        return 0;
+    }
+
+    data->mmap_list->push_back(MmapEntry{v_addr, pages, prot, shared, file, file_page});
+
+    return v_addr;
+}
+
+bool Process::map_segment(uintptr_t v_addr, size_t file_size, size_t mem_size, int prot,
+                          const std::shared_ptr<vfs::mapped_file> &file, size_t offset)
+{
+    assert(Memory::offset(v_addr) == Memory::offset(offset));
+
+    const uintptr_t start    = Memory::page(v_addr);
+    const uintptr_t file_end = v_addr + file_size;
+    const uintptr_t mem_end  = v_addr + mem_size;
+    const size_t file_pages  = file_size ? (file_end - start + Memory::page_size() - 1) / Memory::page_size() : 0;
+    const size_t mem_pages   = (mem_end - start + Memory::page_size() - 1) / Memory::page_size();
+
+    if (file_pages)
+    {
+        const size_t first_page = offset / Memory::page_size();
+        if (!map_file(start, file_pages, prot, false, file, first_page))
+        {
+            return false;
+        }
+
+        // the last file page is shared with the start of the zero-filled part : give it a private copy
+        // with the bytes following the segment in the file cleared
+        if (mem_size > file_size && Memory::offset(file_end))
+        {
+            const uintptr_t page = Memory::page(file_end);
+            const size_t file_page = first_page + file_pages - 1;
+
+            const uintptr_t cached = file->page(file_page);
+            const uintptr_t phys = cached ? Memory::allocate_physical_page() : 0;
+            if (!phys)
+            {
+                return false;
+            }
+
+            auto src_ptr  = Memory::mmap(cached, Memory::page_size(), Memory::Read);
+            auto dest_ptr = (uint8_t*)Memory::mmap(phys, Memory::page_size());
+            memcpy(dest_ptr, src_ptr, Memory::offset(file_end));
+            memset(dest_ptr + Memory::offset(file_end), 0, Memory::page_size() - Memory::offset(file_end));
+            Memory::unmap(src_ptr, Memory::page_size());
+            Memory::unmap(dest_ptr, Memory::page_size());
+
+            map_page(page, phys, mmap_page_flags(*find_mmap(*data->mmap_list, page), file_page, true), true);
+        }
+    }
+
+    if (mem_pages > file_pages)
+    {
+        if (!map_file(start + file_pages*Memory::page_size(), mem_pages - file_pages, prot, false, nullptr, 0))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int Process::unmap_range(uintptr_t v_addr, size_t pages)
+{
+    auto& list = *data->mmap_list;
+    const uintptr_t end = v_addr + pages*Memory::page_size();
+
+    split_mmap(list, v_addr);
+    split_mmap(list, end);
+
+    for (auto it = list.begin(); it != list.end();)
+    {
+        if (it->v_addr < v_addr || it->v_addr >= end)
+        {
+            ++it;
+            continue;
+        }
+
+        for (size_t i { 0 }; i < it->pages; ++i)
+        {
+            const uintptr_t page = it->v_addr + i*Memory::page_size();
+            if (data->mappings->count(page))
+            {
+                unmap_page(page); // releases the private copies
+            }
+        }
+
+        it = list.erase(it);
+    }
+
+    return 0;
+}
+
+int Process::protect_range(uintptr_t v_addr, size_t pages, int prot)
+{
+    auto& list = *data->mmap_list;
+    const uintptr_t end = v_addr + pages*Memory::page_size();
+
+    // check the whole range before changing anything : pages that weren't mmap'ed can only change if they are owned,
+    // the shared ones (vDSO, trampolines, segments attached read-only) must stay as they are
+    for (uintptr_t page { v_addr }; page < end; page += Memory::page_size())
+    {
+        if (find_mmap(list, page))
+        {
+            continue;
+        }
+
+        auto mapping = data->mappings->find(page);
+        if (mapping == data->mappings->end())
+        {
+            return -ENOMEM;
+        }
+        if (!mapping->second.owned)
+        {
+            return -EACCES;
+        }
+    }
+
+    split_mmap(list, v_addr);
+    split_mmap(list, end);
+
+    for (uintptr_t page { v_addr }; page < end; page += Memory::page_size())
+    {
+        uint32_t flags;
+        auto mapping = data->mappings->find(page);
+
+        if (auto entry = find_mmap(list, page))
+        {
+            entry->prot = prot;
+            if (mapping == data->mappings->end())
+            {
+                continue; // not touched yet
+            }
+
+            const size_t file_page = entry->file_page + (page - entry->v_addr) / Memory::page_size();
+            flags = mmap_page_flags(*entry, file_page, mapping->second.owned);
+        }
+        else
+        {
+            flags = prot == PROT_NONE ? Memory::User|Memory::Sentinel : Memory::Read|Memory::User;
+            if (prot & PROT_WRITE) flags |= Memory::Write;
+            if (prot & PROT_EXEC)  flags |= Memory::Executable;
+        }
+
+        mapping->second.flags = flags;
+        if (data->mappings == m_current_process->data->mappings)
+        {
+            Memory::remap_page(mapping->second.paddr, (void*)page, flags);
+        }
+    }
+
+    return 0;
+}
+
+int Process::sync_range(uintptr_t v_addr, size_t pages)
+{
+    auto& list = *data->mmap_list;
+    const uintptr_t end = v_addr + pages*Memory::page_size();
+
+    for (uintptr_t page { v_addr }; page < end; page += Memory::page_size())
+    {
+        if (!find_mmap(list, page))
+        {
+            return -ENOMEM;
+        }
+    }
+
+    for (const auto& entry : list)
+    {
+        const uintptr_t entry_end = entry.v_addr + entry.pages*Memory::page_size();
+        if (!entry.shared || !entry.file || entry_end <= v_addr || entry.v_addr >= end)
+        {
+            continue;
+        }
+
+        const uintptr_t first = std::max(entry.v_addr, v_addr);
+        const uintptr_t last  = std::min(entry_end, end);
+        const size_t file_page = entry.file_page + (first - entry.v_addr) / Memory::page_size();
+
+        if (auto result = entry.file->sync(file_page, (last - first) / Memory::page_size()); !result)
+        {
+            return -result.error().to_errno();
+        }
+    }
+
+    return 0;
+}
+
+bool Process::handle_mmap_fault(uintptr_t address, bool write)
+{
+    auto entry = find_mmap(*data->mmap_list, address);
+    if (!entry || entry->prot == PROT_NONE || (write && !(entry->prot & PROT_WRITE)))
+    {
+        return false;
+    }
+
+    const uintptr_t page = Memory::page(address);
+    const size_t file_page = entry->file_page + (page - entry->v_addr) / Memory::page_size();
+
+    // private pages get their own copy on the first write, from the file cache or zero-filled
+    auto make_private_copy = [](uintptr_t source)
+    {
+        const uintptr_t phys = Memory::allocate_physical_page();
+        if (!phys) return phys;
+
+        auto dest_ptr = Memory::mmap(phys, Memory::page_size());
+        if (source)
+        {
+            auto src_ptr = Memory::mmap(source, Memory::page_size(), Memory::Read);
+            copy_page(dest_ptr, src_ptr);
+            Memory::unmap(src_ptr, Memory::page_size());
+        }
+        else
+        {
+            zero_page(dest_ptr);
+        }
+        Memory::unmap(dest_ptr, Memory::page_size());
+
+        return phys;
+    };
+
+    if (auto mapping = data->mappings->find(page); mapping != data->mappings->end())
+    {
+        // the page is there, this is the first write to it
+        if (!write || mapping->second.owned || !entry->file)
+        {
+            return false;
+        }
+
+        if (entry->shared)
+        {
+            entry->file->mark_dirty(file_page);
+
+            mapping->second.flags = mmap_page_flags(*entry, file_page, false);
+            Memory::remap_page(mapping->second.paddr, (void*)page, mapping->second.flags);
+        }
+        else
+        {
+            const uintptr_t copy = make_private_copy(mapping->second.paddr);
+            if (!copy) return false;
+
+            unmap_page(page);
+            map_page(page, copy, mmap_page_flags(*entry, file_page, true), true);
+        }
+
+        return true;
+    }
+
+    if (!entry->file)
+    {
+        const uintptr_t phys = make_private_copy(0);
+        if (!phys) return false;
+
+        map_page(page, phys, mmap_page_flags(*entry, file_page, true), true);
+        return true;
+    }
+
+    const uintptr_t cached = entry->file->page(file_page);
+    if (!cached)
+    {
+        return false;
+    }
+
+    // reading the file may have slept, and another thread sharing the address space changed the ranges or mapped the page
+    entry = find_mmap(*data->mmap_list, address);
+    if (!entry || !entry->file)
+    {
+        return false;
+    }
+    if (data->mappings->count(page))
+    {
+        return true;
+    }
+
+    if (write && !entry->shared)
+    {
+        const uintptr_t copy = make_private_copy(cached);
+        if (!copy) return false;
+
+        map_page(page, copy, mmap_page_flags(*entry, file_page, true), true);
+    }
+    else
+    {
+        if (write) entry->file->mark_dirty(file_page);
+
+        map_page(page, cached, mmap_page_flags(*entry, file_page, false), false);
+    }
+
+    return true;
+}
+
 bool Process::release_pages(uintptr_t ptr, size_t pages)
 {    
     // TODO : use vfree
@@ -242,8 +729,12 @@ void Process::copy_page_directory(Process &target)
 {
     for (const auto& pair : *data->mappings)
     {
+        // non-owned pages (shared memory, trampolines, device memory) are shared with the child
         if (!pair.second.owned)
+        {
+            (*target.data->mappings)[pair.first] = pair.second;
             continue;
+        }
 
         (*target.data->mappings)[pair.first] = pair.second;
         assert((*target.data->mappings)[pair.first].owned);
@@ -252,7 +743,7 @@ void Process::copy_page_directory(Process &target)
         auto src_ptr = Memory::mmap(pair.second.paddr, Memory::page_size());
         auto dest_ptr = Memory::mmap((*target.data->mappings)[pair.first].paddr, Memory::page_size());
 
-        aligned_memcpy(dest_ptr, src_ptr, Memory::page_size());
+        copy_page(dest_ptr, src_ptr);
 
         Memory::unmap(src_ptr, Memory::page_size());
         Memory::unmap(dest_ptr, Memory::page_size());
@@ -281,8 +772,10 @@ void Process::init_tls()
         }
     }
 
-    // set the first TLS entry to the address of the TLS section
-    Memory::phys_write(tls_control_paddr, &tls_control_vaddr, 4);
+    // set the first TLS entry to the address of the TLS section, the other ones start cleared
+    tls_control control {};
+    control.self = tls_control_vaddr;
+    Memory::phys_write(tls_control_paddr, &control, sizeof(control));
 
     data->tls_vaddr = tls_control_vaddr;
 }
@@ -28,6 +28,7 @@ SOFTWARE.
 #include "utils/logging.hpp"
 #include "sys/time.h"
 #include "time/time.hpp"
+#include "time/timer.hpp"
 #include "tasking/process.hpp"
 
 #include "i686/tasking/process.hpp"
@@ -61,6 +62,7 @@ DeltaQueue<pid_t, uint64_t> sleep_queue
 };
 
 uint64_t elapsed_ticks { 0 };
+uint64_t halted_ticks { 0 };
 
 void scheduler_init()
 {
@@ -71,14 +73,20 @@ void update_sleep_queue()
 {
     spin_lock(&sleep_lock);
 
-    time_t current_ticks = Time::total_ticks();
-    time_t tick_duration = current_ticks - elapsed_ticks;
+    const uint64_t current_ticks = Time::total_ticks();
+    const uint64_t tick_duration = current_ticks - elapsed_ticks;
     elapsed_ticks = current_ticks;
 
     //log_serial("tick duration : %lld\n", tick_duration);
 
     sleep_queue.decrease(tick_duration);
 
+    // a tickless timer only fires when asked to, make sure it does for the next sleeper
+    if (!sleep_queue.empty())
+    {
+        Timer::request_wakeup(current_ticks + sleep_queue.front_delay());
+    }
+
     spin_unlock(&sleep_lock);
 }
 
@@ -87,6 +95,21 @@ bool process_ready(pid_t pid)
     return Process::by_pid(pid)->status == Process::Active;
 }
 
+bool has_ready_process()
+{
+    update_sleep_queue();
+
+    for (pid_t pid { 1 }; pid < (pid_t)Process::highest_pid(); ++pid)
+    {
+        if (Process::by_pid(pid) && process_ready(pid))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 pid_t find_next_pid()
 {
     pid_t next_pid = Process::current().pid;
@@ -136,4 +159,15 @@ void schedule()
     }
 }
 
+void sleep(uint64_t ticks)
+{
+    Process::current().status = Process::Sleeping;
+
+    spin_lock(&sleep_lock);
+    sleep_queue.insert(Process::current().pid, ticks);
+    spin_unlock(&sleep_lock);
+
+    schedule();
+}
+
 }
@@ -35,8 +35,17 @@ void scheduler_init();
 
 void schedule();
 
+// parks the current process on the sleep queue for 'ticks' TSC ticks
+void sleep(uint64_t ticks);
+
+// true if a process other than the idle task is ready to run
+bool has_ready_process();
+
 extern DeltaQueue<pid_t, uint64_t> sleep_queue;
 
+// TSC ticks the idle task spent halted
+extern uint64_t halted_ticks;
+
 }
 
 #endif // SCHEDULER_HPP
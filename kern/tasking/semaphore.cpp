@@ -31,44 +31,52 @@ SOFTWARE.
 #include "scheduler.hpp"
 #include "atomic.hpp"
 
+#include "i686/interrupts/interrupts.hpp"
+
 int Semaphore::wait(uint64_t *timeout_ticks)
 {
     int result = EOK;
     bool reschedule = false;
     decltype(wait_list)::iterator waitlist_entry;
 
-    spin_lock(&lock);
-
-    if (atomic_load(&counter) <= 0)
     {
-        wait_list.push_back({&Process::current(), false});
-        waitlist_entry = --wait_list.end();
-        Process::current().status = Process::IOWait;
+        IrqGuard guard;
+        spin_lock(&lock);
 
-        // if a timeout was set, register it
-        if (timeout_ticks)
+        if (atomic_load(&counter) <= 0)
         {
-            Process::current().status_info.timeout_action = Semaphore::remove_timed_out_process_entry_point;
-            Process::current().status_info.timeout_action_arg = this;
+            wait_list.push_back({&Process::current(), false});
+            waitlist_entry = --wait_list.end();
+            Process::current().status = Process::IOWait;
 
-            tasking::sleep_queue.insert(Process::current().pid, *timeout_ticks);
-        }
+            // if a timeout was set, register it
+            if (timeout_ticks)
+            {
+                Process::current().status_info.timeout_action = Semaphore::remove_timed_out_process_entry_point;
+                Process::current().status_info.timeout_action_arg = this;
 
-        reschedule = true;
-    }
+                tasking::sleep_queue.insert(Process::current().pid, *timeout_ticks);
+            }
 
-    atomic_dec(&counter);
+            reschedule = true;
+        }
 
-    spin_unlock(&lock);
+        atomic_dec(&counter);
+
+        spin_unlock(&lock);
+    }
 
     if (reschedule)
     {
         tasking::schedule();
 
+        IrqGuard guard;
+        spin_lock(&lock);
         if (waitlist_entry->timed_out)
             result = ETIMEDOUT;
         // cleanup
         wait_list.erase(waitlist_entry);
+        spin_unlock(&lock);
     }
 
     return result;
@@ -76,6 +84,7 @@ int Semaphore::wait(uint64_t *timeout_ticks)
 
 bool Semaphore::try_wait()
 {
+    IrqGuard guard;
     spin_lock(&lock);
 
     if (atomic_load(&counter) <= 0)
@@ -102,8 +111,20 @@ Semaphore::~Semaphore()
 
 void Semaphore::post()
 {
-    bool reschedule = false;
+    if (wake())
+        tasking::schedule();
+}
 
+void Semaphore::post_deferred()
+{
+    wake();
+}
+
+bool Semaphore::wake()
+{
+    bool woken = false;
+
+    IrqGuard guard;
     spin_lock(&lock);
 
     atomic_inc(&counter);
@@ -112,13 +133,12 @@ void Semaphore::post()
     {
         wait_list.front().proc->status = Process::Active;
         //wait_list.pop_front();
-        reschedule = true;
+        woken = true;
     }
 
     spin_unlock(&lock);
 
-    if (reschedule)
-        tasking::schedule();
+    return woken;
 }
 
 void Semaphore::remove_timed_out_process(const Process *proc)
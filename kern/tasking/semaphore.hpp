@@ -39,6 +39,8 @@ public:
     ~Semaphore();
 
     void post();
+    // post() for the interrupt and softirq contexts : the waiter is woken up but only runs at the next schedule
+    void post_deferred();
 
     // if null, no timeout
     // returns ETIMEOUT if timed out
@@ -48,6 +50,8 @@ public:
     int count() const;
 
 private:
+    // returns true if a waiter was woken up
+    bool wake();
     void remove_timed_out_process(const Process* proc);
     static void remove_timed_out_process_entry_point(const Process* proc, void* semaphore);
 
@@ -59,6 +63,7 @@ private:
     };
 
 private:
+    // only taken with interrupts disabled, post_deferred() can interrupt the other members
     spinlock_t lock = 0;
     volatile int counter = 0;
     std::list<wait_entry> wait_list;
@@ -35,9 +35,19 @@ SOFTWARE.
 
 SharedMemorySegment::SharedMemorySegment(size_t size_in_pages)
 {
+    assert(size_in_pages > 0);
+
     for (size_t i { 0 }; i < size_in_pages; ++i)
     {
-        m_phys_addrs.emplace_back(Memory::allocate_physical_page());
+        uintptr_t phys_addr = Memory::allocate_physical_page();
+        assert(phys_addr);
+
+        // the segment is visible to other processes, don't leak stale data through it
+        auto ptr = Memory::mmap(phys_addr, Memory::page_size());
+        zero_page(ptr);
+        Memory::unmap(ptr, Memory::page_size());
+
+        m_phys_addrs.emplace_back(phys_addr);
     }
 
     log_serial("SHM creation : 0x%x\n", m_phys_addrs[0]);
@@ -55,22 +65,6 @@ SharedMemorySegment::~SharedMemorySegment()
     m_phys_addrs.clear();
 }
 
-void SharedMemorySegment::map(void *v_addr, uint32_t flags)
-{
-    for (size_t i { 0 }; i < m_phys_addrs.size(); ++i)
-    {
-        Memory::map_page(m_phys_addrs[i], (uint8_t*)v_addr + i*Memory::page_size(), flags);
-    }
-}
-
-void SharedMemorySegment::unmap(void *v_addr)
-{
-    for (size_t i { 0 }; i < m_phys_addrs.size(); ++i)
-    {
-        Memory::unmap_page((uint8_t*)v_addr + i*Memory::page_size());
-    }
-}
-
 size_t SharedMemorySegment::size() const
 {
     return m_phys_addrs.size() * Memory::page_size();
@@ -80,9 +74,12 @@ static std::unordered_map<unsigned int, std::weak_ptr<SharedMemorySegment>> shml
 
 std::shared_ptr<SharedMemorySegment> create_shared_mem(unsigned int id, size_t size)
 {
-    assert(!shmlist.count(id));
+    // an expired entry can be replaced
+    assert(!get_shared_mem(id));
+
+    size_t page_count = size / Memory::page_size() + (size%Memory::page_size()?1:0);
 
-    auto ptr = std::make_shared<SharedMemorySegment>(size);
+    auto ptr = std::make_shared<SharedMemorySegment>(page_count);
     if (ptr) shmlist[id] = ptr;
     return ptr;
 }
@@ -99,7 +96,8 @@ std::shared_ptr<SharedMemorySegment> get_shared_mem(unsigned int id)
 
 unsigned int create_shared_memory_id()
 {
-    unsigned int id = 0;
+    // id 0 is IPC_PRIVATE
+    unsigned int id = 1;
     for (const auto& pair : shmlist)
     {
         if (id <= pair.first) id = pair.first + 1;
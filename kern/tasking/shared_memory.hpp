@@ -40,9 +40,9 @@ public:
     ~SharedMemorySegment();
 
 public:
-    void map(void* v_addr, uint32_t flags = Memory::Read|Memory::Write|Memory::User);
-    void unmap(void* v_addr);
+    const std::vector<uintptr_t>& physical_pages() const { return m_phys_addrs; }
 
+    size_t page_count() const { return m_phys_addrs.size(); }
     size_t size() const;
 
 private:
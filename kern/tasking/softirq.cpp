@@ -0,0 +1,110 @@
+/*
+softirq.cpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "softirq.hpp"
+
+#include "i686/interrupts/interrupts.hpp"
+
+#include "utils/logging.hpp"
+
+namespace softirq
+{
+
+namespace
+{
+QueueBase* queues { nullptr };
+int running { 0 };
+}
+
+QueueBase::QueueBase(const char *name)
+    : m_name(name)
+{
+    const bool enabled = interrupts_enabled();
+    cli();
+
+    m_next = queues;
+    queues = this;
+
+    if (enabled) sti();
+}
+
+QueueBase::~QueueBase()
+{
+    const bool enabled = interrupts_enabled();
+    cli();
+
+    for (QueueBase** queue = &queues; *queue; queue = &(*queue)->m_next)
+    {
+        if (*queue == this)
+        {
+            *queue = m_next;
+            break;
+        }
+    }
+
+    if (enabled) sti();
+}
+
+bool pending()
+{
+    for (QueueBase* queue = queues; queue; queue = queue->m_next)
+    {
+        if (atomic_load(&queue->m_pending)) return true;
+    }
+
+    return false;
+}
+
+void run()
+{
+    if (__atomic_exchange_n(&running, 1, __ATOMIC_ACQUIRE))
+    {
+        return;
+    }
+
+    // handlers can be interrupted and queue new records, loop until everything is handled
+    bool handled;
+    do
+    {
+        handled = false;
+        for (QueueBase* queue = queues; queue; queue = queue->m_next)
+        {
+            if (!__atomic_exchange_n(&queue->m_pending, false, __ATOMIC_ACQUIRE)) continue;
+
+            handled |= queue->drain();
+
+            const size_t dropped = atomic_load(&queue->m_dropped);
+            if (dropped != queue->m_reported_dropped)
+            {
+                warn("softirq queue '%s' full, %zd records dropped\n", queue->m_name, dropped - queue->m_reported_dropped);
+                queue->m_reported_dropped = dropped;
+            }
+        }
+    } while (handled);
+
+    __atomic_store_n(&running, 0, __ATOMIC_RELEASE);
+}
+
+}
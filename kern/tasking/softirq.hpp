@@ -0,0 +1,131 @@
+/*
+softirq.hpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+#ifndef SOFTIRQ_HPP
+#define SOFTIRQ_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <functional.hpp>
+
+#include "tasking/atomic.hpp"
+
+// Deferred interrupt work : an ISR only pushes a small record into its queue, the records
+// are handled later by run(), with interrupts enabled, on the way out of the outermost IRQ
+// or from the idle task
+namespace softirq
+{
+
+class QueueBase
+{
+public:
+    explicit QueueBase(const char* name);
+    virtual ~QueueBase();
+
+    QueueBase(const QueueBase&) = delete;
+    QueueBase& operator=(const QueueBase&) = delete;
+
+    const char* name() const { return m_name; }
+    size_t dropped() const { return m_dropped; }
+
+protected:
+    // returns true if records were handled
+    virtual bool drain() = 0;
+
+    void raise() { atomic_store(&m_pending, true); }
+
+protected:
+    const char* m_name;
+    size_t m_dropped { 0 };
+    size_t m_reported_dropped { 0 };
+    bool m_pending { false };
+
+private:
+    QueueBase* m_next { nullptr };
+
+    friend void run();
+    friend bool pending();
+};
+
+// Single producer (the ISR) / single consumer (run()) lock-free ring
+template <typename T, size_t Size = 64>
+class Queue : public QueueBase
+{
+    static_assert((Size & (Size-1)) == 0, "Size must be a power of two");
+
+public:
+    Queue(const char* name, std::function<void(const T&)> handler)
+        : QueueBase(name), m_handler(std::move(handler))
+    {}
+
+    // to be called from the ISR, the record is dropped if the queue is full
+    bool push(const T& record)
+    {
+        const uint32_t head = __atomic_load_n(&m_head, __ATOMIC_RELAXED);
+        if (head - __atomic_load_n(&m_tail, __ATOMIC_ACQUIRE) >= Size)
+        {
+            ++m_dropped;
+            return false;
+        }
+
+        m_records[head % Size] = record;
+        __atomic_store_n(&m_head, head + 1, __ATOMIC_RELEASE);
+        raise();
+
+        return true;
+    }
+
+private:
+    virtual bool drain() override
+    {
+        bool handled = false;
+        uint32_t tail = __atomic_load_n(&m_tail, __ATOMIC_RELAXED);
+        while (tail != __atomic_load_n(&m_head, __ATOMIC_ACQUIRE))
+        {
+            const T record = m_records[tail % Size];
+            __atomic_store_n(&m_tail, ++tail, __ATOMIC_RELEASE);
+
+            m_handler(record);
+            handled = true;
+        }
+
+        return handled;
+    }
+
+private:
+    std::function<void(const T&)> m_handler;
+    T m_records[Size];
+    uint32_t m_head { 0 };
+    uint32_t m_tail { 0 };
+};
+
+// handles the pending records of every queue, does nothing if already running
+void run();
+
+bool pending();
+
+}
+
+#endif // SOFTIRQ_HPP
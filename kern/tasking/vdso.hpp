@@ -0,0 +1,49 @@
+/*
+vdso.hpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+#ifndef VDSO_HPP
+#define VDSO_HPP
+
+#include <stdint.h>
+#include <sys/types.h>
+
+// Kernel side of the pages described in sys/vdso.h
+namespace vdso
+{
+
+void init();
+
+// physical pages to map at VDSO_CODE_ADDR and VDSO_DATA_ADDR, 0 before init()
+uintptr_t code_page();
+uintptr_t data_page();
+
+// whether __kernel_vsyscall enters the kernel through sysenter rather than int 0x80
+bool fast_syscalls();
+
+// called on every task switch, so that getpid() and gettid() see the running process
+void set_current(pid_t pid, pid_t tid);
+
+}
+
+#endif // VDSO_HPP
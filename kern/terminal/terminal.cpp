@@ -49,7 +49,13 @@ Terminal::Terminal(size_t iwidth, size_t iheight, TerminalData &data)
     m_dirty_width_per_line.resize(iheight, 0);
 }
 
+// doesn't draw, the callers flush once per write or per line
 void Terminal::put_char(char32_t c)
+{
+    process_char(c);
+}
+
+void Terminal::process_char(char32_t c)
 {
     if (m_escape_code)
     {
@@ -112,7 +118,7 @@ void Terminal::put_char(char32_t c)
     {
         for (size_t i { 0 }; i < tab_size; ++i)
         {
-            put_char(' ');
+            process_char(' ');
         }
     }
     else if (c == '\a')
@@ -182,9 +188,11 @@ void Terminal::write(const char *data, size_t size)
         if (m_decoder.ready())
         {
             char32_t c = m_decoder.spit();
-            put_char(c);
+            process_char(c);
         }
     }
+
+    draw();
 }
 
 
@@ -369,6 +377,8 @@ void Terminal::clear_line_before_write(size_t y, graphics::Color color, size_t s
 
 void Terminal::new_line()
 {
+    const bool at_bottom = view_at_bottom();
+
     if (!m_line_is_input || true)
     {
         add_line_to_history();
@@ -379,7 +389,10 @@ void Terminal::new_line()
 
     check_pos();
 
-    scroll_up();
+    if (!at_bottom || !scroll_new_line())
+    {
+        scroll_up();
+    }
 
     if (m_line_is_input)
     {
@@ -388,14 +401,60 @@ void Terminal::new_line()
         ev.line = input();
 
         kmsgbus.send(ev);
-
-        m_dirty_width_per_line[m_cursor_y] = 0;
     }
 
-    clear_line(m_cursor_y, m_data.color().bg, width());
+    const size_t input_row = m_cursor_y + m_data.title_height;
+    clear_line(input_row, m_data.color().bg, width());
+    m_dirty_width_per_line[input_row] = 0;
     m_cur_line.clear();
 }
 
+bool Terminal::view_at_bottom() const
+{
+    return m_scrolling && m_enabled && m_cursor_y == height()-1 && m_data.lines() + 1 >= height() &&
+            m_current_history_page == m_data.lines() - height() + 1;
+}
+
+// Fast path for a new line while the view follows the output : the rows already on screen are moved up in bulk
+// and only the line which just ended is drawn again, wrapped the same way show_history() does
+bool Terminal::scroll_new_line()
+{
+    const size_t line_rows = m_cur_line.size() / width() + 1;
+    const size_t top = m_data.title_height;
+
+    if (line_rows >= height() || !scroll_impl(top, line_rows))
+    {
+        return false;
+    }
+
+    for (size_t i { top }; i + line_rows < true_height(); ++i)
+    {
+        m_dirty_width_per_line[i] = m_dirty_width_per_line[i + line_rows];
+    }
+    for (size_t i { true_height() - line_rows }; i < true_height(); ++i)
+    {
+        m_dirty_width_per_line[i] = width(); // holds whatever was moved there
+    }
+
+    m_current_history_page = m_data.lines() - height() + 1;
+
+    const size_t first_row = height() - 1 - line_rows;
+    for (size_t row { 0 }; row < line_rows; ++row)
+    {
+        const size_t begin = row*width();
+        const size_t end = std::min(begin + width(), m_cur_line.size());
+
+        clear_line_before_write(first_row + row + top, m_data.color().bg, end - begin);
+        for (size_t i { begin }; i < end; ++i)
+        {
+            set_entry_at(m_cur_line[i], i - begin, first_row + row);
+        }
+    }
+
+    m_dirty = true;
+    return true;
+}
+
 void Terminal::add_line_to_history()
 {
     m_data.add_line(m_cur_line);
@@ -461,6 +520,11 @@ void Terminal::clear_screen(graphics::Color color)
     }
 }
 
+bool Terminal::scroll_impl(size_t, size_t)
+{
+    return false;
+}
+
 void Terminal::resize(size_t iwidth, size_t iheight)
 {
     assert(iwidth && iheight);
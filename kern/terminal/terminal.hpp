@@ -109,9 +109,12 @@ public:
     size_t tab_size { 4 };
 
 private:
+    void process_char(char32_t c);
     void set_entry_at(TermEntry entry, size_t x, size_t y, bool absolute = false);
     void clear_line_before_write(size_t y, graphics::Color color, size_t size);
     void new_line();
+    bool view_at_bottom() const;
+    bool scroll_new_line();
     void add_line_to_history();
     void check_pos();
     void update_cursor();
@@ -122,6 +125,8 @@ private:
     virtual void move_cursor(size_t x, size_t y) = 0;
     virtual void clear_line(size_t y, graphics::Color color, size_t size) = 0;
     virtual void clear_screen(graphics::Color color);
+    // moves the rows [top+lines, true_height()) up to 'top', returns false if the terminal can't do it
+    virtual bool scroll_impl(size_t top, size_t lines);
     virtual void putchar(size_t x, size_t y, TermEntry entry) = 0;
     virtual void draw_impl() = 0;
     virtual void disable_impl() = 0;
@@ -60,11 +60,29 @@ Date to_local_time(Date utc_date);
 Date from_unix(size_t epoch);
 size_t to_unix(const Date& date);
 
-double uptime();
-uint64_t clock_speed();
+uint64_t clock_speed(); // MHz
 uint64_t total_ticks();
 
+// Fixed-point TSC clocksource : ns = (ticks * mult) >> shift, with mult and shift
+// computed once from the TSC frequency calibrated against the PIT
+uint64_t tsc_khz();
+uint64_t ticks_to_ns(uint64_t ticks);
+uint64_t ns_to_ticks(uint64_t ns);
+
+struct ClockSourceInfo
+{
+    uint64_t base_ticks; // TSC value at uptime 0
+    uint32_t mult;
+    uint32_t shift;
+};
+ClockSourceInfo clocksource_info();
+
+// monotonic time since the timer was set up
+uint64_t uptime_ns();
+inline uint64_t uptime_us() { return uptime_ns() / 1000; }
+
 size_t epoch();
+size_t boot_epoch(); // unix time at uptime 0
 
 const char *to_string(const Date& date);
 
@@ -0,0 +1,289 @@
+/*
+timer.cpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "timer.hpp"
+
+#include "time/time.hpp"
+#include "tasking/process.hpp"
+#include "tasking/scheduler.hpp"
+
+#include "i686/interrupts/interrupts.hpp"
+
+namespace
+{
+constexpr uint64_t spin_us = 50; // hardware polls usually succeed right away, don't sleep for them
+constexpr uint64_t max_idle_ms = 1000; // upper bound of a one-shot period, keeps a slow heartbeat when idle
+
+bool can_block()
+{
+#ifdef ARCH_i686
+    return Process::has_current() && interrupts_enabled();
+#else
+    return Process::has_current();
+#endif
+}
+
+// waits until the TSC reaches 'deadline', halting between the timer interrupts
+void wait_until(uint64_t deadline)
+{
+    while (Time::total_ticks() < deadline)
+    {
+        Timer::request_wakeup(deadline);
+        wait_for_interrupts();
+    }
+}
+}
+
+void Timer::sleep(uint32_t time)
+{
+    usleep(uint64_t(time) * 1000);
+}
+
+void Timer::usleep(uint64_t time)
+{
+    if (!Time::timer_ready)
+    {
+        uint32_t interval = time/(1'000'000/freq());
+        uint32_t start = m_ticks;
+        while ((m_ticks - start) < interval) { wait_for_interrupts(); }
+        return;
+    }
+
+    const uint64_t ticks = Time::ns_to_ticks(time * 1000);
+    if (can_block())
+    {
+        tasking::sleep(ticks);
+        return;
+    }
+
+    wait_until(Time::total_ticks() + ticks);
+}
+
+void Timer::udelay(uint64_t time)
+{
+    const uint64_t deadline = Time::total_ticks() + Time::ns_to_ticks(time * 1000);
+    while (Time::total_ticks() < deadline) { nop(); }
+}
+
+bool Timer::sleep_until(const std::function<bool()>& callback, uint32_t timeout)
+{
+    if (!Time::timer_ready)
+    {
+        uint32_t interval = timeout/(1000/freq());
+        uint32_t start = m_ticks;
+        while (!callback() && (timeout == 0 || (m_ticks - start) < interval)) { nop(); }
+
+        return callback();
+    }
+
+    const uint64_t start = Time::total_ticks();
+    const uint64_t spin_ticks = Time::ns_to_ticks(spin_us * 1000);
+    const uint64_t timeout_ticks = Time::ns_to_ticks(uint64_t(timeout) * 1'000'000);
+    const uint64_t poll_ticks = Time::ns_to_ticks(1'000'000'000 / freq());
+
+    while (!callback())
+    {
+        const uint64_t elapsed = Time::total_ticks() - start;
+        if (timeout && elapsed >= timeout_ticks)
+        {
+            return callback();
+        }
+
+        if (elapsed < spin_ticks || !can_block())
+        {
+            nop();
+        }
+        else
+        {
+            tasking::sleep(poll_ticks);
+        }
+    }
+
+    return true;
+}
+
+bool Timer::sleep_until_int(const std::function<bool()>& callback, uint32_t timeout)
+{
+    // if the condition is already true, don't wait for an inexistent interrupt
+    if (callback()) return true;
+
+    if (timeout == 0)
+    {
+        while (!callback()) { wait_for_interrupts(); }
+    }
+    else if (!Time::timer_ready)
+    {
+        uint32_t interval = timeout/(1000/freq());
+        uint32_t start = m_ticks;
+        while (!callback() && (m_ticks - start) < interval) { wait_for_interrupts(); }
+    }
+    else
+    {
+        const uint64_t deadline = Time::total_ticks() + Time::ns_to_ticks(uint64_t(timeout) * 1'000'000);
+        while (!callback() && Time::total_ticks() < deadline)
+        {
+            request_wakeup(deadline);
+            wait_for_interrupts();
+        }
+    }
+
+    return callback();
+}
+
+Timer::CallbackHandle Timer::register_callback(uint32_t duration, std::function<void()> callback, bool oneshot)
+{
+    if (!freq())
+    {
+        return m_callbacks.end();
+    }
+
+    const uint64_t period = Time::ns_to_ticks(uint64_t(duration) * 1'000'000);
+    const uint64_t now = Time::total_ticks();
+
+    IrqGuard guard; // the callback list and the deadlines are shared with the timer interrupt
+
+    m_callbacks.emplace_back(now + period, period, std::move(callback), oneshot);
+    update_next_callback();
+    if (m_next_callback < m_armed && tickless())
+    {
+        program_next_event(now);
+    }
+
+    return std::prev(m_callbacks.end());
+}
+
+void Timer::remove_callback(const CallbackHandle& it)
+{
+    IrqGuard guard;
+
+    m_callbacks.erase(it);
+    update_next_callback();
+}
+
+void Timer::request_wakeup(uint64_t deadline)
+{
+    IrqGuard guard;
+
+    if (deadline < m_next_wakeup)
+    {
+        m_next_wakeup = deadline;
+    }
+    if (deadline < m_armed && tickless())
+    {
+        program_next_event(Time::total_ticks());
+    }
+}
+
+uint32_t Timer::ticks()
+{
+    if (!tickless())
+    {
+        return m_ticks;
+    }
+
+    const uint64_t elapsed_ns = Time::ticks_to_ns(Time::total_ticks() - m_tickless_start);
+    return m_tickless_start_ticks + elapsed_ns * freq() / 1'000'000'000;
+}
+
+void Timer::irq_callback()
+{
+    ++m_ticks;
+
+    const uint64_t now = Time::total_ticks();
+    if (now >= m_next_callback)
+    {
+        handle_callbacks(now);
+    }
+    if (now >= m_next_wakeup)
+    {
+        m_next_wakeup = no_deadline;
+    }
+}
+
+void Timer::set_oneshot_device(std::function<void(uint64_t)> program)
+{
+    IrqGuard guard;
+
+    m_tickless_start_ticks = m_ticks;
+    m_tickless_start = Time::total_ticks();
+    m_program_oneshot_callback = std::move(program);
+
+    program_next_event(m_tickless_start);
+}
+
+void Timer::oneshot_callback()
+{
+    const uint64_t now = Time::total_ticks();
+
+    m_armed = no_deadline;
+    if (now >= m_next_callback)
+    {
+        handle_callbacks(now);
+    }
+    if (now >= m_next_wakeup)
+    {
+        m_next_wakeup = no_deadline;
+    }
+
+    program_next_event(now);
+}
+
+void Timer::handle_callbacks(uint64_t now)
+{
+    for (auto& callback : m_callbacks)
+    {
+        if (now >= callback.deadline)
+        {
+            callback.callback();
+            callback.deadline = now + callback.period;
+            if (callback.oneshot)
+            {
+                callback.to_be_deleted = true;
+            }
+        }
+    }
+
+    // remove used callbacks
+    m_callbacks.remove_if([](const Callback& c) { return c.to_be_deleted;});
+
+    update_next_callback();
+}
+
+void Timer::update_next_callback()
+{
+    m_next_callback = no_deadline;
+    for (const auto& callback : m_callbacks)
+    {
+        m_next_callback = std::min(m_next_callback, callback.deadline);
+    }
+}
+
+void Timer::program_next_event(uint64_t now)
+{
+    const uint64_t next = std::min({m_next_callback, m_next_wakeup, now + Time::ns_to_ticks(max_idle_ms * 1'000'000)});
+
+    m_armed = next;
+    m_program_oneshot_callback(next);
+}
@@ -44,15 +44,15 @@ private:
     {
         Callback() = default;
 
-        Callback(uint32_t istart, uint32_t iduration, std::function<void()> icallback, bool ioneshot)
-            : start(istart), duration(iduration), callback(std::move(icallback)),
+        Callback(uint64_t ideadline, uint64_t iperiod, std::function<void()> icallback, bool ioneshot)
+            : deadline(ideadline), period(iperiod), callback(std::move(icallback)),
               oneshot(ioneshot)
         {
 
         }
 
-        uint32_t start;
-        uint32_t duration;
+        uint64_t deadline; // in TSC ticks
+        uint64_t period;
         std::function<void()> callback;
         bool oneshot;
         bool to_be_deleted { false };
@@ -76,112 +76,72 @@ public:
         m_set_frequency_callback(freq);
     }
 
-    // time in ms
-    static inline void sleep(uint32_t time)
-    {
-        uint32_t interval = time/(1000/freq());
-        uint32_t start = m_ticks;
-        while ((m_ticks - start) < interval) { wait_for_interrupts(); }
-    }
-
-    static inline bool sleep_until(const std::function<bool()>& callback, uint32_t timeout = 0)
-    {
-        uint32_t interval = timeout/(1000/freq());
-        uint32_t start = m_ticks;
-        if (timeout == 0)
-        {
-            while (!callback()) { nop(); }
-        }
-        else
-        {
-            while (!callback() && (m_ticks - start) < interval) { nop(); }
-        }
+    // time in ms ; parks the calling process once the scheduler is running, waits for the timer interrupts otherwise
+    static void sleep(uint32_t time);
 
-        return callback();
-    }
+    // time in µs ; same as sleep(), but only a one-shot timer gives it more than tick resolution
+    static void usleep(uint64_t time);
 
-    static inline bool sleep_until_int(const std::function<bool()>& callback, uint32_t timeout = 0)
-    {
-        // if the condition is already true, don't wait for an inexistent interrupt
-        if (callback()) return true;
+    // busy-waits 'time' µs on the TSC, for the callers that are not allowed to sleep
+    static void udelay(uint64_t time);
 
-        uint32_t interval = timeout/(1000/freq());
-        int32_t start = m_ticks;
-        if (timeout == 0)
-        {
-            while (!callback()) { wait_for_interrupts(); }
-        }
-        else
-        {
-            while (!callback() && (m_ticks - start) < interval) { wait_for_interrupts(); }
-        }
+    // polls 'callback' until it returns true or 'timeout' ms elapsed (0 : no timeout) ;
+    // after a short spin, the calling process sleeps one tick between polls
+    static bool sleep_until(const std::function<bool()>& callback, uint32_t timeout = 0);
 
-        return callback();
-    }
+    // halts between polls, relying on an interrupt to make 'callback' true
+    static bool sleep_until_int(const std::function<bool()>& callback, uint32_t timeout = 0);
 
     // time in ms
-    static inline CallbackHandle register_callback(uint32_t duration, std::function<void()> callback, bool oneshot = true)
-    {
-        if (freq())
-        {
-            m_callbacks.emplace_back(m_ticks, duration/(1000/freq()), callback, oneshot);
-            return std::prev(m_callbacks.end());
-        }
-        else
-        {
-            return m_callbacks.end();
-        }
-    }
+    static CallbackHandle register_callback(uint32_t duration, std::function<void()> callback, bool oneshot = true);
 
-    static inline void remove_callback(const CallbackHandle& it)
-    {
-        m_callbacks.erase(it);
-    }
+    static void remove_callback(const CallbackHandle& it);
 
-    static inline uint32_t ticks()
-    {
-        return m_ticks;
-    }
+    // makes sure a timer interrupt fires at or after the TSC timestamp 'deadline' ; only needed when tickless
+    static void request_wakeup(uint64_t deadline);
+
+    // ticks at freq() Hz since the timer was set up ; derived from the TSC when tickless
+    static uint32_t ticks();
 
     static inline uint32_t freq()
     {
         return m_freq;
     }
 
+    // true once a one-shot event device replaced the periodic tick
+    static inline bool tickless()
+    {
+        return (bool)m_program_oneshot_callback;
+    }
+
     static inline std::function<void(uint32_t)> m_set_frequency_callback;
 
 protected:
-    static inline void irq_callback()
-    {
-        ++m_ticks;
-        // do not always check, it is costly
-        if ((m_ticks % 64) == 0) handle_callbacks();
-    }
+    // periodic tick
+    static void irq_callback();
 
-private:
-    static inline void handle_callbacks()
-    {
-        for (auto& callback : m_callbacks)
-        {
-            if (m_ticks - callback.start >= callback.duration)
-            {
-                callback.callback();
-                callback.start = m_ticks;
-                if (callback.oneshot)
-                {
-                    callback.to_be_deleted = true;
-                }
-            }
-        }
+    // one-shot expiry ; the event device's 'program' callback arms it for an absolute TSC deadline
+    static void set_oneshot_device(std::function<void(uint64_t)> program);
+    static void oneshot_callback();
 
-        // remove used callbacks
-        m_callbacks.remove_if([](const Callback& c) { return c.to_be_deleted;});
-    }
+private:
+    static void handle_callbacks(uint64_t now);
+    static void update_next_callback();
+    static void program_next_event(uint64_t now);
 
 private:
+    static constexpr uint64_t no_deadline { ~0ULL };
+
     static inline std::list<Callback> m_callbacks;
     static inline volatile uint32_t m_ticks { 0 };
     static inline uint32_t m_freq { 0 };
+
+    static inline std::function<void(uint64_t)> m_program_oneshot_callback;
+    static inline uint64_t m_next_callback { no_deadline }; // earliest callback deadline
+    static inline uint64_t m_next_wakeup { no_deadline };   // earliest requested wakeup
+    static inline uint64_t m_armed { no_deadline };         // deadline the event device is programmed for
+    static inline uint64_t m_tickless_start { 0 };          // TSC value when switching to the one-shot device
+    static inline uint32_t m_tickless_start_ticks { 0 };
 };
 
 #endif // TIMER_HPP
@@ -66,7 +66,8 @@ public:
         }
     }
 
-    void add(T entry)
+    // the slot is assigned in place, so a slot keeps its storage once the buffer wrapped
+    void add(const T& entry)
     {
         m_data[m_front++] = entry;
 
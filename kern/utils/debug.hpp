@@ -39,14 +39,14 @@ void benchmark(const std::function<void()>& fun, const kpp::string& description,
 {
     kprintf("Benchmarking function %s\n", description.c_str());
 
-    double beg = Time::uptime();
+    const uint64_t beg = Time::uptime_us();
     while (repetitions--)
     {
         fun();
     }
-    double end = Time::uptime();
+    const uint64_t elapsed = Time::uptime_us() - beg;
 
-    kprintf("Elapsed secs : %f\n", end - beg);
+    kprintf("Elapsed secs : %lu.%06lu\n", (unsigned long)(elapsed / 1'000'000), (unsigned long)(elapsed % 1'000'000));
 }
 
 #endif // DEBUG_HPP
@@ -42,6 +42,10 @@ public:
     bool find(const T& el) const;
     std::vector<T> elements() const;
 
+    bool empty() const { return m_list.empty(); }
+    // remaining duration before the first element is popped
+    S front_delay() const { return m_list.front().second; }
+
 private:
     std::function<void(const T&)> m_pop_callback;
     std::list<std::pair<T, S>> m_list;
@@ -0,0 +1,286 @@
+/*
+klog.cpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "klog.hpp"
+
+#include <string.h>
+#include <stdio.h>
+
+#include "terminal/terminal.hpp"
+
+#ifdef ARCH_i686
+#include "i686/pc/serial/serialdebug.hpp"
+#endif
+
+#include "tasking/atomic.hpp"
+#include "tasking/process.hpp"
+#include "tasking/process_data.hpp"
+#include "tasking/scheduler.hpp"
+#include "tasking/semaphore.hpp"
+#include "time/time.hpp"
+
+#include <kstring/kstring.hpp>
+
+namespace klog
+{
+
+namespace
+{
+
+enum RecordFlags : uint8_t
+{
+    First = 1<<0 // first record of a message, gets the prefix
+};
+
+struct Record
+{
+    uint32_t seq; // index of the record + 1 once complete, 0 or the number of a previous lap while being written
+    Type type;
+    uint8_t targets;
+    uint8_t len;
+    uint8_t flags;
+    uint64_t timestamp;
+    char text[record_size - 16];
+};
+static_assert(sizeof(Record) == record_size);
+
+constexpr size_t text_size = sizeof(Record::text);
+
+Record ring[record_count];
+
+uint32_t head { 0 }; // next record index to be reserved by a producer
+uint32_t tail { 0 }; // next record index to be drained
+int draining { 0 };
+bool drain_task_running { false };
+bool wakeup_pending { false };
+Semaphore drain_wakeup; // posted once per batch of records committed after a drain
+size_t lost { 0 };
+
+struct Writer
+{
+    Type type;
+    uint8_t targets;
+    uint8_t flags;
+    uint8_t len;
+    uint64_t timestamp;
+    char text[text_size];
+};
+
+void commit(Writer& writer)
+{
+    const uint32_t index = atomic_fetch_add(&head, 1);
+    Record& rec = ring[index % record_count];
+
+    // the slot still holds the previous lap's number until here, readers only accept seq == index + 1 so they can't
+    // mistake it for the new record ; the fence keeps the body from being written before the slot is invalidated
+    atomic_store(&rec.seq, 0);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    rec.type      = writer.type;
+    rec.targets   = writer.targets;
+    rec.len       = writer.len;
+    rec.flags     = writer.flags;
+    rec.timestamp = writer.timestamp;
+    memcpy(rec.text, writer.text, writer.len);
+    atomic_store(&rec.seq, index + 1);
+
+    writer.len = 0;
+    writer.flags &= ~First;
+}
+
+void put(void* ptr, char c)
+{
+    auto& writer = *static_cast<Writer*>(ptr);
+
+    writer.text[writer.len++] = c;
+    if (writer.len == text_size)
+    {
+        commit(writer);
+    }
+}
+
+// copies the record 'index' into 'out', returns false if it has been overwritten in the meantime
+bool fetch(uint32_t index, Record& out)
+{
+    const Record& rec = ring[index % record_count];
+
+    if (atomic_load(&rec.seq) != index + 1)
+    {
+        return false;
+    }
+    out = rec;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return atomic_load(&rec.seq) == index + 1;
+}
+
+void output(const Record& rec)
+{
+#ifdef ARCH_i686
+    if (rec.targets & Serial)
+    {
+        serial::debug::write_raw(rec.text, rec.len);
+    }
+#endif
+
+    if (rec.targets & Terminal)
+    {
+        bool colored = rec.type == Warning || rec.type == Error;
+        if (colored)
+        {
+            term_data().push_color({rec.type == Warning ? 0xffff55u : 0xaa0000u, 0});
+        }
+        if (rec.flags & First && rec.type != Raw)
+        {
+            term_data().push_color({0x00aa00, 0});
+            kprintf("%s", rec.type == Log ? "[I] " : rec.type == Warning ? "[W] " : "[E] ");
+            term_data().pop_color();
+        }
+        for (size_t i { 0 }; i < rec.len; ++i)
+        {
+            putchar(rec.text[i]);
+        }
+        if (colored)
+        {
+            term_data().pop_color();
+        }
+    }
+}
+
+}
+
+void vwrite(Type type, uint8_t targets, const char* __restrict fmt, va_list va)
+{
+    Writer writer;
+    writer.type = type;
+    writer.targets = targets;
+    writer.flags = First;
+    writer.len = 0;
+    writer.timestamp = Time::total_ticks();
+
+    tfp_format(&writer, put, fmt, va);
+    if (writer.len || writer.flags & First)
+    {
+        commit(writer);
+    }
+
+    if (!atomic_load(&drain_task_running))
+    {
+        drain();
+    }
+    else if (!__atomic_exchange_n(&wakeup_pending, true, __ATOMIC_ACQ_REL))
+    {
+        drain_wakeup.post_deferred(); // we may be in an interrupt handler
+    }
+}
+
+void drain()
+{
+    if (__atomic_exchange_n(&draining, 1, __ATOMIC_ACQUIRE))
+    {
+        return; // reentered from an interrupt handler, the outer call will handle the new records
+    }
+
+    uint32_t current_head;
+    while (tail != (current_head = atomic_load(&head)))
+    {
+        if (current_head - tail > record_count)
+        {
+            lost += current_head - tail - record_count;
+            tail = current_head - record_count;
+        }
+
+        const Record& rec = ring[tail % record_count];
+        const uint32_t seq = atomic_load(&rec.seq);
+        if (seq == 0 || int32_t(seq - (tail + 1)) < 0)
+        {
+            break; // reserved but not published yet, the slot may still hold the previous lap's record
+        }
+
+        Record copy;
+        if (!fetch(tail, copy))
+        {
+            ++lost;
+        }
+        else
+        {
+            output(copy);
+        }
+        ++tail;
+    }
+
+    __atomic_store_n(&draining, 0, __ATOMIC_RELEASE);
+}
+
+void start_drain_task()
+{
+    auto task = Process::create_kernel_task([]
+    {
+        while (true)
+        {
+            // cleared first, so that a record committed during the drain posts the semaphore again
+            __atomic_store_n(&wakeup_pending, false, __ATOMIC_RELEASE);
+            drain();
+
+            drain_wakeup.wait();
+        }
+    });
+    task->data->name = "klogd";
+
+    atomic_store(&drain_task_running, true);
+}
+
+kpp::string dump()
+{
+    kpp::string str;
+
+    const uint32_t current_head = atomic_load(&head);
+    uint32_t index = current_head > record_count ? current_head - record_count : 0;
+
+    for (; index != current_head; ++index)
+    {
+        Record rec;
+        if (!fetch(index, rec))
+        {
+            continue;
+        }
+
+        if (rec.flags & First)
+        {
+            const uint64_t us = rec.timestamp / Time::clock_speed();
+            char stamp[32];
+            ksnprintf(stamp, sizeof(stamp), "[%5u.%06u] ", uint32_t(us / 1'000'000), uint32_t(us % 1'000'000));
+            str += stamp;
+        }
+        str.append(rec.text, rec.len);
+    }
+
+    return str;
+}
+
+size_t lost_records()
+{
+    return atomic_load(&lost);
+}
+
+}
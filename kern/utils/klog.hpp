@@ -0,0 +1,74 @@
+/*
+klog.hpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+#ifndef KLOG_HPP
+#define KLOG_HPP
+
+#include <stdint.h>
+#include <stdarg.h>
+
+#include "kstring/kstrfwd.hpp"
+
+// Kernel log ring buffer
+// Producers only format their message into fixed-size records and never block,
+// the records are written to the serial port and to the terminal later on by klog::drain()
+// Once the drain task runs, log() output is thus deferred and can appear after text printed directly
+// with kprintf() in the meantime : call klog::drain() before such a direct print if the order matters
+namespace klog
+{
+
+enum Type : uint8_t
+{
+    Log,
+    Warning,
+    Error,
+    Raw
+};
+
+enum Target : uint8_t
+{
+    Serial   = 1<<0,
+    Terminal = 1<<1
+};
+
+constexpr size_t record_size  = 128;
+constexpr size_t record_count = 1024;
+
+void vwrite(Type type, uint8_t targets, const char* __restrict fmt, va_list va);
+
+// writes the pending records to their targets
+void drain();
+
+// from now on records are drained by a kernel task instead of by the producers themselves
+void start_drain_task();
+
+// whole content of the ring, used by /proc/kmsg
+kpp::string dump();
+
+// records overwritten before being drained
+size_t lost_records();
+
+}
+
+#endif // KLOG_HPP
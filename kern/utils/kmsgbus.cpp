@@ -25,4 +25,39 @@ SOFTWARE.
 
 #include "kmsgbus.hpp"
 
+#include "tasking/process.hpp"
+#include "tasking/process_data.hpp"
+#include "tasking/semaphore.hpp"
+#include "utils/logging.hpp"
+
 MessageBus kmsgbus;
+
+namespace
+{
+Semaphore kmsgbus_wakeup; // posted when messages become pending, post() may come from a softirq
+}
+
+void start_kmsgbus_task()
+{
+    kmsgbus.set_post_notifier([]{ kmsgbus_wakeup.post_deferred(); });
+
+    auto task = Process::create_kernel_task([]
+    {
+        size_t reported_drops = 0;
+        while (true)
+        {
+            kmsgbus.dispatch_posted();
+
+            if (kmsgbus.dropped_messages() != reported_drops)
+            {
+                warn("kmsgbus : %zd posted messages dropped, a subscriber queue was full\n",
+                     kmsgbus.dropped_messages() - reported_drops);
+                reported_drops = kmsgbus.dropped_messages();
+            }
+
+            // the messages posted before the notifier was set are handled by the first dispatch
+            kmsgbus_wakeup.wait();
+        }
+    });
+    task->data->name = "kmsgbusd";
+}
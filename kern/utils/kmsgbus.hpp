@@ -29,4 +29,7 @@ SOFTWARE.
 
 extern MessageBus kmsgbus;
 
+// starts the kernel task calling the asynchronous kmsgbus subscribers
+void start_kmsgbus_task();
+
 #endif // KMSGBUS_HPP
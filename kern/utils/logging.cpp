@@ -25,74 +25,45 @@ SOFTWARE.
 
 #include "logging.hpp"
 
-#include "terminal/terminal.hpp"
-
-#ifdef ARCH_i686
-#include "i686/pc/serial/serialdebug.hpp"
-#endif
+#include "klog.hpp"
 
 #include "utils/env.hpp"
 #include "utils/stlutils.hpp"
 
-#include "time/time.hpp"
-
 LoggingLevel log_level = Debug;
 
 void log(LoggingLevel level, const char * __restrict fmt, ...)
 {
     if (level <= log_level)
     {
-        term_data().push_color({0x00aa00, 0});
-        //kprintf("[%f] ", Time::uptime());
-        kprintf("[I] ");
-        term_data().pop_color();
-
         va_list va;
         va_start(va, fmt);
-        kvprintf(fmt, va);
+        klog::vwrite(klog::Log, klog::Terminal, fmt, va);
         va_end(va);
     }
 }
 
 void warn(const char * __restrict fmt, ...)
 {
-    term_data().push_color({0xffff55, 0});
-
-    term_data().push_color({0x00aa00, 0});
-    //kprintf("[%f] ", Time::uptime());
-    kprintf("[W] ");
-    term_data().pop_color();
-
     va_list va;
     va_start(va, fmt);
-    tfp_format(nullptr, [](void*, char c){putchar(c); log_serial("%c", c);}, fmt, va);
+    klog::vwrite(klog::Warning, klog::Terminal | klog::Serial, fmt, va);
     va_end(va);
-
-    term_data().pop_color();
 }
 
 void err(const char * __restrict fmt, ...)
 {
-    term_data().push_color({0xaa0000, 0});
-
-    term_data().push_color({0x00aa00, 0});
-    //kprintf("[%f] ", Time::uptime());
-    kprintf("[E] ");
-    term_data().pop_color();
-
     va_list va;
     va_start(va, fmt);
-    tfp_format(nullptr, [](void*, char c){putchar(c); log_serial("%c", c);}, fmt, va);
+    klog::vwrite(klog::Error, klog::Terminal | klog::Serial, fmt, va);
     va_end(va);
-
-    term_data().pop_color();
 }
 
 void log_serial(const char * __restrict fmt, ...)
 {
     va_list va;
     va_start(va, fmt);
-    tfp_format(nullptr, [](void*, char c){serial::debug::write("%c", c);}, fmt, va);
+    klog::vwrite(klog::Raw, klog::Serial, fmt, va);
     va_end(va);
 }
 
@@ -28,17 +28,39 @@ SOFTWARE.
 #include <stdint.h>
 #include <assert.h>
 
+#include <type_traits.hpp>
+
+#include <kstring/kstring.hpp>
+
 #include "mem/memmap.hpp"
+#include "mem/uaccess.hpp"
 
 template <typename T>
 struct user_ptr
 {
-    // TODO : string check
     bool check(size_t size = sizeof(T)) const
     {
         return Memory::check_user_ptr((const void*)ptr, size);
     }
 
+    // Copy the pointee from or to user memory, return false if it isn't accessible
+    template <typename U = std::remove_const_t<T>>
+    [[nodiscard]] bool read(U& val) const
+    {
+        return copy_from_user(&val, ptr, sizeof(U)) == 0;
+    }
+    template <typename U = T>
+    [[nodiscard]] bool write(const U& val) const
+    {
+        return copy_to_user((void*)ptr, &val, sizeof(U)) == 0;
+    }
+
+    // Copy the pointed null-terminated string, fails with EFAULT or ENAMETOOLONG
+    kpp::expected<kpp::string, int> str(size_t max_len = PATH_MAX) const
+    {
+        return user_string((const char*)ptr, max_len);
+    }
+
     T* get()
     {
         assert(check());
@@ -27,6 +27,8 @@ SOFTWARE.
 
 #include "pp_utils.h"
 
+#include <sys/vdso.h>
+
 #define ASMFMT_0()
 #define ASMFMT_1(arg1) \
     , "b" (arg1)
@@ -42,10 +44,32 @@ SOFTWARE.
 , "b" (arg1), "c" (arg2), "d" (arg3), "S" (arg4), "D" (arg5), "bp" (arg6)
 
 #define DO_LINUX_SYSCALL(sys_no, cnt, ...) \
+        DO_VSYSCALL_IMPL(sys_no, cnt, __VA_ARGS__)
+// __kernel_vsyscall restores registers from the stack it was called with,
+// system calls switching to another user stack (clone) must trap directly
+#define DO_LINUX_INT80_SYSCALL(sys_no, cnt, ...) \
         DO_SYSCALL_IMPL(0x80, sys_no, cnt, __VA_ARGS__)
 #define DO_LUDOS_SYSCALL(sys_no, cnt, ...) \
         DO_SYSCALL_IMPL(0x70, sys_no, cnt, __VA_ARGS__)
 
+// ebp can't be an asm operand : the sixth argument is loaded in it around the trap, from memory pointed to by eax
+#define DO_LINUX_SYSCALL6(sys_no, arg1, arg2, arg3, arg4, arg5, arg6) \
+    ({ \
+    const unsigned long sys_args[2] = { sys_no, (unsigned long)(arg6) }; \
+    int ret_val; \
+    asm volatile \
+    ("push %%ebp\n" \
+     "mov 4(%%eax), %%ebp\n" \
+     "mov (%%eax), %%eax\n" \
+     "int $0x80\n" \
+     "pop %%ebp\n" \
+    :"=a"(ret_val) \
+    :"a"(sys_args), "b"(arg1), "c"(arg2), "d"(arg3), "S"(arg4), "D"(arg5)\
+    :"memory"\
+    );\
+    ret_val; \
+    })
+
 #define DO_SYSCALL_IMPL(int_no, sys_no, cnt, ...) \
     ({ \
     int ret_val; \
@@ -59,4 +83,19 @@ SOFTWARE.
     );\
     ret_val; \
     })
+
+// goes through the vDSO, which enters the kernel with sysenter when the cpu supports it
+#define DO_VSYSCALL_IMPL(sys_no, cnt, ...) \
+    ({ \
+    int ret_val; \
+    asm volatile \
+    ("mov %1, %%eax\n" \
+     "call %P2\n" \
+    :"=a"(ret_val) \
+    :"i"(sys_no), "i"(VDSO_VSYSCALL)\
+    ASMFMT_##cnt(__VA_ARGS__)\
+    :"memory"\
+    );\
+    ret_val; \
+    })
 #endif // DO_SYSCALL_H
@@ -27,14 +27,33 @@ SOFTWARE.
 
 #include <stdint.h>
 
+// copies and fills of at least this size use non-temporal stores, their destination wouldn't stay in the cache anyway
+#define NON_TEMPORAL_THRESHOLD 0x40000
+
 void* _naive_memcpy(void* __restrict dstptr, const void* __restrict srcptr, size_t size);
+void * _repmovsb_memcpy(void * __restrict dest, const void * __restrict src, size_t n);
+void * _repmovsl_memcpy(void * __restrict dest, const void * __restrict src, size_t n);
+void * _movsl_memcpy(void * __restrict dest, const void * __restrict src, size_t n);
+void * _erms_memcpy(void * __restrict dest, const void * __restrict src, size_t n);
 void * _memcpy_mmx (void *v_to, const void *v_from, size_t len);
-void * _memcpy_sse2 (void *v_to, const void *v_from, size_t len);
+void * _memcpy_sse2 (void * __restrict v_to, const void * __restrict v_from, size_t len);
 void * _aligned_memcpy_sse2 (void * __restrict v_to, const void * __restrict v_from, size_t len);
+void * _stream_memcpyl_sse2 (void * __restrict v_to, const void * __restrict v_from, size_t len);
+
+// copy_page and zero_page work on 4 KiB pages, 16-byte aligned at least
+void _copy_page_movsl(void * __restrict dest, const void * __restrict src);
+void _copy_page_erms(void * __restrict dest, const void * __restrict src);
+void _copy_page_sse2(void * __restrict dest, const void * __restrict src);
+void _zero_page_stosl(void * dest);
+void _zero_page_erms(void * dest);
+void _zero_page_sse2(void * dest);
 
 extern void* (*memcpy)(void* __restrict, const void* __restrict, size_t);
 extern void* (*memcpyl)(void* __restrict, const void* __restrict, size_t);
 extern void* (*aligned_memcpy)(void* __restrict, const void* __restrict, size_t);
+extern void* (*stream_memcpyl)(void* __restrict, const void* __restrict, size_t);
+extern void (*copy_page)(void* __restrict, const void* __restrict);
+extern void (*zero_page)(void*);
 
 inline void *constant_memcpy(void *to, const void *from, size_t n)
 {
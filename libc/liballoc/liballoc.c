@@ -261,6 +261,11 @@ void *PREFIX(malloc_align)(size_t req_size, size_t alignment)
 
     assert(alignment > 1);
 
+    if ((p = liballoc_cache_alloc(req_size, alignment)))
+    {
+        return p;
+    }
+
     size += alignment + ALIGN_INFO;
     // So, ideally, we really want an alignment of 0 or 1 in order
     // to save space.
@@ -612,6 +617,8 @@ void PREFIX(free)(void *ptr)
         return;
     }
 
+    if (liballoc_cache_free(ptr)) return;
+
     UNALIGN( ptr );
 
     liballoc_lock();		// lockit
@@ -758,6 +765,17 @@ void*   PREFIX(realloc)(void *p, size_t size)
     // In the case of a NULL pointer, return a simple malloc.
     if ( p == NULL ) return PREFIX(malloc)( size );
 
+    if ( (real_size = liballoc_cache_size(p)) )
+    {
+        if ( real_size >= size ) return p;
+
+        ptr = PREFIX(malloc)( size );
+        if ( ptr == NULL ) return NULL;
+        liballoc_memcpy( ptr, p, real_size );
+        PREFIX(free)( p );
+        return ptr;
+    }
+
     // Unalign the pointer if required.
     ptr = p;
     UNALIGN(ptr);
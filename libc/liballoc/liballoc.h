@@ -71,6 +71,28 @@ extern int liballoc_free(void*,size_t);
 #if defined DEBUG || defined INFO || true
 void liballoc_dump();
 #endif
+
+/** Size-class cache used for small allocations, lock-free in the kernel and per-thread in userland.
+ *
+ * \return NULL if the request isn't handled by the cache.
+ */
+void*  liballoc_cache_alloc(size_t size, size_t alignment);
+
+/** \return 0 if the pointer doesn't belong to the cache. */
+int    liballoc_cache_free(void* ptr);
+
+/** \return the usable size of a cache object, 0 if the pointer doesn't belong to the cache. */
+size_t liballoc_cache_size(const void* ptr);
+
+#ifdef LUDOS_USER
+/** Gives the objects cached by the calling thread back to the other threads, called before it exits. */
+void   liballoc_thread_exit();
+#else
+void   liballoc_cache_dump();
+
+/** \return the longest time in TSC ticks liballoc kept interrupts disabled. */
+uint64_t liballoc_longest_lock(int reset);
+#endif
        
 
 extern void    *PREFIX(malloc)(size_t);				///< The standard function.
@@ -0,0 +1,673 @@
+/*
+liballoc_cache.cpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#if !defined(LUDOS_USER)
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "liballoc.h"
+
+#include "mem/memmap.hpp"
+#include "tasking/atomic.hpp"
+
+// Size-class object cache in front of liballoc for small kernel allocations.
+// Each class has a lock-free free list (pointer + generation tag updated with a 64-bit CAS),
+// so malloc/free of small objects neither takes a lock nor masks interrupts, and can be used from IRQ handlers.
+// Slabs are single pages carved out of a virtual area reserved once; they are never given back.
+
+namespace
+{
+
+struct FreeObject
+{
+    FreeObject* next;
+};
+
+constexpr size_t min_object_shift = 4; // 16 bytes
+constexpr size_t class_count      = 8; // up to 2048 bytes
+constexpr size_t max_object_size  = size_t(1) << (min_object_shift + class_count - 1);
+constexpr size_t area_pages       = 4096; // 16 MiB of virtual space
+
+uint64_t free_lists[class_count];
+size_t   class_pages[class_count];
+
+uint8_t* area { nullptr };
+size_t   next_page { 0 };
+uint8_t  page_class[area_pages];
+
+inline FreeObject* list_head(uint64_t word)
+{
+    return reinterpret_cast<FreeObject*>(uintptr_t(word));
+}
+
+inline uint64_t make_word(FreeObject* head, uint64_t old)
+{
+    return (((old >> 32) + 1) << 32) | uintptr_t(head);
+}
+
+inline size_t size_class(size_t size)
+{
+    size_t cls = 0;
+    while ((size_t(1) << (cls + min_object_shift)) < size)
+    {
+        ++cls;
+    }
+    return cls;
+}
+
+inline size_t object_size(size_t cls)
+{
+    return size_t(1) << (cls + min_object_shift);
+}
+
+FreeObject* pop(size_t cls)
+{
+    uint64_t old = __atomic_load_n(&free_lists[cls], __ATOMIC_ACQUIRE);
+    FreeObject* head;
+    do
+    {
+        head = list_head(old);
+        if (!head)
+        {
+            return nullptr;
+        }
+        // slab pages are never unmapped, so reading a stale head is harmless, the tag makes the CAS fail
+    } while (!__atomic_compare_exchange_n(&free_lists[cls], &old, make_word(head->next, old),
+                                          true, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+    return head;
+}
+
+void push(size_t cls, FreeObject* first, FreeObject* last)
+{
+    uint64_t old = __atomic_load_n(&free_lists[cls], __ATOMIC_ACQUIRE);
+    do
+    {
+        last->next = list_head(old);
+    } while (!__atomic_compare_exchange_n(&free_lists[cls], &old, make_word(first, old),
+                                          true, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+}
+
+uint8_t* get_area()
+{
+    if (uint8_t* ptr = atomic_load(&area))
+    {
+        return ptr;
+    }
+
+    liballoc_lock();
+    if (!area)
+    {
+        atomic_store(&area, reinterpret_cast<uint8_t*>(Memory::allocate_virtual_page(area_pages, false)));
+    }
+    liballoc_unlock();
+
+    return area;
+}
+
+// maps a new page for this class, keeps the first object and pushes the others on the free list
+void* refill(size_t cls)
+{
+    uint8_t* base = get_area();
+    const size_t index = atomic_fetch_add(&next_page, 1);
+    if (!base || index >= area_pages)
+    {
+        return nullptr; // the area is exhausted, liballoc will handle the allocation
+    }
+
+    uint8_t* page = base + index*Memory::page_size();
+
+    // the page allocator isn't reentrant, only the mapping itself runs with interrupts masked
+    liballoc_lock();
+    Memory::map_page(Memory::allocate_physical_page(), page, Memory::Read|Memory::Write);
+    liballoc_unlock();
+
+    page_class[index] = cls;
+    atomic_inc(&class_pages[cls]);
+
+    const size_t size = object_size(cls);
+    const size_t count = Memory::page_size() / size;
+    if (count > 1)
+    {
+        for (size_t i { 1 }; i < count - 1; ++i)
+        {
+            reinterpret_cast<FreeObject*>(page + i*size)->next = reinterpret_cast<FreeObject*>(page + (i+1)*size);
+        }
+        push(cls, reinterpret_cast<FreeObject*>(page + size), reinterpret_cast<FreeObject*>(page + (count-1)*size));
+    }
+
+    return page;
+}
+
+inline bool owned(const void* ptr)
+{
+    const uint8_t* base = atomic_load(&area);
+    return base && ptr >= base && ptr < base + area_pages*Memory::page_size();
+}
+
+inline size_t page_index(const void* ptr)
+{
+    return (reinterpret_cast<const uint8_t*>(ptr) - area) / Memory::page_size();
+}
+
+}
+
+extern "C"
+{
+
+void* liballoc_cache_alloc(size_t size, size_t alignment)
+{
+    if (size < alignment)
+    {
+        size = alignment;
+    }
+    if (size == 0 || size > max_object_size)
+    {
+        return nullptr;
+    }
+
+    // objects are naturally aligned to their power of two size
+    const size_t cls = size_class(size);
+    if (FreeObject* obj = pop(cls))
+    {
+        return obj;
+    }
+
+    return refill(cls);
+}
+
+int liballoc_cache_free(void* ptr)
+{
+    if (!owned(ptr))
+    {
+        return 0;
+    }
+
+    auto obj = static_cast<FreeObject*>(ptr);
+    push(page_class[page_index(ptr)], obj, obj);
+
+    return 1;
+}
+
+size_t liballoc_cache_size(const void* ptr)
+{
+    if (!owned(ptr))
+    {
+        return 0;
+    }
+
+    return object_size(page_class[page_index(ptr)]);
+}
+
+void liballoc_cache_dump()
+{
+    kprintf("liballoc: cache area %p, %d/%d pages used\n", area, atomic_load(&next_page) < area_pages ? atomic_load(&next_page) : area_pages, area_pages);
+    for (size_t cls { 0 }; cls < class_count; ++cls)
+    {
+        kprintf("liballoc: %4d bytes objects : %d pages\n", object_size(cls), atomic_load(&class_pages[cls]));
+    }
+}
+
+}
+
+#else
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <sys/tls.h>
+#include <sys/mman.h>
+#include <syscalls/syscall_list.hpp>
+
+#include "liballoc.h"
+
+#include "tasking/spinlock.hpp"
+
+// Size-class allocator in front of liballoc for small userland allocations.
+// Each thread owns a cache of free objects per class, found through its TLS control block : malloc and free
+// of small objects take no lock, and free is O(1) as the class of a page is found with a two-level table.
+// The caches exchange objects with the central lists by batches. The central arena reserves chunks of address space
+// with anonymous mmap, the kernel only commits their pages when they are first touched ; a page whose objects are
+// all back in the central lists is unmapped, once the class keeps a batch of free objects elsewhere.
+
+namespace
+{
+
+struct FreeObject
+{
+    FreeObject* next;
+};
+
+constexpr size_t page_size        = 0x1000;
+constexpr size_t min_object_shift = 4; // 16 bytes
+constexpr size_t class_count      = 8; // up to 2048 bytes
+constexpr size_t max_object_size  = size_t(1) << (min_object_shift + class_count - 1);
+constexpr size_t chunk_pages      = 256; // 1 MiB of address space per mmap call
+constexpr size_t region_shift     = 22; // one class table per 4 MiB of address space
+constexpr size_t region_pages     = size_t(1) << (region_shift - 12);
+
+struct ThreadCache
+{
+    FreeObject*  lists[class_count];
+    size_t       counts[class_count];
+    ThreadCache* next; // in the list of released caches
+};
+
+struct PageInfo
+{
+    uint8_t  cls;          // class + 1 of a page handed to the cache, 0 for the pages liballoc owns
+    uint16_t central_free; // objects of the page in the central lists
+};
+
+struct CentralList
+{
+    FreeObject* head;
+    size_t      count;
+};
+
+spinlock_t   central_lock;
+CentralList  central[class_count];
+uint8_t*     chunk_pos;
+uint8_t*     chunk_end;
+uint8_t*     meta_pos;
+uint8_t*     meta_end;
+ThreadCache* released_caches;
+
+PageInfo*    page_infos[size_t(1) << (32 - region_shift)];
+
+inline size_t size_class(size_t size)
+{
+    size_t cls = 0;
+    while ((size_t(1) << (cls + min_object_shift)) < size)
+    {
+        ++cls;
+    }
+    return cls;
+}
+
+inline size_t object_size(size_t cls)
+{
+    return size_t(1) << (cls + min_object_shift);
+}
+
+inline size_t objects_per_page(size_t cls)
+{
+    return page_size / object_size(cls);
+}
+
+// number of objects moved at once between a thread cache and the central lists
+inline size_t batch_size(size_t cls)
+{
+    const size_t count = page_size / object_size(cls);
+    return count > 32 ? 32 : count < 4 ? 4 : count;
+}
+
+inline ThreadCache* current_cache()
+{
+    ThreadCache* cache;
+    asm volatile ("mov %%gs:%c1, %0" : "=r"(cache) : "i"(offsetof(tls_control, malloc_cache)));
+    return cache;
+}
+
+inline void set_current_cache(ThreadCache* cache)
+{
+    asm volatile ("mov %0, %%gs:%c1" :: "r"(cache), "i"(offsetof(tls_control, malloc_cache)) : "memory");
+}
+
+inline PageInfo* page_info(const void* ptr)
+{
+    const uintptr_t addr = reinterpret_cast<uintptr_t>(ptr);
+    PageInfo* table = __atomic_load_n(&page_infos[addr >> region_shift], __ATOMIC_ACQUIRE);
+    return table ? &table[(addr >> 12) & (region_pages - 1)] : nullptr;
+}
+
+inline uint8_t* page_of(const void* ptr)
+{
+    return reinterpret_cast<uint8_t*>(reinterpret_cast<uintptr_t>(ptr) & ~(page_size - 1));
+}
+
+// must be called with the central lock held
+uint8_t* reserve_page()
+{
+    if (chunk_pos == chunk_end)
+    {
+        void* chunk = mmap(nullptr, chunk_pages*page_size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+        if (chunk == MAP_FAILED)
+        {
+            return nullptr;
+        }
+        chunk_pos = static_cast<uint8_t*>(chunk);
+        chunk_end = chunk_pos + chunk_pages*page_size;
+    }
+
+    uint8_t* page = chunk_pos;
+    chunk_pos += page_size;
+    return page;
+}
+
+// allocator metadata, never freed, must be called with the central lock held
+uint8_t* reserve_meta(size_t size)
+{
+    size = (size + sizeof(uintptr_t) - 1) & ~(sizeof(uintptr_t) - 1);
+    if (meta_pos + size > meta_end)
+    {
+        meta_pos = reserve_page();
+        if (!meta_pos)
+        {
+            return nullptr;
+        }
+        meta_end = meta_pos + page_size;
+    }
+
+    uint8_t* ptr = meta_pos;
+    meta_pos += size;
+    return ptr;
+}
+
+// must be called with the central lock held
+uint8_t* new_page(size_t cls)
+{
+    uint8_t* page = reserve_page();
+    if (!page)
+    {
+        return nullptr;
+    }
+
+    PageInfo*& table = page_infos[reinterpret_cast<uintptr_t>(page) >> region_shift];
+    if (!table)
+    {
+        // the lookups from free() don't take the lock, the table is only published once cleared
+        auto new_table = reinterpret_cast<PageInfo*>(reserve_meta(region_pages*sizeof(PageInfo)));
+        if (!new_table)
+        {
+            return nullptr;
+        }
+        memset(new_table, 0, region_pages*sizeof(PageInfo));
+        __atomic_store_n(&table, new_table, __ATOMIC_RELEASE);
+    }
+
+    table[(reinterpret_cast<uintptr_t>(page) >> 12) & (region_pages - 1)] = {uint8_t(cls + 1), 0};
+
+    return page;
+}
+
+// moves a batch of objects from the central list to the thread cache, carving a new page if needed
+bool fill(ThreadCache* cache, size_t cls)
+{
+    spin_lock(&central_lock);
+
+    CentralList& list = central[cls];
+    if (list.head)
+    {
+        FreeObject* first = list.head;
+        FreeObject* last = first;
+        size_t count = 1;
+        --page_info(first)->central_free;
+        while (count < batch_size(cls) && last->next)
+        {
+            last = last->next;
+            --page_info(last)->central_free;
+            ++count;
+        }
+
+        list.head = last->next;
+        list.count -= count;
+        spin_unlock(&central_lock);
+
+        last->next = cache->lists[cls];
+        cache->lists[cls] = first;
+        cache->counts[cls] += count;
+        return true;
+    }
+
+    uint8_t* page = new_page(cls);
+    spin_unlock(&central_lock);
+    if (!page)
+    {
+        return false;
+    }
+
+    const size_t size = object_size(cls);
+    const size_t count = page_size / size;
+    for (size_t i { 0 }; i < count - 1; ++i)
+    {
+        reinterpret_cast<FreeObject*>(page + i*size)->next = reinterpret_cast<FreeObject*>(page + (i+1)*size);
+    }
+    reinterpret_cast<FreeObject*>(page + (count-1)*size)->next = cache->lists[cls];
+    cache->lists[cls] = reinterpret_cast<FreeObject*>(page);
+    cache->counts[cls] += count;
+
+    return true;
+}
+
+constexpr size_t max_released_pages = 4; // per drain, the other empty pages stay in the central lists
+
+// unlinks the objects of the given pages from the central list, must be called with the central lock held
+void unlink_pages(size_t cls, uint8_t* const* pages, size_t page_count)
+{
+    for (FreeObject** obj = &central[cls].head; *obj;)
+    {
+        uint8_t* page = page_of(*obj);
+        bool released = false;
+        for (size_t i { 0 }; i < page_count && !released; ++i)
+        {
+            released = pages[i] == page;
+        }
+
+        if (released)
+        {
+            *obj = (*obj)->next;
+            --central[cls].count;
+        }
+        else
+        {
+            obj = &(*obj)->next;
+        }
+    }
+
+    for (size_t i { 0 }; i < page_count; ++i)
+    {
+        *page_info(pages[i]) = {0, 0};
+    }
+}
+
+// gives count objects of the thread cache back to the central list, and the pages left empty to the kernel
+void drain(ThreadCache* cache, size_t cls, size_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    FreeObject* first = cache->lists[cls];
+    FreeObject* last = first;
+    for (size_t i { 1 }; i < count; ++i)
+    {
+        last = last->next;
+    }
+
+    cache->lists[cls] = last->next;
+    cache->counts[cls] -= count;
+
+    uint8_t* empty_pages[max_released_pages];
+    size_t empty_count = 0;
+
+    spin_lock(&central_lock);
+    last->next = central[cls].head;
+    central[cls].head = first;
+    central[cls].count += count;
+
+    // a page is empty once all its objects are in the central list, keep a batch of free objects for the class
+    FreeObject* obj = first;
+    for (size_t i { 0 }; i < count; ++i, obj = obj->next)
+    {
+        PageInfo* info = page_info(obj);
+        if (++info->central_free == objects_per_page(cls) && empty_count < max_released_pages &&
+            central[cls].count >= (empty_count + 1)*objects_per_page(cls) + batch_size(cls))
+        {
+            empty_pages[empty_count++] = page_of(obj);
+        }
+    }
+    if (empty_count)
+    {
+        unlink_pages(cls, empty_pages, empty_count);
+    }
+    spin_unlock(&central_lock);
+
+    for (size_t i { 0 }; i < empty_count; ++i)
+    {
+        munmap(empty_pages[i], page_size);
+    }
+}
+
+ThreadCache* get_cache()
+{
+    if (ThreadCache* cache = current_cache())
+    {
+        return cache;
+    }
+
+    spin_lock(&central_lock);
+    ThreadCache* cache = released_caches;
+    if (cache)
+    {
+        released_caches = cache->next;
+    }
+    else
+    {
+        cache = reinterpret_cast<ThreadCache*>(reserve_meta(sizeof(ThreadCache)));
+    }
+    spin_unlock(&central_lock);
+
+    if (cache)
+    {
+        memset(cache, 0, sizeof(ThreadCache));
+        set_current_cache(cache);
+    }
+
+    return cache;
+}
+
+}
+
+extern "C"
+{
+
+void* liballoc_cache_alloc(size_t size, size_t alignment)
+{
+    if (size < alignment)
+    {
+        size = alignment;
+    }
+    if (size == 0 || size > max_object_size)
+    {
+        return nullptr;
+    }
+
+    ThreadCache* cache = get_cache();
+    if (!cache)
+    {
+        return nullptr;
+    }
+
+    // objects are naturally aligned to their power of two size
+    const size_t cls = size_class(size);
+    if (!cache->lists[cls] && !fill(cache, cls))
+    {
+        return nullptr;
+    }
+
+    FreeObject* obj = cache->lists[cls];
+    cache->lists[cls] = obj->next;
+    --cache->counts[cls];
+
+    return obj;
+}
+
+int liballoc_cache_free(void* ptr)
+{
+    const PageInfo* info = page_info(ptr);
+    if (!info || info->cls == 0)
+    {
+        return 0;
+    }
+
+    ThreadCache* cache = get_cache();
+    if (!cache)
+    {
+        return 0;
+    }
+
+    const size_t cls = info->cls - 1;
+    auto obj = static_cast<FreeObject*>(ptr);
+    obj->next = cache->lists[cls];
+    cache->lists[cls] = obj;
+
+    // keep a batch around for the next allocations, give the rest back
+    if (++cache->counts[cls] >= 2*batch_size(cls))
+    {
+        drain(cache, cls, batch_size(cls));
+    }
+
+    return 1;
+}
+
+size_t liballoc_cache_size(const void* ptr)
+{
+    const PageInfo* info = page_info(ptr);
+    if (!info || info->cls == 0)
+    {
+        return 0;
+    }
+
+    return object_size(info->cls - 1);
+}
+
+void liballoc_thread_exit()
+{
+    ThreadCache* cache = current_cache();
+    if (!cache)
+    {
+        return;
+    }
+
+    for (size_t cls { 0 }; cls < class_count; ++cls)
+    {
+        drain(cache, cls, cache->counts[cls]);
+    }
+
+    set_current_cache(nullptr);
+
+    spin_lock(&central_lock);
+    cache->next = released_caches;
+    released_caches = cache;
+    spin_unlock(&central_lock);
+}
+
+}
+
+#endif
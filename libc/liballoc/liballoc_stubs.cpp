@@ -28,24 +28,63 @@ SOFTWARE.
 #include <stdint.h>
 
 #include "mem/memmap.hpp"
+#include "time/time.hpp"
 
 #include "utils/logging.hpp"
 #include "panic.hpp"
 
+// Small allocations are served by the lock-free cache in liballoc_cache.cpp,
+// only the large ones and slab refills still mask interrupts here.
+static size_t   lock_depth;
+static bool     irqs_were_enabled;
+static uint64_t lock_start;
+static uint64_t longest_lock;
+
 extern "C"
 {
 int liballoc_lock()
 {
+    bool enabled = interrupts_enabled();
     cli();
+    if (lock_depth++ == 0) // slab refills can happen while mapping pages for liballoc
+    {
+        irqs_were_enabled = enabled;
+        lock_start = Time::total_ticks();
+    }
     return 0;
 }
 
 int liballoc_unlock()
 {
-    sti();
+    if (--lock_depth != 0)
+    {
+        return 0;
+    }
+
+    uint64_t duration = Time::total_ticks() - lock_start;
+    if (duration > longest_lock)
+    {
+        longest_lock = duration;
+    }
+
+    // don't enable interrupts if we were called with them disabled, e.g. from an IRQ handler
+    if (irqs_were_enabled)
+    {
+        sti();
+    }
     return 0;
 }
 
+uint64_t liballoc_longest_lock(int reset)
+{
+    uint64_t value = longest_lock;
+    if (reset)
+    {
+        longest_lock = 0;
+    }
+    return value;
+}
+
 void* liballoc_alloc(size_t pages)
 {
     uint8_t* addr = reinterpret_cast<uint8_t*>(Memory::allocate_virtual_page(pages, false));
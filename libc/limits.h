@@ -112,4 +112,7 @@ SOFTWARE.
 #endif
 
 
+/* Maximum length of a path, terminator included.  */
+#define PATH_MAX	4096
+
 #endif // LIMITS_H
@@ -28,6 +28,7 @@ SOFTWARE.
 #include <sys/cdefs.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdarg.h>
 
 #include "utils/defs.hpp"
 
@@ -35,6 +36,10 @@ SOFTWARE.
 
 #ifdef __cplusplus
 void putcharw(char32_t c);
+#ifdef __is_libk
+// draws what putchar() wrote to the terminal, which is otherwise only drawn on new lines
+void flush_putchar();
+#endif
 #endif
 
 #ifdef __cplusplus
@@ -43,9 +48,25 @@ extern "C" {
 
 extern bool putc_serial;
 
-typedef struct
+#define BUFSIZ 1024
+
+// buffering modes
+#define _IOFBF 0 // full
+#define _IOLBF 1 // line
+#define _IONBF 2 // none
+
+typedef struct __FILE
 {
     size_t fd;
+
+    int    buf_mode;
+    int    flags;
+    char*  buf;
+    size_t buf_size;
+    size_t buf_pos; // next byte to read from or to write to the buffer
+    size_t buf_end; // end of the data read into the buffer
+
+    struct __FILE* next; // open streams, for fflush(NULL)
 } FILE;
 
 void putchar(char c);
@@ -53,9 +74,28 @@ void putchar(char c);
 void puts(const char*);
 
 int fprintf(FILE * stream, const char * format, ...) PRINTF_FMT(2, 3);
+int vfprintf(FILE * stream, const char * format, va_list va);
 FILE * fopen(const char * filename, const char * mode);
 int fclose( FILE * stream );
+// flushes every open stream if stream is NULL
 int fflush( FILE * stream );
+int setvbuf( FILE * stream, char * buf, int mode, size_t size );
+void setbuf( FILE * stream, char * buf );
+
+int fputc( int c, FILE * stream );
+int putc( int c, FILE * stream );
+int fputs( const char * str, FILE * stream );
+size_t fwrite( const void * ptr, size_t size, size_t count, FILE * stream );
+
+int fgetc( FILE * stream );
+int getc( FILE * stream );
+char * fgets( char * str, int count, FILE * stream );
+size_t fread( void * ptr, size_t size, size_t count, FILE * stream );
+
+int feof( FILE * stream );
+int ferror( FILE * stream );
+void clearerr( FILE * stream );
+int fileno( FILE * stream );
 
 void perror(const char * str);
 
@@ -26,68 +26,526 @@ SOFTWARE.
 #ifdef LUDOS_USER
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <errno.h>
 #include <syscalls/syscall_list.hpp>
 #include <sys/fnctl.h>
+#include <sys/fs.h>
 
-FILE stdin_real { 0 };
-FILE stdout_real { 1 };
-FILE stderr_real { 2 };
+namespace
+{
+enum StreamFlags : int
+{
+    CanRead  = 1 << 0,
+    CanWrite = 1 << 1,
+    Reading  = 1 << 2, // the buffer holds data read ahead
+    Writing  = 1 << 3, // the buffer holds data not written yet
+    Eof      = 1 << 4,
+    Error    = 1 << 5,
+    OwnsBuf  = 1 << 6
+};
+
+char stdout_buf[BUFSIZ];
+}
+
+FILE stderr_real { 2, _IONBF, CanWrite, nullptr, 0, 0, 0, nullptr };
+FILE stdout_real { 1, _IOLBF, CanWrite, stdout_buf, sizeof(stdout_buf), 0, 0, &stderr_real };
+// a read from the terminal blocks until the whole request is filled, so stdin can't read ahead
+FILE stdin_real  { 0, _IONBF, CanRead, nullptr, 0, 0, 0, &stdout_real };
 
 FILE* stdin { &stdin_real };
 FILE* stdout { &stdout_real };
 FILE* stderr { &stderr_real };
 
-int fprintf(FILE * stream, const char * format, ...)
+static FILE* open_streams { &stdin_real };
+
+static bool write_all(FILE* stream, const char* data, size_t len)
 {
-    char buf[1024];
+    while (len)
+    {
+        const size_t ret = write(stream->fd, data, len);
+        if (ret == (size_t)-1 || ret == 0)
+        {
+            stream->flags |= Error;
+            return false;
+        }
 
-    va_list va;
-    va_start(va, format);
-    size_t size = vsnprintf(buf, sizeof(buf), format, va);
-    va_end(va);
+        data += ret;
+        len -= ret;
+    }
 
-    auto ret = write(stream->fd, buf, size);
-    if (ret == -1)
+    return true;
+}
+
+// returns 0 on error or end of file
+static size_t read_some(FILE* stream, char* data, size_t len)
+{
+    const size_t ret = read(stream->fd, data, len);
+    if (ret == (size_t)-1)
     {
-        return -1;
+        stream->flags |= Error;
+        return 0;
+    }
+    if (ret == 0)
+    {
+        stream->flags |= Eof;
     }
 
-    return size;
+    return ret;
+}
+
+static int flush_write(FILE* stream)
+{
+    if (!(stream->flags & Writing))
+        return 0;
+
+    stream->flags &= ~Writing;
+    const size_t len = stream->buf_pos;
+    stream->buf_pos = 0;
+
+    return write_all(stream, stream->buf, len) ? 0 : EOF;
+}
+
+// drops the data read ahead, moving the file offset back to what was actually consumed
+static void drop_read(FILE* stream)
+{
+    if (!(stream->flags & Reading))
+        return;
+
+    const size_t unread = stream->buf_end - stream->buf_pos;
+    if (unread)
+    {
+        lseek(stream->fd, -(int)unread, SEEK_CUR);
+    }
+
+    stream->buf_pos = stream->buf_end = 0;
+    stream->flags &= ~Reading;
+}
+
+static void ensure_buffer(FILE* stream)
+{
+    if (stream->buf_mode == _IONBF || stream->buf)
+        return;
+
+    const size_t size = stream->buf_size ? stream->buf_size : BUFSIZ;
+    stream->buf = (char*)malloc(size);
+    if (!stream->buf)
+    {
+        stream->buf_mode = _IONBF;
+        stream->buf_size = 0;
+        return;
+    }
+
+    stream->buf_size = size;
+    stream->flags |= OwnsBuf;
+}
+
+// interactive input usually follows a prompt, make it visible first
+static void flush_line_buffered()
+{
+    for (FILE* stream = open_streams; stream; stream = stream->next)
+    {
+        if (stream->buf_mode == _IOLBF)
+            flush_write(stream);
+    }
+}
+
+static bool refill(FILE* stream)
+{
+    if (stream->buf_mode != _IOFBF)
+        flush_line_buffered();
+
+    stream->buf_pos = stream->buf_end = 0;
+    stream->flags &= ~Reading;
+
+    const size_t ret = read_some(stream, stream->buf, stream->buf_size);
+    if (ret == 0)
+        return false;
+
+    stream->buf_end = ret;
+    stream->flags |= Reading;
+
+    return true;
 }
 
 FILE * fopen(const char * filename, const char * mode)
 {
-    // TODO : support modifiers
+    int flags;
+    int perms;
 
-    auto ret = open(filename, O_RDWR, 0);
-    if (ret == -1)
+    switch (mode[0])
     {
-        return nullptr;
+        case 'r':
+            flags = O_RDONLY;
+            perms = CanRead;
+            break;
+        case 'w':
+            flags = O_WRONLY | O_CREAT | O_TRUNC;
+            perms = CanWrite;
+            break;
+        case 'a':
+            flags = O_WRONLY | O_CREAT | O_APPEND;
+            perms = CanWrite;
+            break;
+        default:
+            errno = EINVAL;
+            return nullptr;
     }
-    else
+
+    for (const char* c = mode + 1; *c; ++c)
     {
-        return new FILE { (size_t)ret };
+        if (*c == '+')
+        {
+            flags = (flags & ~O_ACCMODE) | O_RDWR;
+            perms = CanRead | CanWrite;
+        }
+    }
+
+    auto ret = open(filename, flags, 0666);
+    if (ret == -1)
+    {
+        return nullptr;
     }
+
+    auto stream = new FILE { (size_t)ret, _IOFBF, perms, nullptr, 0, 0, 0, open_streams };
+    open_streams = stream;
+
+    return stream;
 }
 
 int fclose( FILE * stream )
 {
+    int ret = fflush(stream);
+
     if (close(stream->fd) == -1)
     {
-        return EOF;
+        ret = EOF;
     }
 
-    delete stream;
+    for (FILE** link = &open_streams; *link; link = &(*link)->next)
+    {
+        if (*link == stream)
+        {
+            *link = stream->next;
+            break;
+        }
+    }
 
-    return 0;
+    if (stream->flags & OwnsBuf)
+    {
+        free(stream->buf);
+    }
+
+    if (stream != stdin && stream != stdout && stream != stderr)
+    {
+        delete stream;
+    }
+
+    return ret;
 }
 
 int fflush( FILE * stream )
 {
-    // NOP
+    if (!stream)
+    {
+        int ret = 0;
+        for (FILE* it = open_streams; it; it = it->next)
+        {
+            if (flush_write(it) == EOF)
+                ret = EOF;
+        }
+
+        return ret;
+    }
+
+    drop_read(stream);
+
+    return flush_write(stream);
+}
+
+int setvbuf( FILE * stream, char * buf, int mode, size_t size )
+{
+    if (mode != _IOFBF && mode != _IOLBF && mode != _IONBF)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (fflush(stream) == EOF)
+    {
+        return -1;
+    }
+
+    if (stream->flags & OwnsBuf)
+    {
+        free(stream->buf);
+        stream->flags &= ~OwnsBuf;
+    }
+
+    stream->buf_mode = mode;
+    stream->buf = nullptr;
+    stream->buf_size = 0;
+
+    if (mode != _IONBF)
+    {
+        // without a user buffer, one of the given size is allocated on first use
+        stream->buf = buf;
+        stream->buf_size = size;
+    }
 
     return 0;
 }
 
+void setbuf( FILE * stream, char * buf )
+{
+    setvbuf(stream, buf, buf ? _IOFBF : _IONBF, BUFSIZ);
+}
+
+size_t fwrite( const void * ptr, size_t size, size_t count, FILE * stream )
+{
+    const size_t total = size * count;
+    if (total == 0)
+        return 0;
+
+    if (!(stream->flags & CanWrite))
+    {
+        stream->flags |= Error;
+        errno = EBADF;
+        return 0;
+    }
+
+    drop_read(stream);
+    ensure_buffer(stream);
+
+    const char* data = (const char*)ptr;
+
+    if (stream->buf_mode == _IONBF)
+    {
+        return write_all(stream, data, total) ? count : 0;
+    }
+
+    if (stream->buf_pos + total > stream->buf_size)
+    {
+        if (flush_write(stream) == EOF)
+            return 0;
+
+        // too large to be worth copying
+        if (total >= stream->buf_size)
+            return write_all(stream, data, total) ? count : 0;
+    }
+
+    memcpy(stream->buf + stream->buf_pos, data, total);
+    stream->buf_pos += total;
+    stream->flags |= Writing;
+
+    if (stream->buf_mode == _IOLBF && memchr(data, '\n', total))
+    {
+        if (flush_write(stream) == EOF)
+            return 0;
+    }
+
+    return count;
+}
+
+int fputc( int c, FILE * stream )
+{
+    const char ch = (char)c;
+
+    // common case, room left in a buffer already being written to
+    if ((stream->flags & Writing) && stream->buf_pos < stream->buf_size &&
+            !(stream->buf_mode == _IOLBF && ch == '\n'))
+    {
+        stream->buf[stream->buf_pos++] = ch;
+        return (unsigned char)ch;
+    }
+
+    return fwrite(&ch, 1, 1, stream) == 1 ? (unsigned char)ch : EOF;
+}
+
+int putc( int c, FILE * stream )
+{
+    return fputc(c, stream);
+}
+
+int fputs( const char * str, FILE * stream )
+{
+    const size_t len = strlen(str);
+
+    return fwrite(str, 1, len, stream) == len ? 0 : EOF;
+}
+
+size_t fread( void * ptr, size_t size, size_t count, FILE * stream )
+{
+    const size_t total = size * count;
+    if (total == 0)
+        return 0;
+
+    if (!(stream->flags & CanRead))
+    {
+        stream->flags |= Error;
+        errno = EBADF;
+        return 0;
+    }
+
+    if (flush_write(stream) == EOF)
+        return 0;
+    ensure_buffer(stream);
+
+    char* dest = (char*)ptr;
+    size_t done = 0;
+
+    if (stream->flags & Reading)
+    {
+        const size_t buffered = stream->buf_end - stream->buf_pos;
+        const size_t avail = buffered < total ? buffered : total;
+        memcpy(dest, stream->buf + stream->buf_pos, avail);
+        stream->buf_pos += avail;
+        done += avail;
+    }
+
+    while (done < total)
+    {
+        const size_t left = total - done;
+
+        if (stream->buf_mode == _IONBF || left >= stream->buf_size)
+        {
+            // large reads go straight to the destination
+            if (stream->buf_mode != _IOFBF)
+                flush_line_buffered();
+
+            const size_t ret = read_some(stream, dest + done, left);
+            if (ret == 0)
+                break;
+            done += ret;
+        }
+        else
+        {
+            if (!refill(stream))
+                break;
+
+            const size_t avail = stream->buf_end < left ? stream->buf_end : left;
+            memcpy(dest + done, stream->buf, avail);
+            stream->buf_pos = avail;
+            done += avail;
+        }
+    }
+
+    return done / size;
+}
+
+int fgetc( FILE * stream )
+{
+    if ((stream->flags & Reading) && stream->buf_pos < stream->buf_end)
+    {
+        return (unsigned char)stream->buf[stream->buf_pos++];
+    }
+
+    unsigned char c;
+    return fread(&c, 1, 1, stream) == 1 ? c : EOF;
+}
+
+int getc( FILE * stream )
+{
+    return fgetc(stream);
+}
+
+char * fgets( char * str, int count, FILE * stream )
+{
+    if (count <= 0)
+        return nullptr;
+
+    int len = 0;
+    while (len < count - 1)
+    {
+        const int c = fgetc(stream);
+        if (c == EOF)
+            break;
+
+        str[len++] = (char)c;
+        if (c == '\n')
+            break;
+    }
+
+    if (len == 0 && count > 1)
+        return nullptr;
+
+    str[len] = '\0';
+    return str;
+}
+
+int feof( FILE * stream )
+{
+    return (stream->flags & Eof) != 0;
+}
+
+int ferror( FILE * stream )
+{
+    return (stream->flags & Error) != 0;
+}
+
+void clearerr( FILE * stream )
+{
+    stream->flags &= ~(Eof | Error);
+}
+
+int fileno( FILE * stream )
+{
+    return (int)stream->fd;
+}
+
+namespace
+{
+// formatted output is gathered in chunks, so that unbuffered streams don't get a write per character
+struct FormatBuffer
+{
+    FILE*  stream;
+    char   data[128];
+    size_t size;
+    size_t written;
+    bool   failed;
+};
+
+void format_flush(FormatBuffer* buf)
+{
+    if (fwrite(buf->data, 1, buf->size, buf->stream) != buf->size)
+        buf->failed = true;
+
+    buf->written += buf->size;
+    buf->size = 0;
+}
+
+void format_putc(void* p, char c)
+{
+    auto buf = (FormatBuffer*)p;
+
+    buf->data[buf->size++] = c;
+    if (buf->size == sizeof(buf->data))
+        format_flush(buf);
+}
+}
+
+int vfprintf(FILE * stream, const char * format, va_list va)
+{
+    FormatBuffer buf;
+    buf.stream = stream;
+    buf.size = buf.written = 0;
+    buf.failed = false;
+
+    tfp_format(&buf, format_putc, format, va);
+    format_flush(&buf);
+
+    return buf.failed ? -1 : (int)buf.written;
+}
+
+int fprintf(FILE * stream, const char * format, ...)
+{
+    va_list va;
+    va_start(va, format);
+    int ret = vfprintf(stream, format, va);
+    va_end(va);
+
+    return ret;
+}
+
 #endif
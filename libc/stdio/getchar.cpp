@@ -31,9 +31,21 @@ SOFTWARE.
 
 int getchar()
 {
+#ifdef LUDOS_USER
+    const int c = fgetc(stdin);
+    if (c == EOF)
+        return EOF;
+
+    // echo the character right away, the terminal doesn't
+    putchar((char)c);
+    fflush(stdout);
+
+    return c;
+#else
     char buf[1];
     read(0, buf, 1);
     putchar(buf[0]);
 
     return buf[0];
+#endif
 }
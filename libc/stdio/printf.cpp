@@ -24,6 +24,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <itoa.h>
 #include <atoi.h>
 
+#ifdef __is_libk
+#include <stdio.h>
+#endif
+
 /*
  * Configuration
  */
@@ -452,6 +456,9 @@ void init_printf(void *putp, putcf putf)
 void tfp_vprintf(const char * __restrict fmt, va_list va)
 {
     tfp_format(stdout_putp, stdout_putf, fmt, va);
+#ifdef __is_libk
+    flush_putchar(); /* the terminal is drawn once per call rather than once per character */
+#endif
 }
 
 void tfp_printf(const char * __restrict fmt, ...)
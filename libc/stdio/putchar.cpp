@@ -47,9 +47,7 @@ void putchar(char c)
         putcharw(decoder.spit());
     }
 #else
-    char buf[2] = { 0 };
-    buf[0] = c;
-    print_debug(buf);
+    fputc(c, stdout);
 #endif
 }
 
@@ -57,11 +55,17 @@ void putcharw(char32_t c)
 {
 #ifdef __is_libk
     term().put_char(c);
+    if (c == '\n') term().draw();
     if (putc_serial) serial::debug::write("%c", c);
 #else
     // TODO
-    char buf[2] = { 0 };
-    buf[0] = (char)c;
-    print_debug(buf);
+    putchar((char)c);
 #endif
 }
+
+#ifdef __is_libk
+void flush_putchar()
+{
+    term().draw();
+}
+#endif
@@ -31,6 +31,7 @@ void puts(const char* string)
 #ifndef LUDOS_USER
     kprintf("%s\n", string);
 #else
-    printf("%s\n", string);
+    fputs(string, stdout);
+    fputc('\n', stdout);
 #endif
 }
@@ -41,6 +41,9 @@ int memcmp(const void*, const void*, size_t);
 
 void* memmove(void*, const void*, size_t);
 void* _naive_memset(void*, uint8_t, size_t);
+void* _repmovsb_memset(void * dest, uint8_t val, size_t n);
+void* _stosl_memset(void * dest, uint8_t val, size_t n);
+void* _memset_sse2(void * dest, uint8_t val, size_t n);
 void _naive_double_memsetl(void* buf1ptr, void* buf2ptr, uint32_t value, size_t size);
 extern void* (*memset)(void*, uint8_t, size_t);
 extern void* (*aligned_memsetl)(void*, uint32_t , size_t );
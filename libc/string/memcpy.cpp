@@ -36,21 +36,40 @@ void* _naive_memcpy(void* __restrict dstptr, const void* __restrict srcptr, size
 }
 
 void * _repmovsb_memcpy(void * __restrict dest, const void * __restrict src, size_t n) {
+    void* to = dest;
     asm volatile("rep movsb"
-                 : "+S"(src), "+D"(dest)
-                 : "c"(n)
+                 : "+S"(src), "+D"(to), "+c"(n)
+                 :
                  : "flags", "memory");
     return dest;
 }
 
 void * _repmovsl_memcpy(void * __restrict dest, const void * __restrict src, size_t n) {
+    void* to = dest;
+    n /= 4;
     asm volatile("rep movsl"
-                 : "+S"(src), "+D"(dest)
-                 : "c"(n/4)
+                 : "+S"(src), "+D"(to), "+c"(n)
+                 :
                  : "cc", "memory");
     return dest;
 }
 
+void * _movsl_memcpy(void * __restrict dest, const void * __restrict src, size_t n)
+{
+    return constant_memcpy(dest, src, n);
+}
+
+// 'rep movsb' is the fastest copy with ERMS once past its startup cost, which FSRM removes for short copies
+void * _erms_memcpy(void * __restrict dest, const void * __restrict src, size_t n)
+{
+    if (n < 64)
+    {
+        return constant_memcpy(dest, src, n);
+    }
+
+    return _repmovsb_memcpy(dest, src, n);
+}
+
 /* From Linux 2.4.8.  I think this must be aligned. */
 void *
 _memcpy_mmx (void * __restrict v_to, const void * __restrict v_from, size_t len)
@@ -87,7 +106,7 @@ _memcpy_mmx (void * __restrict v_to, const void * __restrict v_from, size_t len)
     if (len & 63)
         _naive_memcpy(to, from, len & 63);
 
-    return to;
+    return v_to;
 }
 
 void *
@@ -123,13 +142,137 @@ _aligned_memcpy_sse2 (void * __restrict v_to, const void * __restrict v_from, si
         to += 128;
     }
 
+    // the non-temporal stores aren't ordered with the following ones
+    __asm__ __volatile__ ("sfence" : : : "memory");
+
     if (len & 127)
         _naive_memcpy(to, from, len & 127);
 
-    return to;
+    return v_to;
+}
+
+// Any alignment, the destination is aligned and the loads are left unaligned.
+// Copies past NON_TEMPORAL_THRESHOLD bypass the cache.
+void *
+_memcpy_sse2 (void * __restrict v_to, const void * __restrict v_from, size_t len)
+{
+    uint8_t* to = (uint8_t*)v_to;
+    const uint8_t* from = (const uint8_t*)v_from;
+
+    if (len < 128)
+    {
+        return constant_memcpy(v_to, v_from, len);
+    }
+
+    const size_t head = -(uintptr_t)to & 15;
+    constant_memcpy(to, from, head);
+    to += head; from += head; len -= head;
+
+    if (len >= NON_TEMPORAL_THRESHOLD)
+    {
+        for (; len >= 64; len -= 64)
+        {
+            __asm__ __volatile__ (
+                        "movdqu (%0), %%xmm0\n"
+                        "\tmovdqu 16(%0), %%xmm1\n"
+                        "\tmovdqu 32(%0), %%xmm2\n"
+                        "\tmovdqu 48(%0), %%xmm3\n"
+                        "\tmovntdq %%xmm0, (%1)\n"
+                        "\tmovntdq %%xmm1, 16(%1)\n"
+                        "\tmovntdq %%xmm2, 32(%1)\n"
+                        "\tmovntdq %%xmm3, 48(%1)\n"
+                        : : "r" (from), "r" (to) : "memory");
+            from += 64;
+            to += 64;
+        }
+
+        __asm__ __volatile__ ("sfence" : : : "memory");
+    }
+    else
+    {
+        for (; len >= 64; len -= 64)
+        {
+            __asm__ __volatile__ (
+                        "movdqu (%0), %%xmm0\n"
+                        "\tmovdqu 16(%0), %%xmm1\n"
+                        "\tmovdqu 32(%0), %%xmm2\n"
+                        "\tmovdqu 48(%0), %%xmm3\n"
+                        "\tmovdqa %%xmm0, (%1)\n"
+                        "\tmovdqa %%xmm1, 16(%1)\n"
+                        "\tmovdqa %%xmm2, 32(%1)\n"
+                        "\tmovdqa %%xmm3, 48(%1)\n"
+                        : : "r" (from), "r" (to) : "memory");
+            from += 64;
+            to += 64;
+        }
+    }
+
+    constant_memcpy(to, from, len);
+
+    return v_to;
+}
+
+// Copies to write-combined memory (e.g. the framebuffer) with non-temporal stores, 'len' must be a multiple of 4
+void *
+_stream_memcpyl_sse2 (void * __restrict v_to, const void * __restrict v_from, size_t len)
+{
+    uint8_t* to = (uint8_t*)v_to;
+    const uint8_t* from = (const uint8_t*)v_from;
+
+    while (len >= 4 && ((uintptr_t)to & 15))
+    {
+        __asm__ __volatile__ ("movnti %1, (%0)" : : "r" (to), "r" (*(const uint32_t*)from) : "memory");
+        to += 4; from += 4; len -= 4;
+    }
+
+    for (; len >= 64; len -= 64)
+    {
+        __asm__ __volatile__ (
+                    "movdqu (%0), %%xmm0\n"
+                    "\tmovdqu 16(%0), %%xmm1\n"
+                    "\tmovdqu 32(%0), %%xmm2\n"
+                    "\tmovdqu 48(%0), %%xmm3\n"
+                    "\tmovntdq %%xmm0, (%1)\n"
+                    "\tmovntdq %%xmm1, 16(%1)\n"
+                    "\tmovntdq %%xmm2, 32(%1)\n"
+                    "\tmovntdq %%xmm3, 48(%1)\n"
+                    : : "r" (from), "r" (to) : "memory");
+        from += 64;
+        to += 64;
+    }
+
+    for (; len >= 4; len -= 4)
+    {
+        __asm__ __volatile__ ("movnti %1, (%0)" : : "r" (to), "r" (*(const uint32_t*)from) : "memory");
+        to += 4; from += 4;
+    }
+
+    __asm__ __volatile__ ("sfence" : : : "memory");
+
+    return v_to;
+}
+
+constexpr size_t page_bytes = 0x1000;
+
+void _copy_page_movsl(void * __restrict dest, const void * __restrict src)
+{
+    _repmovsl_memcpy(dest, src, page_bytes);
+}
+
+void _copy_page_erms(void * __restrict dest, const void * __restrict src)
+{
+    _repmovsb_memcpy(dest, src, page_bytes);
+}
+
+// the page is written around the cache
+void _copy_page_sse2(void * __restrict dest, const void * __restrict src)
+{
+    _aligned_memcpy_sse2(dest, src, page_bytes);
 }
 
 // We don't have SSE at the very beggining, use rep movsb version
 void* (*memcpy)(void* __restrict, const void* __restrict, size_t) = _repmovsb_memcpy;
 void* (*memcpyl)(void* __restrict, const void* __restrict, size_t) = _repmovsl_memcpy;
 void* (*aligned_memcpy)(void* __restrict, const void* __restrict, size_t) = _naive_memcpy;
+void* (*stream_memcpyl)(void* __restrict, const void* __restrict, size_t) = _repmovsl_memcpy;
+void (*copy_page)(void* __restrict, const void* __restrict) = _copy_page_movsl;
@@ -28,12 +28,38 @@ void* memmove(void* dstptr, const void* srcptr, size_t size)
 {
     unsigned char* dst = reinterpret_cast<unsigned char*>(dstptr);
     const unsigned char* src = reinterpret_cast<const unsigned char*>(srcptr);
-    if (dst < src) {
-        for (size_t i = 0; i < size; i++)
-            dst[i] = src[i];
-    } else {
-        for (size_t i = size; i != 0; i--)
-            dst[i-1] = src[i-1];
+    if (dst + size <= src || src + size <= dst)
+    {
+        return memcpy(dstptr, srcptr, size);
+    }
+
+    if (dst < src)
+    {
+        // a forward copy reads every byte before overwriting it
+        asm volatile("rep movsb"
+                     : "+S"(src), "+D"(dst), "+c"(size)
+                     :
+                     : "memory");
+    }
+    else if (dst > src)
+    {
+        // going backwards with DF set would leak it to interrupt handlers : copy forward chunks from the end,
+        // each one no longer than the distance between the buffers so that it doesn't overlap its source
+        const size_t delta = dst - src;
+        if (delta >= 16)
+        {
+            while (size)
+            {
+                const size_t chunk = size < delta ? size : delta;
+                size -= chunk;
+                _repmovsb_memcpy(dst + size, src + size, chunk);
+            }
+        }
+        else
+        {
+            for (size_t i = size; i != 0; i--)
+                dst[i-1] = src[i-1];
+        }
     }
     return dstptr;
 }
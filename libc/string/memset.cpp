@@ -49,21 +49,23 @@ void _naive_double_memsetl(void* buf1ptr, void* buf2ptr, uint32_t value, size_t
 
 void* memsetw(void* bufptr, uint16_t value, size_t size)
 {
-    uint16_t* buf = reinterpret_cast<uint16_t*>(bufptr);
-    for (size_t i = 0; i < size/sizeof(uint16_t); i++)
-    {
-        buf[i] = value;
-    }
+    int d0, d1;
+    asm volatile (
+                "rep stosw"
+                : "=&c" (d0), "=&D" (d1)
+                : "0" (size/sizeof(uint16_t)), "a" (value), "1" (bufptr)
+                : "memory");
     return bufptr;
 }
 
 void* memsetl(void* bufptr, uint32_t value, size_t size)
 {
-    uint32_t* buf = reinterpret_cast<uint32_t*>(bufptr);
-    for (size_t i = 0; i < size/sizeof(uint32_t); i++)
-    {
-        buf[i] = value;
-    }
+    int d0, d1;
+    asm volatile (
+                "rep stosl"
+                : "=&c" (d0), "=&D" (d1)
+                : "0" (size/sizeof(uint32_t)), "a" (value), "1" (bufptr)
+                : "memory");
     return bufptr;
 }
 
@@ -86,6 +88,73 @@ void * _repmovsl_memset(void * dest, uint32_t val, size_t n) {
     return dest;
 }
 
+void * _stosl_memset(void * dest, uint8_t val, size_t n) {
+    int d0, d1;
+    asm volatile (
+                "rep stosl\n\t"
+                "movl %4, %%ecx\n\t"
+                "andl $3, %%ecx\n\t"
+                "rep stosb"
+                : "=&c" (d0), "=&D" (d1)
+                : "0" (n/4), "a" (val * 0x01010101u), "g" (n), "1" (dest)
+                : "memory");
+    return dest;
+}
+
+// Any alignment, the destination is aligned first. Fills past NON_TEMPORAL_THRESHOLD bypass the cache.
+void* _memset_sse2(void * dest, uint8_t val, size_t n)
+{
+    if (n < 128)
+    {
+        return _stosl_memset(dest, val, n);
+    }
+
+    alignas(16) uint32_t xmm0[4];
+    memsetl(xmm0, val * 0x01010101u, 4*sizeof(uint32_t));
+
+    uint8_t* to = (uint8_t*)dest;
+
+    const size_t head = -(uintptr_t)to & 15;
+    _stosl_memset(to, val, head);
+    to += head; n -= head;
+
+    __asm__ __volatile__ ("movdqa (%0), %%xmm0\n"::"r"(xmm0):"memory");
+
+    if (n >= NON_TEMPORAL_THRESHOLD)
+    {
+        for (; n >= 64; n -= 64)
+        {
+            __asm__ __volatile__ (
+                        "\tmovntdq %%xmm0, (%0)\n"
+                        "\tmovntdq %%xmm0, 16(%0)\n"
+                        "\tmovntdq %%xmm0, 32(%0)\n"
+                        "\tmovntdq %%xmm0, 48(%0)\n"
+                        : : "r" (to) : "memory");
+            to += 64;
+        }
+
+        __asm__ __volatile__ ("sfence" : : : "memory");
+    }
+    else
+    {
+        for (; n >= 64; n -= 64)
+        {
+            __asm__ __volatile__ (
+                        "\tmovdqa %%xmm0, (%0)\n"
+                        "\tmovdqa %%xmm0, 16(%0)\n"
+                        "\tmovdqa %%xmm0, 32(%0)\n"
+                        "\tmovdqa %%xmm0, 48(%0)\n"
+                        : : "r" (to) : "memory");
+            to += 64;
+        }
+    }
+
+    _stosl_memset(to, val, n);
+
+    return dest;
+}
+
+// 'dest' must be 16-byte aligned and 'n' a multiple of 4
 void* _aligned_memsetl_sse2(void * dest, uint32_t val, size_t n)
 {
     alignas(32) uint32_t xmm0[4];
@@ -110,6 +179,11 @@ void* _aligned_memsetl_sse2(void * dest, uint32_t val, size_t n)
         to += 128;
     }
 
+    // the non-temporal stores aren't ordered with the following ones
+    __asm__ __volatile__ ("sfence" : : : "memory");
+
+    memsetl(to, val, n & 127);
+
     return dest;
 }
 
@@ -146,8 +220,31 @@ void _aligned_double_memsetl_sse2(void*buf1ptr, void*buf2ptr, uint32_t val, size
         to1 += 128;
         to2 += 128;
     }
+
+    __asm__ __volatile__ ("sfence" : : : "memory");
+
+    _naive_double_memsetl(to1, to2, val, n & 127);
+}
+
+constexpr size_t page_bytes = 0x1000;
+
+void _zero_page_stosl(void * dest)
+{
+    memsetl(dest, 0, page_bytes);
+}
+
+void _zero_page_erms(void * dest)
+{
+    _repmovsb_memset(dest, 0, page_bytes);
+}
+
+// the page is written around the cache
+void _zero_page_sse2(void * dest)
+{
+    _aligned_memsetl_sse2(dest, 0, page_bytes);
 }
 
-void* (*memset)(void*, uint8_t, size_t) = _naive_memset;
+void* (*memset)(void*, uint8_t, size_t) = _stosl_memset;
 void* (*aligned_memsetl)(void*bufptr, uint32_t value, size_t size) = memsetl;
 void (*aligned_double_memsetl)(void*buf1ptr, void*buf2ptr, uint32_t value, size_t size) = _naive_double_memsetl;
+void (*zero_page)(void*) = _zero_page_stosl;
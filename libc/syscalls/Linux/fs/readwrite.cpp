@@ -33,5 +33,32 @@ extern "C"
 
 LINUX_SYSCALL_DEFAULT_IMPL(read, 3, size_t, (unsigned int fd, void* buf, size_t count), fd, buf, count)
 LINUX_SYSCALL_DEFAULT_IMPL(write,3, size_t, (unsigned int fd, const void* buf, size_t count), fd, buf, count)
+LINUX_SYSCALL_DEFAULT_IMPL(readv, 3, size_t, (unsigned int fd, const struct iovec* iov, int iovcnt), fd, iov, iovcnt)
+LINUX_SYSCALL_DEFAULT_IMPL(writev,3, size_t, (unsigned int fd, const struct iovec* iov, int iovcnt), fd, iov, iovcnt)
+
+// the 64-bit offset is passed in two registers, low half first
+size_t pread64(unsigned int fd, void* buf, size_t count, off_t offset)
+{
+    auto ret_val = DO_LINUX_SYSCALL(SYS_pread64, 5, fd, buf, count, (uint32_t)offset, (uint32_t)(offset >> 32));
+    if (ret_val < 0)
+    {
+        errno = -ret_val;
+        return (size_t)-1;
+    }
+
+    return ret_val;
+}
+
+size_t pwrite64(unsigned int fd, const void* buf, size_t count, off_t offset)
+{
+    auto ret_val = DO_LINUX_SYSCALL(SYS_pwrite64, 5, fd, buf, count, (uint32_t)offset, (uint32_t)(offset >> 32));
+    if (ret_val < 0)
+    {
+        errno = -ret_val;
+        return (size_t)-1;
+    }
+
+    return ret_val;
+}
 
 }
@@ -0,0 +1,49 @@
+/*
+sendfile.cpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "syscalls/defs.hpp"
+
+#include <errno.h>
+
+extern "C"
+{
+
+LINUX_SYSCALL_DEFAULT_IMPL(sendfile, 4, size_t, (unsigned int out_fd, unsigned int in_fd, off_t* offset, size_t count),
+                           out_fd, in_fd, offset, count)
+
+size_t splice(unsigned int fd_in, off_t* off_in, unsigned int fd_out, off_t* off_out, size_t len, unsigned int flags)
+{
+    int ret_val = DO_LINUX_SYSCALL6(SYS_splice, fd_in, off_in, fd_out, off_out, len, flags);
+
+    if (ret_val < 0)
+    {
+        errno = -ret_val;
+        return (size_t)-1;
+    }
+
+    return ret_val;
+}
+
+}
@@ -0,0 +1,68 @@
+/*
+mman.cpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "syscalls/defs.hpp"
+
+#include <errno.h>
+#include <sys/mman.h>
+
+extern "C"
+{
+
+void* mmap2(void* addr, size_t length, int prot, int flags, int fd, size_t pgoffset)
+{
+    int ret_val = DO_LINUX_SYSCALL6(SYS_mmap2, addr, length, prot, flags, fd, pgoffset);
+
+    // user space addresses don't go as high as the error codes
+    if ((unsigned)ret_val >= (unsigned)-4095)
+    {
+        errno = -ret_val;
+        return MAP_FAILED;
+    }
+
+    return (void*)ret_val;
+}
+
+void* mmap(void* addr, size_t length, int prot, int flags, int fd, off_t offset)
+{
+    if (offset < 0 || (offset & 0xfff))
+    {
+        errno = EINVAL;
+        return MAP_FAILED;
+    }
+    if ((offset >> 12) >> 32)
+    {
+        errno = EOVERFLOW;
+        return MAP_FAILED;
+    }
+
+    return mmap2(addr, length, prot, flags, fd, offset >> 12);
+}
+
+LINUX_SYSCALL_DEFAULT_IMPL(munmap,  2, int, (void* addr, size_t length), addr, length)
+LINUX_SYSCALL_DEFAULT_IMPL(mprotect,3, int, (void* addr, size_t length, int prot), addr, length, prot)
+LINUX_SYSCALL_DEFAULT_IMPL(msync,   3, int, (void* addr, size_t length, int flags), addr, length, flags)
+
+}
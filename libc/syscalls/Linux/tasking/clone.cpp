@@ -34,7 +34,7 @@ extern "C"
 
 int clone_fork(int flags, void* child_stack)
 {
-    auto ret_val = DO_LINUX_SYSCALL(SYS_clone, 2, flags, child_stack);
+    auto ret_val = DO_LINUX_INT80_SYSCALL(SYS_clone, 2, flags, child_stack);
 
     if (ret_val < 0)
     {
@@ -65,7 +65,7 @@ int clone (int (*fn) (void *__arg), void *child_stack,
     nonstack_fn_ptr = fn;
     nonstack_arg = arg;
 
-    auto ret_val = DO_LINUX_SYSCALL(SYS_clone, 2, flags, child_stack);
+    auto ret_val = DO_LINUX_INT80_SYSCALL(SYS_clone, 2, flags, child_stack);
 
     if (ret_val < 0)
     {
@@ -26,6 +26,7 @@ SOFTWARE.
 #include "syscalls/syscall_list.hpp"
 
 #include <stdlib.h>
+#include <stdio.h>
 
 #include "syscall.h"
 
@@ -35,6 +36,10 @@ extern "C"
 
 void exit(uint8_t errcode)
 {
+#ifdef LUDOS_USER
+    fflush(nullptr);
+#endif
+
     DO_LINUX_SYSCALL(SYS_exit, 1, errcode);
 
     __builtin_unreachable();
@@ -27,10 +27,26 @@ SOFTWARE.
 #include "syscalls/defs.hpp"
 
 #include "errno.h"
+#include <stdio.h>
 
 extern "C"
 {
 
-LINUX_SYSCALL_DEFAULT_IMPL(fork, 0, pid_t, ())
+pid_t fork()
+{
+#ifdef LUDOS_USER
+    // the child would otherwise write the pending output a second time
+    fflush(nullptr);
+#endif
+
+    auto ret_val = DO_LINUX_SYSCALL(SYS_fork, 0);
+    if (ret_val < 0)
+    {
+        errno = -ret_val;
+        return -1;
+    }
+
+    return ret_val;
+}
 
 }
@@ -26,6 +26,7 @@ SOFTWARE.
 #include "syscalls/syscalls.hpp"
 
 #include "syscall.h"
+#include "syscalls/vdso.hpp"
 
 extern "C"
 {
@@ -33,12 +34,12 @@ extern "C"
 
 int getpid()
 {
-    return DO_LINUX_SYSCALL(SYS_getpid, 0);
+    return vdso()->pid;
 }
 
 int gettid()
 {
-    return DO_LINUX_SYSCALL(SYS_gettid, 0);
+    return vdso()->tid;
 }
 
 }
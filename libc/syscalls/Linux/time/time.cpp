@@ -25,13 +25,62 @@ SOFTWARE.
 
 #include "syscalls/syscall_list.hpp"
 #include "syscalls/defs.hpp"
+#include "syscalls/vdso.hpp"
 
 #include "errno.h"
+#include <time.h>
 
 extern "C"
 {
 
-LINUX_SYSCALL_DEFAULT_IMPL(time, 1, time_t, (time_t* t_loc), t_loc)
-LINUX_SYSCALL_DEFAULT_IMPL(clock_gettime, 2, int, (clockid_t clock, struct timespec* tp), clock, tp)
+// answered from the vDSO data page, without entering the kernel
+
+time_t time(time_t* t_loc)
+{
+    const time_t epoch = vdso()->boot_epoch + vdso_uptime_ns() / 1'000'000'000;
+    if (t_loc) *t_loc = epoch;
+
+    return epoch;
+}
+
+int clock_gettime(clockid_t clock, struct timespec* tp)
+{
+    // let the kernel report the errors
+    if (clock != CLOCK_REALTIME || !tp)
+    {
+        auto ret_val = DO_LINUX_SYSCALL(SYS_clock_gettime, 2, clock, tp);
+        if (ret_val < 0)
+        {
+            errno = -ret_val;
+            return -1;
+        }
+        return ret_val;
+    }
+
+    const uint64_t ns = vdso_uptime_ns();
+
+    tp->tv_sec = ns / 1'000'000'000;
+    tp->tv_nsec = ns % 1'000'000'000;
+
+    return 0;
+}
+
+int gettimeofday(struct timeval* tv, struct timezone* tz)
+{
+    if (tv)
+    {
+        const uint64_t ns = vdso_uptime_ns();
+
+        tv->tv_sec = vdso()->boot_epoch + ns / 1'000'000'000;
+        tv->tv_usec = (ns % 1'000'000'000) / 1000;
+    }
+    if (tz)
+    {
+        tz->tz_minuteswest = 0;
+        tz->tz_dsttime = 0;
+    }
+
+    return 0;
+}
 
 }
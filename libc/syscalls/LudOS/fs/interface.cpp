@@ -35,4 +35,7 @@ extern "C"
 LUDOS_SYSCALL_DEFAULT_IMPL(get_interface, 3, int, (unsigned int fd, int interface_id, void* interface)
                            , fd, interface_id, interface)
 
+LUDOS_SYSCALL_DEFAULT_IMPL(interface_call, 2, int, (unsigned int handle, const uintptr_t* args)
+                           , handle, args)
+
 }
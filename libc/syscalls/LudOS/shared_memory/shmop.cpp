@@ -36,7 +36,8 @@ extern "C"
 long shmat(int shmid, const void* shmaddr, int shmflg)
 {
     auto ret = DO_LUDOS_SYSCALL(SYS_shmat, 3, shmid, shmaddr, shmflg);
-    if (ret < 0)
+    // addresses above 2GiB look negative, only the top 4095 values are errors
+    if (ret < 0 && ret > -4096)
     {
         errno = -ret;
         ret = -1;
@@ -0,0 +1,54 @@
+/*
+vdso.hpp
+
+Copyright (c) 18 Yann BOUCHER (yann)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+#ifndef LIBC_VDSO_HPP
+#define LIBC_VDSO_HPP
+
+#include <stdint.h>
+#include <sys/vdso.h>
+
+inline const volatile vdso_data* vdso()
+{
+    return (const volatile vdso_data*)VDSO_DATA_ADDR;
+}
+
+// same computation as the kernel's Time::uptime_ns()
+inline uint64_t vdso_uptime_ns()
+{
+    uint64_t tsc;
+    asm volatile ("rdtsc" : "=A"(tsc));
+
+    const auto data = vdso();
+    const uint64_t ticks = tsc - data->tsc_base;
+    const uint32_t mult  = data->tsc_mult;
+    const uint32_t shift = data->tsc_shift;
+
+    // split the 64x32 multiplication so that it doesn't overflow
+    const uint64_t hi = (ticks >> 32) * mult;
+    const uint64_t lo = (ticks & 0xFFFFFFFF) * mult;
+
+    return (hi << (32 - shift)) + (lo >> shift);
+}
+
+#endif // LIBC_VDSO_HPP
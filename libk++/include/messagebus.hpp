@@ -54,6 +54,61 @@ public:
     template <typename T>
     size_t send(const T& event);
 
+public:
+    static constexpr size_t max_channels = 64;
+    static constexpr size_t max_subscribers = 8;
+    static constexpr size_t queue_size = 32;
+
+    struct SubscriberHandle
+    {
+        size_t channel;
+        size_t subscriber;
+    };
+
+    // Asynchronous handler : the messages are copied into a bounded queue of its own, and the handler
+    // is called later by dispatch_posted(). The handler receives both sent and posted messages
+    template <typename T>
+    kpp::optional<SubscriberHandle> subscribe(std::function<void(const T&)> handler);
+
+    // must not race with a post() of the same message type, the subscriber queue is freed
+    void unsubscribe(const SubscriberHandle& handle);
+
+    // Queues the message for the asynchronous handlers only, without locking or allocating ;
+    // the message is dropped for the subscribers whose queue is full.
+    // Returns the number of subscribers who received the message
+    template <typename T>
+    size_t post(const T& event);
+
+    // Calls the asynchronous handlers on the queued messages, returns the number of handled messages
+    size_t dispatch_posted();
+
+    bool has_posted() const { return __atomic_load_n(&m_posted, __ATOMIC_ACQUIRE); }
+
+    // Called from the context of the post() which makes messages pending again after a dispatch_posted(),
+    // to wake up the task dispatching them ; it must not block nor allocate
+    void set_post_notifier(void (*notifier)()) { __atomic_store_n(&m_notifier, notifier, __ATOMIC_RELEASE); }
+
+    size_t dropped_messages() const { return __atomic_load_n(&m_dropped, __ATOMIC_RELAXED); }
+
+private:
+    struct ChannelBase
+    {
+        virtual ~ChannelBase() = default;
+        virtual size_t dispatch() = 0;
+        virtual void remove(size_t subscriber) = 0;
+    };
+
+    template <typename T>
+    struct Channel;
+
+    // channel index of each message type, assigned on the first subscription
+    template <typename T>
+    static inline size_t channel_index { max_channels };
+    static size_t next_channel_index();
+
+    template <typename T>
+    size_t queue(const T& event);
+
 public:
     struct RAIIHandle
     {
@@ -84,6 +139,10 @@ public:
 
 private:
     std::unordered_map<kpp::type_id_t, std::list<Entry>> handlers;
+    ChannelBase* m_channels[max_channels] { nullptr };
+    bool m_posted { false };
+    void (*m_notifier)() { nullptr };
+    size_t m_dropped { 0 };
 };
 
 #include "messagebus.tpp"
@@ -38,7 +38,7 @@ MessageBus::Handle MessageBus::register_handler(std::function<void(const T&)> ha
 template <typename T>
 size_t MessageBus::send(const T& event)
 {
-    size_t counter { 0 };
+    size_t counter { queue(event) };
     std::list<Entry> late_callbacks;
     for (const auto& callback : handlers[kpp::type_id<T>()])
     {
@@ -60,3 +60,174 @@ size_t MessageBus::send(const T& event)
 
     return counter;
 }
+
+// Multiple producers / single consumer bounded queue, each slot carries a sequence number telling
+// whether it is free (seq == position) or holds a message (seq == position + 1)
+template <typename T>
+struct MessageBus::Channel : public MessageBus::ChannelBase
+{
+    struct Slot
+    {
+        uint32_t seq;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    struct Subscriber
+    {
+        std::function<void(const T&)> handler;
+        Slot slots[queue_size];
+        uint32_t head { 0 };
+        uint32_t tail { 0 };
+    };
+
+    Subscriber* subscribers[max_subscribers] { nullptr };
+
+    ~Channel()
+    {
+        for (size_t i { 0 }; i < max_subscribers; ++i)
+        {
+            remove(i);
+        }
+    }
+
+    bool push(Subscriber& sub, const T& event)
+    {
+        uint32_t pos = __atomic_load_n(&sub.head, __ATOMIC_RELAXED);
+        while (true)
+        {
+            Slot& slot = sub.slots[pos % queue_size];
+            const int32_t diff = static_cast<int32_t>(__atomic_load_n(&slot.seq, __ATOMIC_ACQUIRE) - pos);
+            if (diff == 0)
+            {
+                if (__atomic_compare_exchange_n(&sub.head, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                {
+                    new (slot.storage) T(event);
+                    __atomic_store_n(&slot.seq, pos + 1, __ATOMIC_RELEASE);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false; // full
+            }
+            else
+            {
+                pos = __atomic_load_n(&sub.head, __ATOMIC_RELAXED);
+            }
+        }
+    }
+
+    size_t dispatch() override
+    {
+        size_t handled { 0 };
+        for (auto sub : subscribers)
+        {
+            if (!sub) continue;
+
+            while (true)
+            {
+                Slot& slot = sub->slots[sub->tail % queue_size];
+                if (__atomic_load_n(&slot.seq, __ATOMIC_ACQUIRE) != sub->tail + 1)
+                {
+                    break; // empty, or the producer hasn't finished writing this slot yet
+                }
+
+                const T* event = reinterpret_cast<const T*>(slot.storage);
+                sub->handler(*event);
+                event->~T();
+
+                __atomic_store_n(&slot.seq, sub->tail + queue_size, __ATOMIC_RELEASE);
+                ++sub->tail;
+                ++handled;
+            }
+        }
+
+        return handled;
+    }
+
+    void remove(size_t index) override
+    {
+        Subscriber* sub = __atomic_exchange_n(&subscribers[index], nullptr, __ATOMIC_ACQ_REL);
+        if (!sub) return;
+
+        for (; __atomic_load_n(&sub->slots[sub->tail % queue_size].seq, __ATOMIC_ACQUIRE) == sub->tail + 1; ++sub->tail)
+        {
+            reinterpret_cast<const T*>(sub->slots[sub->tail % queue_size].storage)->~T();
+        }
+        delete sub;
+    }
+};
+
+template <typename T>
+kpp::optional<MessageBus::SubscriberHandle> MessageBus::subscribe(std::function<void(const T&)> handler)
+{
+    if (channel_index<T> == max_channels)
+    {
+        channel_index<T> = next_channel_index();
+        if (channel_index<T> == max_channels) return {};
+    }
+
+    auto& channel = m_channels[channel_index<T>];
+    if (!channel)
+    {
+        channel = new Channel<T>;
+    }
+    auto typed_channel = static_cast<Channel<T>*>(channel);
+
+    for (size_t i { 0 }; i < max_subscribers; ++i)
+    {
+        if (!typed_channel->subscribers[i])
+        {
+            auto sub = new typename Channel<T>::Subscriber;
+            sub->handler = std::move(handler);
+            for (uint32_t j { 0 }; j < queue_size; ++j)
+            {
+                sub->slots[j].seq = j;
+            }
+            __atomic_store_n(&typed_channel->subscribers[i], sub, __ATOMIC_RELEASE);
+
+            return SubscriberHandle{channel_index<T>, i};
+        }
+    }
+
+    return {};
+}
+
+template <typename T>
+size_t MessageBus::queue(const T& event)
+{
+    const size_t index = channel_index<T>;
+    if (index == max_channels) return 0;
+
+    auto channel = static_cast<Channel<T>*>(__atomic_load_n(&m_channels[index], __ATOMIC_ACQUIRE));
+    if (!channel) return 0;
+
+    size_t counter { 0 };
+    for (auto& sub_ptr : channel->subscribers)
+    {
+        auto sub = __atomic_load_n(&sub_ptr, __ATOMIC_ACQUIRE);
+        if (!sub) continue;
+
+        if (channel->push(*sub, event))
+        {
+            ++counter;
+        }
+        else
+        {
+            __atomic_fetch_add(&m_dropped, 1, __ATOMIC_RELAXED);
+        }
+    }
+
+    if (counter && !__atomic_exchange_n(&m_posted, true, __ATOMIC_ACQ_REL))
+    {
+        if (auto notifier = __atomic_load_n(&m_notifier, __ATOMIC_ACQUIRE)) notifier();
+    }
+
+    return counter;
+}
+
+template <typename T>
+size_t MessageBus::post(const T& event)
+{
+    return queue(event);
+}
@@ -29,3 +29,37 @@ void MessageBus::remove_handler(const MessageBus::Handle &handle)
 {
     handlers[std::get<1>(handle)].erase(std::get<2>(handle));
 }
+
+size_t MessageBus::next_channel_index()
+{
+    static size_t count { 0 };
+
+    size_t index = __atomic_load_n(&count, __ATOMIC_RELAXED);
+    do
+    {
+        if (index == max_channels) return max_channels;
+    } while (!__atomic_compare_exchange_n(&count, &index, index + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    return index;
+}
+
+void MessageBus::unsubscribe(const MessageBus::SubscriberHandle &handle)
+{
+    if (auto channel = m_channels[handle.channel])
+    {
+        channel->remove(handle.subscriber);
+    }
+}
+
+size_t MessageBus::dispatch_posted()
+{
+    if (!__atomic_exchange_n(&m_posted, false, __ATOMIC_ACQ_REL)) return 0;
+
+    size_t handled { 0 };
+    for (auto channel : m_channels)
+    {
+        if (channel) handled += channel->dispatch();
+    }
+
+    return handled;
+}
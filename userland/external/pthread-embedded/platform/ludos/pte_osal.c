@@ -42,6 +42,7 @@
 
 #include <sched.h>
 #include <lud_semaphore.h>
+#include <liballoc/liballoc.h>
 
 #define tls_addr() \
     ({ int val; \
@@ -214,6 +215,9 @@ pte_osResult self_destruct()
 
     delete_structure(get_structure(pte_osThreadGetHandle()));
 
+    // hand the objects cached by this thread's allocator to the remaining threads
+    liballoc_thread_exit();
+
     pthread_mutex_unlock(&self_destruct_mutex);
 
     exit(0);
@@ -30,20 +30,9 @@ SOFTWARE.
 extern "C" void pthread_init();
 extern "C" void pthread_terminate();
 
-char print_buffer[1024];
-size_t buf_counter;
-
-void flush_buffer()
-{
-    write(1, print_buffer, buf_counter);
-    buf_counter = 0;
-}
-
-void write_callback(void*, char c)
+void write_callback(void* stream, char c)
 {
-    print_buffer[buf_counter++] = c;
-    if (c == '\n' || buf_counter == sizeof(print_buffer))
-        flush_buffer();
+    fputc(c, (FILE*)stream);
 }
 
 void __attribute__((constructor)) libc_init()
@@ -51,11 +40,12 @@ void __attribute__((constructor)) libc_init()
     // initialize the FPU
     asm volatile ("fninit\n");
 
-    init_printf(nullptr, write_callback);
+    init_printf(stdout, write_callback);
     pthread_init();
 }
 
 void __attribute__((destructor)) libc_exit()
 {
     pthread_terminate();
+    fflush(nullptr);
 }
@@ -28,33 +28,37 @@ SOFTWARE.
 #include <syscalls/syscall_list.hpp>
 
 #include <stdio.h>
-#include <sys/fnctl.h>
 
 int main(int argc, char* argv[])
 {
     if (argc < 2)
     {
-        fprintf(stdout, "cat needs one argument\n");
+        fprintf(stderr, "cat needs one argument\n");
         return 1;
     }
 
     const char* path = argv[1];
 
-    int fd = open(path, O_RDONLY, 0);
-    if (fd < 0)
+    FILE* file = fopen(path, "r");
+    if (!file)
     {
-        perror("open");
+        perror("fopen");
         return 0;
     }
 
     char buf[0x1000];
-    if (read(fd, buf, sizeof(buf)) < 0)
+    size_t size;
+    while ((size = fread(buf, 1, sizeof(buf), file)) > 0)
+    {
+        fwrite(buf, 1, size, stdout);
+    }
+
+    if (ferror(file))
     {
         perror("read");
-        return 0;
     }
 
-    printf("%s\n", buf);
+    fclose(file);
 
     return 0;
 }
@@ -36,8 +36,163 @@ SOFTWARE.
 
 char* shared_buf;
 
-int main()
+// Bandwidth comparison between a shared memory segment and a pipe.
+// Both transfers are synchronized with one-byte tokens over a pair of pipes so that only the data path differs.
+constexpr size_t bench_total = 4*1024*1024;
+constexpr size_t shm_chunk   = 64*1024;
+constexpr size_t pipe_chunk  = 2048; // a pipe can only carry less than 4 KiB atomically
+
+static uint8_t pipe_buf[pipe_chunk];
+
+static uint32_t checksum(const uint8_t* data, size_t len)
+{
+    uint32_t sum = 0;
+    for (size_t i { 0 }; i < len; ++i)
+    {
+        sum += data[i];
+    }
+
+    return sum;
+}
+
+static void fill(uint8_t* data, size_t len, size_t seed)
+{
+    for (size_t i { 0 }; i < len; ++i)
+    {
+        data[i] = (uint8_t)(i + seed);
+    }
+}
+
+static void print_result(const char* name, uint64_t usecs)
+{
+    if (usecs == 0) usecs = 1;
+    printf("%s : %d KiB in %d us, %d KiB/s\n", name, (int)(bench_total/1024), (int)usecs,
+           (int)((uint64_t)bench_total * 1'000'000 / 1024 / usecs));
+}
+
+static int bench_shm()
 {
+    int shm_id = shmget(IPC_PRIVATE, shm_chunk, IPC_CREAT|IPC_EXCL);
+    if (shm_id < 0)
+    {
+        perror("shmget");
+        return 1;
+    }
+
+    auto buf = (uint8_t*)shmat(shm_id, 0, 0);
+    if (buf == (uint8_t*)-1)
+    {
+        perror("shmat");
+        return 1;
+    }
+
+    int full[2], empty[2];
+    if (pipe(full) < 0 || pipe(empty) < 0)
+    {
+        perror("pipe");
+        return 1;
+    }
+
+    int ret = fork();
+    if (ret == -1)
+    {
+        perror("fork");
+        return 1;
+    }
+    else if (ret == 0)
+    { // Consumer
+        uint32_t sum = 0;
+        char token;
+        for (size_t i { 0 }; i < bench_total/shm_chunk; ++i)
+        {
+            read(full[0], &token, 1);
+            sum += checksum(buf, shm_chunk);
+            write(empty[1], &token, 1);
+        }
+
+        exit(sum != 0 ? 0 : 1);
+    }
+
+    uint64_t start = uptime();
+    char token = 0;
+    for (size_t i { 0 }; i < bench_total/shm_chunk; ++i)
+    {
+        fill(buf, shm_chunk, i);
+        write(full[1], &token, 1);
+        read(empty[0], &token, 1);
+    }
+    uint64_t end = uptime();
+
+    int status;
+    waitpid(ret, &status, 0);
+
+    print_result("shm ", end - start);
+
+    shmdt(buf);
+
+    return WEXITSTATUS(status);
+}
+
+static int bench_pipe()
+{
+    int data[2];
+    if (pipe(data) < 0)
+    {
+        perror("pipe");
+        return 1;
+    }
+
+    int ret = fork();
+    if (ret == -1)
+    {
+        perror("fork");
+        return 1;
+    }
+    else if (ret == 0)
+    { // Consumer
+        uint32_t sum = 0;
+        for (size_t i { 0 }; i < bench_total/pipe_chunk; ++i)
+        {
+            read(data[0], pipe_buf, pipe_chunk);
+            sum += checksum(pipe_buf, pipe_chunk);
+        }
+
+        exit(sum != 0 ? 0 : 1);
+    }
+
+    uint64_t start = uptime();
+    for (size_t i { 0 }; i < bench_total/pipe_chunk; ++i)
+    {
+        fill(pipe_buf, pipe_chunk, i);
+        write(data[1], pipe_buf, pipe_chunk);
+    }
+
+    int status;
+    waitpid(ret, &status, 0);
+    uint64_t end = uptime();
+
+    print_result("pipe", end - start);
+
+    return WEXITSTATUS(status);
+}
+
+static int run_benchmark()
+{
+    if (int ret = bench_shm(); ret != 0)
+    {
+        return ret;
+    }
+
+    return bench_pipe();
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc >= 2 && strcmp(argv[1], "bench") == 0)
+    {
+        return run_benchmark();
+    }
+
     int shm_id = shmget(IPC_PRIVATE, 1024, IPC_CREAT|IPC_EXCL);
     printf("shm_id : %d\n", shm_id);
     if (shm_id < 0)
@@ -26,6 +26,7 @@ SOFTWARE.
 #include <stdio.h>
 
 #include <syscalls/syscall_list.hpp>
+#include <syscall.h>
 
 #include <errno.h>
 #include <stdio.h>
@@ -37,6 +38,12 @@ SOFTWARE.
 #include <sys/fnctl.h>
 #include <sys/fs.h>
 #include <sys/wait.h>
+#include <sys/time.h>
+#include <sys/vdso.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <limits.h>
+#include <time.h>
 
 #include "utils/stlutils.hpp"
 
@@ -132,6 +139,150 @@ uint64_t total_ticks()
     return ret;
 }
 
+void vdso_test()
+{
+    // these are answered from the vDSO, check them against the kernel
+    ensure(getpid() == DO_LINUX_SYSCALL(SYS_getpid, 0));
+    ensure(gettid() == DO_LINUX_SYSCALL(SYS_gettid, 0));
+
+    timespec before, after;
+    ensure(clock_gettime(CLOCK_REALTIME, &before) == 0);
+    ensure(DO_LINUX_SYSCALL(SYS_clock_gettime, 2, CLOCK_REALTIME, &after) == 0);
+    ensure(after.tv_sec > before.tv_sec || (after.tv_sec == before.tv_sec && after.tv_nsec >= before.tv_nsec));
+
+    timeval tv;
+    ensure(gettimeofday(&tv, nullptr) == 0);
+    ensure(tv.tv_sec + 1 >= DO_LINUX_SYSCALL(SYS_time, 1, nullptr));
+
+    uint64_t begin = total_ticks();
+    for (size_t i { 0 }; i < 1000; ++i)
+    {
+        DO_LINUX_SYSCALL(SYS_getpid, 0);
+    }
+    const uint64_t syscall_ticks = (total_ticks() - begin) / 1000;
+
+    begin = total_ticks();
+    for (size_t i { 0 }; i < 1000; ++i)
+    {
+        getpid();
+    }
+    const uint64_t vdso_ticks = (total_ticks() - begin) / 1000;
+
+    printf("getpid : %u ticks through a syscall, %u through the vDSO\n", (unsigned)syscall_ticks, (unsigned)vdso_ticks);
+}
+
+void malloc_test()
+{
+    // small blocks come from the per-thread cache, check their alignment and that realloc keeps the data
+    char* blocks[64];
+    for (size_t i { 0 }; i < 64; ++i)
+    {
+        blocks[i] = (char*)malloc(i*32 + 1);
+        ensure(blocks[i] && (uintptr_t)blocks[i] % sizeof(uintptr_t) == 0);
+        memset(blocks[i], i, i*32 + 1);
+    }
+    for (size_t i { 0 }; i < 64; ++i)
+    {
+        blocks[i] = (char*)realloc(blocks[i], i*64 + 1);
+        ensure(blocks[i] && blocks[i][i*32] == (char)i);
+        free(blocks[i]);
+    }
+}
+
+void uaccess_test()
+{
+    // bad user pointers must be reported, not fault the kernel
+    ensure(open((const char*)0x10, O_RDONLY, 0) == -1 && errno == EFAULT);
+    ensure(open((const char*)0xC0001000, O_RDONLY, 0) == -1 && errno == EFAULT);
+
+    const std::string long_path(PATH_MAX + 16, 'a');
+    ensure(open(long_path.c_str(), O_RDONLY, 0) == -1 && errno == ENAMETOOLONG);
+
+    int fd = open("/initrd/test.txt", O_RDONLY, 0);
+    ensure(fd > 0);
+    ensure(read(fd, (void*)0x10, 4) == -1 && errno == EFAULT);
+    ensure(read(fd, (void*)(0xC0000000 - 2), 4) == -1 && errno == EFAULT);
+    ensure(read(fd, (void*)VDSO_CODE_ADDR, 4) == -1 && errno == EFAULT); // read-only page
+    close(fd);
+
+    ensure(pipe((int*)0x10) == -1 && errno == EFAULT);
+}
+
+void mmap_test()
+{
+    int fd = open("/initrd/test.txt", O_RDONLY, 0);
+    ensure(fd > 0);
+
+    // private mappings get their own copy of a page on the first write to it
+    char* first = (char*)mmap(nullptr, 4096, PROT_READ|PROT_WRITE, MAP_PRIVATE, fd, 0);
+    char* second = (char*)mmap(nullptr, 4096, PROT_READ, MAP_PRIVATE, fd, 0);
+    ensure(first != MAP_FAILED && second != MAP_FAILED && first != second);
+    ensure(memcmp(first, "data", 4) == 0 && memcmp(second, "data", 4) == 0);
+    first[0] = 'D';
+    ensure(first[0] == 'D' && second[0] == 'd');
+
+    ensure(mprotect(second, 4096, PROT_READ|PROT_WRITE) == 0);
+    second[1] = 'A';
+    ensure(first[1] == 'a' && second[1] == 'A');
+
+    // the file was opened read-only
+    ensure(mmap(nullptr, 4096, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0) == MAP_FAILED && errno == EACCES);
+    ensure(mmap(nullptr, 4096, PROT_READ, MAP_PRIVATE, fd, 1) == MAP_FAILED && errno == EINVAL);
+
+    // anonymous pages read as zeroes, and the kernel can write to the ones that weren't touched yet
+    char* anon = (char*)mmap(nullptr, 8192, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+    ensure(anon != MAP_FAILED && anon[4096] == 0);
+    lseek(fd, 0, SEEK_SET);
+    ensure(read(fd, anon, 4) == 4 && memcmp(anon, "data", 4) == 0);
+
+    ensure(msync(first, 4096, MS_SYNC) == 0);
+    ensure(munmap(first, 4096) == 0 && munmap(second, 4096) == 0 && munmap(anon, 8192) == 0);
+    ensure(msync(first, 4096, MS_SYNC) == -1 && errno == ENOMEM);
+
+    close(fd);
+}
+
+void io_test()
+{
+    int fd = open("/initrd/test.txt", O_RDONLY, 0);
+    ensure(fd > 0);
+
+    char first[2], second[4];
+    iovec vecs[2] = {{first, sizeof(first)}, {second, sizeof(second)}};
+    ensure(readv(fd, vecs, 2) == 6);
+    ensure(memcmp(first, "da", 2) == 0 && memcmp(second, "ta\n2", 4) == 0);
+
+    char buf[6];
+    ensure(pread64(fd, buf, 4, 5) == 4 && memcmp(buf, "2222", 4) == 0);
+    ensure(pread64(fd, buf, 4, 1ull << 32) == (size_t)-1 && errno == EINVAL);
+
+    int fds[2];
+    ensure(pipe(fds) == 0);
+
+    ensure(writev(fds[1], vecs, 2) == 6);
+    ensure(read(fds[0], buf, 6) == 6 && memcmp(buf, "data\n2", 6) == 0);
+
+    // a write as large as the pipe buffer is split by the kernel
+    static char big_out[4096], big_in[4096];
+    memset(big_out, 'x', sizeof(big_out));
+    ensure(write(fds[1], big_out, sizeof(big_out)) == sizeof(big_out));
+    ensure(read(fds[0], big_in, sizeof(big_in)) == sizeof(big_in) && memcmp(big_in, big_out, sizeof(big_in)) == 0);
+
+    // file to pipe, the data doesn't go through user memory
+    off_t offset = 5;
+    ensure(sendfile(fds[1], fd, &offset, 4) == 4 && offset == 9);
+    ensure(read(fds[0], buf, 4) == 4 && memcmp(buf, "2222", 4) == 0);
+
+    offset = 0;
+    ensure(splice(fd, &offset, fds[1], nullptr, 4, 0) == 4 && offset == 4);
+    ensure(read(fds[0], buf, 4) == 4 && memcmp(buf, "data", 4) == 0);
+    ensure(splice(fds[0], &offset, fds[1], nullptr, 4, 0) == (size_t)-1 && errno == ESPIPE);
+
+    close(fds[0]);
+    close(fds[1]);
+    close(fd);
+}
+
 int main(int argc, char* argv[])
 {
     void* heap_alloc = malloc(2566525);
@@ -190,6 +341,12 @@ int main(int argc, char* argv[])
 
     //fork_test();
 
+    vdso_test();
+    uaccess_test();
+    malloc_test();
+    mmap_test();
+    io_test();
+
     uint64_t total_test_ticks = 0;
 
     for (size_t i { 0 }; i < 100; ++i)